@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "AnimationSystem.hpp"
+#include "Benchmark.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    constexpr std::chrono::nanoseconds FrameInterval = 16666667ns;
+
+    /**
+     * Starts one long animation per property, spread over the easing curves, with four properties per widget.
+     */
+    void StartAnimations(UI::AnimationSystem& system, std::vector<float>& properties, bool mixedEasings)
+    {
+        for (size_t index = 0; index < properties.size(); ++index)
+        {
+            const UI::Easing easing = mixedEasings ? static_cast<UI::Easing>(index % static_cast<size_t>(UI::Easing::Count))
+                                                   : UI::Easing::EaseOutCubic;
+            system.Animate(static_cast<UI::WidgetId>(index / 4), &properties[index], 1.0f, 0ns, std::chrono::hours(1), easing);
+        }
+    }
+
+    void PrintRow(const char* name, size_t lanes, double nanosecondsPerTick)
+    {
+        std::printf("%-40s %10zu %14.2f %14.2f\n", name, lanes, nanosecondsPerTick / 1e3, nanosecondsPerTick / static_cast<double>(lanes) * 1e4 / 1e3);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+
+    std::printf("\nTick cost\n%-40s %10s %14s %14s\n", "case", "lanes", "us/tick", "us/10k lanes");
+    for (size_t lanes : {size_t{1000}, size_t{10000}, size_t{100000}})
+    {
+        for (bool mixed : {false, true})
+        {
+            UI::AnimationSystem system;
+            std::vector<float> properties(lanes, 0.0f);
+            StartAnimations(system, properties, mixed);
+
+            const size_t ticks = Scaled(1000000 / (lanes / 100), scale);
+            std::chrono::nanoseconds now = 0ns;
+            const Clock::time_point start = Clock::now();
+            for (size_t tick = 0; tick < ticks; ++tick)
+            {
+                now += FrameInterval;
+                system.Tick(now);
+                DoNotOptimize(system.GetDirtyWidgets().data());
+            }
+            PrintRow(mixed ? "Tick, six easing curves" : "Tick, one easing curve", lanes, ElapsedNanoseconds(start) / ticks);
+            DoNotOptimize(properties.data());
+        }
+    }
+
+    std::printf("\nStart, replace and cancel\n%-40s %10s %14s %14s\n", "case", "lanes", "us/batch", "us/10k lanes");
+    {
+        const size_t lanes = 10000;
+        const size_t rounds = Scaled(200, scale);
+        std::vector<float> properties(lanes, 0.0f);
+        UI::AnimationSystem system;
+
+        Clock::time_point start = Clock::now();
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            StartAnimations(system, properties, true);
+            for (size_t widget = 0; widget < lanes / 4; ++widget)
+                system.CancelWidget(static_cast<UI::WidgetId>(widget));
+        }
+        PrintRow("Animate + CancelWidget", lanes, ElapsedNanoseconds(start) / rounds);
+
+        StartAnimations(system, properties, true);
+        start = Clock::now();
+        for (size_t round = 0; round < rounds; ++round)
+            StartAnimations(system, properties, true);
+        PrintRow("Animate replacing running animations", lanes, ElapsedNanoseconds(start) / rounds);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <cstdio>
+
+#include "Async.hpp"
+#include "Benchmark.hpp"
+
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    /**
+     * Always suspends and resumes through the dispatcher, to time a full post and resume.
+     */
+    struct YieldTo
+    {
+        Core::UiDispatcher& Ui;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const { Ui.Post(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    Core::Task<int> Leaf(int value)
+    {
+        co_return value;
+    }
+
+    Core::Task<void> AwaitLeaves(size_t count, int64_t& total)
+    {
+        for (size_t index = 0; index < count; ++index)
+            total += co_await Leaf(static_cast<int>(index));
+    }
+
+    Core::Task<void> YieldRepeatedly(Core::UiDispatcher& ui, size_t count, bool& done)
+    {
+        for (size_t index = 0; index < count; ++index)
+            co_await YieldTo{ui};
+        done = true;
+    }
+
+    Core::Task<void> HopRepeatedly(Core::UiDispatcher& ui, size_t count, bool& done)
+    {
+        for (size_t index = 0; index < count; ++index)
+        {
+            co_await Core::ResumeOnPool(Core::TaskPriority::Interactive);
+            co_await Core::ResumeOnUiThread(ui);
+        }
+        done = true;
+    }
+
+    Core::Task<void> PoolRoundTrip(Core::UiDispatcher& ui, size_t& completed)
+    {
+        co_await Core::ResumeOnPool();
+        co_await Core::ResumeOnUiThread(ui);
+        ++completed;
+    }
+
+    Core::Task<void> DelayOnce(size_t& completed)
+    {
+        co_await Core::Delay(std::chrono::milliseconds(1));
+        ++completed;
+    }
+
+    void PrintRate(const char* name, size_t operations, double nanoseconds)
+    {
+        std::printf("%-48s %10zu ops %12.1f ns/op %12.0f ops/s\n", name, operations, nanoseconds / static_cast<double>(operations),
+                    static_cast<double>(operations) * 1e9 / nanoseconds);
+    }
+
+    void RunUntil(Core::UiDispatcher& ui, const bool& done)
+    {
+        while (!done)
+            ui.WaitAndRunPending(std::chrono::milliseconds(10));
+    }
+
+    void RunUntil(Core::UiDispatcher& ui, const size_t& completed, size_t target)
+    {
+        while (completed < target)
+            ui.WaitAndRunPending(std::chrono::milliseconds(10));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+    Core::UiDispatcher ui;
+
+    std::printf("\nSuspend and resume cost\n");
+    {
+        const size_t count = Scaled(2000000, scale);
+        int64_t total = 0;
+        const Clock::time_point start = Clock::now();
+        Core::StartDetached(AwaitLeaves(count, total));
+        PrintRate("co_await Task<int> (completes inline)", count, ElapsedNanoseconds(start));
+        DoNotOptimize(total);
+    }
+    {
+        const size_t count = Scaled(1000000, scale);
+        bool done = false;
+        const Clock::time_point start = Clock::now();
+        Core::StartDetached(YieldRepeatedly(ui, count, done));
+        RunUntil(ui, done);
+        PrintRate("suspend + Post + resume on the UI thread", count, ElapsedNanoseconds(start));
+    }
+    {
+        const size_t count = Scaled(50000, scale);
+        bool done = false;
+        const Clock::time_point start = Clock::now();
+        Core::StartDetached(HopRepeatedly(ui, count, done));
+        RunUntil(ui, done);
+        PrintRate("UI -> pool -> UI round trip", count, ElapsedNanoseconds(start));
+    }
+
+    std::printf("\nConcurrent tasks\n");
+    for (size_t tasks : {size_t{1000}, size_t{10000}, size_t{100000}})
+    {
+        tasks = Scaled(tasks, scale);
+        char name[96];
+
+        size_t completed = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t index = 0; index < tasks; ++index)
+            Core::StartDetached(PoolRoundTrip(ui, completed));
+        RunUntil(ui, completed, tasks);
+        std::snprintf(name, sizeof(name), "%zu tasks, UI -> pool -> UI", tasks);
+        PrintRate(name, tasks, ElapsedNanoseconds(start));
+
+        completed = 0;
+        start = Clock::now();
+        for (size_t index = 0; index < tasks; ++index)
+            Core::StartDetached(DelayOnce(completed));
+        RunUntil(ui, completed, tasks);
+        std::snprintf(name, sizeof(name), "%zu tasks, Delay(1 ms) on the UI thread", tasks);
+        PrintRate(name, tasks, ElapsedNanoseconds(start));
+    }
+    return 0;
+}
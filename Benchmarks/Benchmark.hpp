@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WinCore::Benchmarks
+{
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @struct LatencySummary
+     * @brief Percentiles of a set of samples, in nanoseconds.
+     */
+    struct LatencySummary
+    {
+        size_t Count{0};
+        double Mean{0.0};
+        double P50{0.0};
+        double P99{0.0};
+        double P999{0.0};
+        double Max{0.0};
+    };
+
+    /**
+     * Sorts the samples and computes their percentiles.
+     * @param samples The samples in nanoseconds, reordered by the call.
+     */
+    inline LatencySummary Summarize(std::vector<double>& samples)
+    {
+        LatencySummary summary{};
+        if (samples.empty())
+            return summary;
+
+        std::sort(samples.begin(), samples.end());
+        const auto at = [&samples](double percentile) {
+            const size_t index = static_cast<size_t>(percentile * static_cast<double>(samples.size() - 1) + 0.5);
+            return samples[std::min(index, samples.size() - 1)];
+        };
+
+        double total = 0.0;
+        for (double sample : samples)
+            total += sample;
+
+        summary.Count = samples.size();
+        summary.Mean = total / static_cast<double>(samples.size());
+        summary.P50 = at(0.50);
+        summary.P99 = at(0.99);
+        summary.P999 = at(0.999);
+        summary.Max = samples.back();
+        return summary;
+    }
+
+    /**
+     * Prints a latency summary as one row of a table.
+     */
+    inline void PrintLatency(const char* name, const LatencySummary& summary)
+    {
+        std::printf("%-40s %10zu %10.1f %10.1f %10.1f %10.1f %12.1f\n", name, summary.Count, summary.Mean,
+                    summary.P50, summary.P99, summary.P999, summary.Max);
+    }
+
+    /**
+     * Prints the header matching PrintLatency.
+     */
+    inline void PrintLatencyHeader(const char* title)
+    {
+        std::printf("\n%s (ns)\n%-40s %10s %10s %10s %10s %10s %12s\n", title, "case", "samples", "mean", "p50", "p99", "p99.9", "max");
+    }
+
+    /**
+     * Returns the elapsed time since start in nanoseconds.
+     */
+    inline double ElapsedNanoseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    /**
+     * Returns 1, 2, 4, ... up to the number of hardware threads, which is always included.
+     * @param atLeast Extends the series to this many threads on smaller machines.
+     */
+    inline std::vector<size_t> ThreadCounts(size_t atLeast = 1)
+    {
+        const size_t maximum = std::max<size_t>({1, atLeast, std::thread::hardware_concurrency()});
+        std::vector<size_t> counts;
+        for (size_t count = 1; count < maximum; count *= 2)
+            counts.push_back(count);
+        counts.push_back(maximum);
+        return counts;
+    }
+
+    /**
+     * Reads "--scale=<factor>" from the command line, used to shorten runs (e.g. --scale=0.1).
+     * @return The factor applied to iteration counts, 1 by default.
+     */
+    inline double ParseScale(int argc, char** argv)
+    {
+        const std::string prefix = "--scale=";
+        for (int index = 1; index < argc; ++index)
+        {
+            const std::string argument = argv[index];
+            if (argument.compare(0, prefix.size(), prefix) == 0)
+                return std::max(0.001, std::atof(argument.c_str() + prefix.size()));
+        }
+        return 1.0;
+    }
+
+    /**
+     * Scales an iteration count, keeping at least one iteration.
+     */
+    inline size_t Scaled(size_t iterations, double scale)
+    {
+        return std::max<size_t>(1, static_cast<size_t>(static_cast<double>(iterations) * scale));
+    }
+
+    /**
+     * Keeps the compiler from optimizing a value away.
+     */
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+}
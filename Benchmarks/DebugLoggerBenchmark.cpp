@@ -0,0 +1,108 @@
+#include <barrier>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "DebugLogger.hpp"
+
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    /**
+     * Runs the same number of timed calls on every thread and merges their latencies.
+     */
+    template<typename Call>
+    LatencySummary MeasureCallSite(size_t threadCount, size_t callsPerThread, const Call& call)
+    {
+        std::vector<std::vector<double>> samples(threadCount);
+        std::barrier start(static_cast<std::ptrdiff_t>(threadCount));
+        std::vector<std::thread> threads;
+        for (size_t thread = 0; thread < threadCount; ++thread)
+        {
+            threads.emplace_back([&, thread] {
+                std::vector<double>& own = samples[thread];
+                own.reserve(callsPerThread);
+                start.arrive_and_wait();
+                for (size_t index = 0; index < callsPerThread; ++index)
+                {
+                    const Clock::time_point begin = Clock::now();
+                    call(thread, index);
+                    own.push_back(ElapsedNanoseconds(begin));
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+
+        std::vector<double> merged;
+        for (const std::vector<double>& own : samples)
+            merged.insert(merged.end(), own.begin(), own.end());
+        return Summarize(merged);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+    const size_t callsPerThread = Scaled(200000, scale);
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string loggerPath = (directory / "wincore-logger-benchmark.log").string();
+    const std::string printfPath = (directory / "wincore-printf-benchmark.log").string();
+
+    // The timer itself, subtract it when comparing the cases.
+    {
+        PrintLatencyHeader("Clock overhead");
+        PrintLatency("empty call", MeasureCallSite(1, callsPerThread, [](size_t, size_t) {}));
+    }
+
+    for (size_t threadCount : ThreadCounts(4))
+    {
+        char title[64];
+        std::snprintf(title, sizeof(title), "Call-site latency, %zu thread(s)", threadCount);
+        PrintLatencyHeader(title);
+
+        Utils::DebugLoggerSettings settings{};
+        settings.MinimumLevel = Utils::LogLevel::Info;
+        settings.Outputs = Utils::LogOutput::TextFile;
+        settings.TextFilePath = loggerPath;
+        settings.InstallCrashHandlers = false;
+        Utils::DebugLogger::Start(settings);
+        const LatencySummary logger = MeasureCallSite(threadCount, callsPerThread, [](size_t thread, size_t index) {
+            WINCORE_LOG_INFO("thread {} frame {} took {} ms in '{}'", thread, index, 16.6, "MainWindow");
+        });
+        Utils::DebugLogger::Flush();
+        const uint64_t dropped = Utils::DebugLogger::GetDroppedCount();
+        Utils::DebugLogger::Stop();
+        PrintLatency("WINCORE_LOG_INFO (text file)", logger);
+
+        settings.OverflowPolicy = Utils::LogOverflowPolicy::Block;
+        Utils::DebugLogger::Start(settings);
+        PrintLatency("WINCORE_LOG_INFO (text file, blocking)", MeasureCallSite(threadCount, callsPerThread, [](size_t thread, size_t index) {
+            WINCORE_LOG_INFO("thread {} frame {} took {} ms in '{}'", thread, index, 16.6, "MainWindow");
+        }));
+        Utils::DebugLogger::Stop();
+
+        FILE* file = std::fopen(printfPath.c_str(), "w");
+        if (!file)
+        {
+            std::fprintf(stderr, "Cannot open %s\n", printfPath.c_str());
+            return 1;
+        }
+        PrintLatency("fprintf (text file)", MeasureCallSite(threadCount, callsPerThread, [file](size_t thread, size_t index) {
+            std::fprintf(file, "[Info] thread %zu frame %zu took %g ms in '%s'\n", thread, index, 16.6, "MainWindow");
+        }));
+        std::fclose(file);
+
+        if (dropped != 0)
+            std::printf("  (the dropping logger discarded %llu records with full buffers)\n", static_cast<unsigned long long>(dropped));
+    }
+
+    std::filesystem::remove(loggerPath);
+    std::filesystem::remove(printfPath);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "ImageCodec.hpp"
+#include "ImageResampler.hpp"
+#include "ThreadPool.hpp"
+
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    UI::Bitmap MakeRandomPremultiplied(uint32_t width, uint32_t height)
+    {
+        std::mt19937 random(7);
+        UI::Bitmap bitmap(width, height);
+        for (size_t index = 0; index < bitmap.Pixels.size(); index += 4)
+        {
+            const uint8_t alpha = static_cast<uint8_t>(random() % 256);
+            for (size_t channel = 0; channel < 3; ++channel)
+                bitmap.Pixels[index + channel] = static_cast<uint8_t>(random() % (alpha + 1u));
+            bitmap.Pixels[index + 3] = alpha;
+        }
+        return bitmap;
+    }
+
+    const char* GetFilterName(UI::ResampleFilter filter)
+    {
+        switch (filter)
+        {
+            case UI::ResampleFilter::Box: return "Box";
+            case UI::ResampleFilter::Bilinear: return "Bilinear";
+            case UI::ResampleFilter::Lanczos3: return "Lanczos3";
+        }
+        return "?";
+    }
+
+    /**
+     * Runs the call repeatedly and returns the fastest run in milliseconds.
+     */
+    template<typename Call>
+    double MeasureBest(size_t repetitions, const Call& call)
+    {
+        double best = 0.0;
+        for (size_t run = 0; run < repetitions; ++run)
+        {
+            const Clock::time_point start = Clock::now();
+            call();
+            const double elapsed = ElapsedNanoseconds(start) / 1e6;
+            if (run == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+
+    void PrintRow(const char* name, double milliseconds, double megapixels)
+    {
+        std::printf("%-44s %10.2f ms %10.1f MP/s\n", name, milliseconds, megapixels / (milliseconds / 1e3));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+    const size_t repetitions = Scaled(10, scale);
+    const UI::Bitmap source = MakeRandomPremultiplied(1920, 1080);
+    const double sourceMegapixels = static_cast<double>(source.Width) * source.Height / 1e6;
+
+    std::printf("\nCodec, %ux%u\n", source.Width, source.Height);
+    std::vector<uint8_t> encoded;
+    PrintRow("EncodeBmp", MeasureBest(repetitions, [&] { encoded = UI::ImageCodec::EncodeBmp(source); }), sourceMegapixels);
+    PrintRow("DecodeBmp (32-bit bitfields)", MeasureBest(repetitions, [&] { DoNotOptimize(UI::ImageCodec::Decode(encoded)); }),
+             sourceMegapixels);
+
+    std::printf("\nResample %ux%u -> 1280x720 and 2560x1440, single thread\n", source.Width, source.Height);
+    for (UI::ResampleFilter filter : {UI::ResampleFilter::Box, UI::ResampleFilter::Bilinear, UI::ResampleFilter::Lanczos3})
+    {
+        for (const auto& size : {std::pair<uint32_t, uint32_t>{1280, 720}, std::pair<uint32_t, uint32_t>{2560, 1440}})
+        {
+            const double megapixels = static_cast<double>(size.first) * size.second / 1e6;
+            char name[96];
+            std::snprintf(name, sizeof(name), "%s %ux%u, scalar", GetFilterName(filter), size.first, size.second);
+            const double scalar = MeasureBest(repetitions, [&] {
+                DoNotOptimize(UI::ImageResampler::ResampleScalar(source, size.first, size.second, filter));
+            });
+            PrintRow(name, scalar, megapixels);
+
+            std::snprintf(name, sizeof(name), "%s %ux%u, SIMD", GetFilterName(filter), size.first, size.second);
+            const double simd = MeasureBest(repetitions, [&] {
+                DoNotOptimize(UI::ImageResampler::Resample(source, size.first, size.second, filter));
+            });
+            PrintRow(name, simd, megapixels);
+            std::printf("%-44s %10.2fx\n", "  speedup", scalar / simd);
+        }
+    }
+
+    std::printf("\nResample Lanczos3 %ux%u -> 1280x720 on a pool\n", source.Width, source.Height);
+    for (size_t workers : ThreadCounts())
+    {
+        Core::ThreadPool pool(workers);
+        char name[96];
+        std::snprintf(name, sizeof(name), "%zu worker(s) + caller", workers);
+        PrintRow(name, MeasureBest(repetitions, [&] {
+            DoNotOptimize(UI::ImageResampler::Resample(source, 1280, 720, UI::ResampleFilter::Lanczos3, &pool));
+        }), 1280.0 * 720.0 / 1e6);
+    }
+    return 0;
+}
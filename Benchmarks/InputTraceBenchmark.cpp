@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "FrameScheduler.hpp"
+#include "InputTrace.hpp"
+#include "Painter.hpp"
+
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    constexpr uint32_t MsgSize = 0x0005;
+    constexpr uint32_t MsgPaint = 0x000F;
+    constexpr uint32_t MsgKeyDown = 0x0100;
+    constexpr uint32_t MsgUser = 0x0400;
+    constexpr uint32_t MsgMouseMove = 0x0200;
+    constexpr uint32_t MsgMouseLast = 0x020E;
+
+    constexpr size_t WindowCount = 3;
+    constexpr size_t WidgetsPerWindow = 200;
+
+    /**
+     * Reads "--trace=<path>" from the command line.
+     * @return The path of a recorded trace to replay, empty to replay a synthetic one.
+     */
+    std::string ParseTracePath(int argc, char** argv)
+    {
+        const std::string prefix = "--trace=";
+        for (int index = 1; index < argc; ++index)
+        {
+            const std::string argument = argv[index];
+            if (argument.compare(0, prefix.size(), prefix) == 0)
+                return argument.substr(prefix.size());
+        }
+        return {};
+    }
+
+    /**
+     * Records a session over a few windows: mouse moves every frame, a key press now and then and
+     * a resize that forces layout every thirtieth frame. Messages the recorder skips are mixed in.
+     */
+    void RecordSyntheticTrace(const std::string& path, size_t frames)
+    {
+        Core::InputTraceRecorder recorder(path);
+        const int windows[WindowCount] = {};
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            const void* window = &windows[frame / 20 % WindowCount];
+            for (int move = 0; move < 4; ++move)
+            {
+                const int64_t x = static_cast<int64_t>((frame * 4 + static_cast<size_t>(move)) % 400);
+                const int64_t y = static_cast<int64_t>(frame % 300);
+                recorder.Record(window, MsgMouseMove, 0, y << 16 | x);
+            }
+            if (frame % 10 == 0)
+                recorder.Record(window, MsgKeyDown, 0x41, 1);
+            if (frame % 30 == 0)
+                recorder.Record(window, MsgSize, 0, 300 << 16 | 400);
+            recorder.Record(window, MsgUser, frame, 0);
+            recorder.RecordFrameBoundary();
+        }
+    }
+
+    /**
+     * A headless window: a surface and the widget rectangles its layout pass produces.
+     */
+    struct ReplayWindow
+    {
+        UI::Bitmap Surface{400, 300};
+        std::vector<UI::PixelRect> Widgets{};
+        int64_t Pointer{0};     //< The LPARAM of the last mouse message, tints the paint.
+    };
+
+    /**
+     * Drives a FrameScheduler from replayed messages. The scheduler runs on a manual clock that
+     * jumps to the next refresh at every frame boundary, so replays do not wait for real refreshes.
+     */
+    class ReplayPipeline
+    {
+        public:
+            ReplayPipeline() : scheduler_(clock_) {}
+
+            ~ReplayPipeline()
+            {
+                for (const auto& [id, window] : windows_)
+                    scheduler_.UnregisterWindow(window.get());
+            }
+
+            ReplayPipeline(const ReplayPipeline&) = delete;
+            ReplayPipeline& operator=(const ReplayPipeline&) = delete;
+
+            Core::ReplayTarget GetTarget()
+            {
+                Core::ReplayTarget target{};
+                target.Dispatch = [this](const Core::TraceEntry& entry) { Dispatch(entry); };
+                // Tick runs the layout and paint callbacks of the scheduled windows, the report counts both as paint.
+                target.Paint = [this] { Tick(); };
+                return target;
+            }
+
+            [[nodiscard]] const Core::FrameScheduler& GetScheduler() const noexcept { return scheduler_; }
+
+        private:
+            ReplayWindow& GetWindow(uint32_t id)
+            {
+                std::unique_ptr<ReplayWindow>& window = windows_[id];
+                if (!window)
+                {
+                    window = std::make_unique<ReplayWindow>();
+                    ReplayWindow* state = window.get();
+                    Core::FrameCallbacks callbacks{};
+                    callbacks.Layout = [state](const Core::FrameContext&) { Layout(*state); };
+                    callbacks.Paint = [state](const Core::FrameContext&) { Paint(*state); };
+                    scheduler_.RegisterWindow(state, 60, std::move(callbacks));
+                    scheduler_.Invalidate(state, Core::FrameDirty::Layout);
+                }
+                return *window;
+            }
+
+            void Dispatch(const Core::TraceEntry& entry)
+            {
+                ReplayWindow& window = GetWindow(entry.WindowId);
+                if (entry.Message == MsgSize)
+                {
+                    scheduler_.Invalidate(&window, Core::FrameDirty::Layout | Core::FrameDirty::Paint);
+                }
+                else if ((entry.Message >= MsgMouseMove && entry.Message <= MsgMouseLast) || entry.Message == MsgKeyDown)
+                {
+                    window.Pointer = entry.LParam;
+                    scheduler_.RecordInput(&window, clock_.Now());
+                    scheduler_.Invalidate(&window);
+                }
+                else if (entry.Message == MsgPaint)
+                {
+                    scheduler_.Invalidate(&window);
+                }
+            }
+
+            void Tick()
+            {
+                if (const std::optional<std::chrono::nanoseconds> deadline = scheduler_.GetNextDeadline())
+                    clock_.Set(std::max(clock_.Now(), *deadline));
+                scheduler_.Tick();
+            }
+
+            static void Layout(ReplayWindow& window)
+            {
+                window.Widgets.clear();
+                const int32_t width = static_cast<int32_t>(window.Surface.Width);
+                for (size_t index = 0; index < WidgetsPerWindow; ++index)
+                {
+                    const int32_t column = static_cast<int32_t>(index % 10);
+                    const int32_t row = static_cast<int32_t>(index / 10);
+                    window.Widgets.push_back(UI::PixelRect{column * width / 10 + 2, row * 15 + 2, width / 10 - 4, 11});
+                }
+            }
+
+            static void Paint(ReplayWindow& window)
+            {
+                UI::Painter painter(window.Surface);
+                painter.Clear(UI::Color::FromRgba(240, 240, 240));
+                const auto tint = static_cast<uint8_t>(window.Pointer & 0xFF);
+                for (const UI::PixelRect& widget : window.Widgets)
+                    painter.FillRect(widget, UI::Color::FromRgba(tint, 120, 200, 160));
+            }
+
+            Core::ManualFrameClock clock_{};
+            Core::FrameScheduler scheduler_;
+            std::unordered_map<uint32_t, std::unique_ptr<ReplayWindow>> windows_{};
+    };
+
+    void AddMilliseconds(std::vector<double>& samples, double milliseconds)
+    {
+        samples.push_back(milliseconds * 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+    std::string path = ParseTracePath(argc, argv);
+    const bool synthetic = path.empty();
+    if (synthetic)
+    {
+        path = (std::filesystem::temp_directory_path() / "WinCoreInputTraceBenchmark.trace").string();
+        RecordSyntheticTrace(path, Scaled(2000, scale));
+    }
+
+    Core::InputTraceReader reader(path);
+    std::vector<double> totals;
+    std::vector<double> dispatches;
+    std::vector<double> ticks;
+    Core::ReplayReport report{};
+    ReplayPipeline pipeline;
+    const Core::ReplayTarget target = pipeline.GetTarget();
+
+    // The first replay registers the windows and warms the caches, later ones are measured.
+    const size_t replays = Scaled(10, scale) + 1;
+    for (size_t replay = 0; replay < replays; ++replay)
+    {
+        report = Core::InputTraceReplayer::Replay(reader, target);
+        if (replay == 0)
+            continue;
+
+        for (const Core::ReplayFrameTiming& frame : report.Frames)
+        {
+            AddMilliseconds(totals, frame.TotalMs);
+            AddMilliseconds(dispatches, frame.DispatchMs);
+            AddMilliseconds(ticks, frame.LayoutMs + frame.PaintMs);
+        }
+    }
+
+    std::printf("\nTrace %s: %zu bytes, %zu frames, %llu messages, replayed %zu times\n", synthetic ? "(synthetic)" : path.c_str(),
+                static_cast<size_t>(std::filesystem::file_size(path)), report.Frames.size(),
+                static_cast<unsigned long long>(report.MessageCount), replays - 1);
+    std::printf("last replay: p50 %.3f ms, p99 %.3f ms, wall time %.1f ms, %llu frames rendered by the scheduler\n",
+                report.GetFrameTimePercentile(50.0), report.GetFrameTimePercentile(99.0), report.WallTimeMs,
+                static_cast<unsigned long long>(pipeline.GetScheduler().GetStatistics().Frames));
+
+    PrintLatencyHeader("Replayed frame time");
+    PrintLatency("frame (dispatch + tick)", Summarize(totals));
+    PrintLatency("dispatch", Summarize(dispatches));
+    PrintLatency("scheduler tick (layout + paint)", Summarize(ticks));
+
+    if (synthetic)
+        std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Memory.hpp"
+
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    std::atomic<uint64_t> s_heapAllocations{0};
+
+    void* CountedAllocate(size_t bytes)
+    {
+        s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* pointer = std::malloc(bytes ? bytes : 1))
+            return pointer;
+        throw std::bad_alloc();
+    }
+}
+
+// Every global heap allocation of the process is counted.
+void* operator new(size_t bytes) { return CountedAllocate(bytes); }
+void* operator new[](size_t bytes) { return CountedAllocate(bytes); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+
+namespace
+{
+    constexpr size_t EventsPerFrame = 50;
+    constexpr size_t WidgetsPerFrame = 500;
+    constexpr size_t LabelsPerFrame = 100;
+
+    struct DrawCommand
+    {
+        float Rect[4];
+        uint32_t Color;
+    };
+
+    struct HeapEvent
+    {
+        int Kind;
+        int X;
+        int Y;
+        std::string Text;
+    };
+
+    struct PooledEvent
+    {
+        int Kind;
+        int X;
+        int Y;
+        std::pmr::string Text;
+    };
+
+    /**
+     * A frame of the synthetic workload the way the pipeline used to allocate it.
+     */
+    void RunHeapFrame()
+    {
+        std::vector<HeapEvent*> events;
+        for (size_t index = 0; index < EventsPerFrame; ++index)
+            events.push_back(new HeapEvent{static_cast<int>(index), 1, 2, "WM_MOUSEMOVE over the main content area"});
+
+        std::vector<float> layout;
+        for (size_t index = 0; index < WidgetsPerFrame * 4; ++index)
+            layout.push_back(static_cast<float>(index));
+
+        std::vector<DrawCommand> commands;
+        for (size_t index = 0; index < WidgetsPerFrame; ++index)
+            commands.push_back(DrawCommand{{1.0f, 2.0f, 3.0f, 4.0f}, 0xFF000000u | static_cast<uint32_t>(index)});
+
+        std::vector<std::string> labels;
+        for (size_t index = 0; index < LabelsPerFrame; ++index)
+            labels.push_back("Label number " + std::to_string(index) + " with some padding");
+
+        DoNotOptimize(layout.data());
+        DoNotOptimize(commands.data());
+        for (HeapEvent* event : events)
+            delete event;
+    }
+
+    /**
+     * The same frame with events from the Events pool and everything else in the frame arena.
+     */
+    void RunArenaFrame(Utils::FrameArena& arena)
+    {
+        std::pmr::polymorphic_allocator<PooledEvent> eventAllocator(&Utils::ObjectPool::Shared(Utils::MemorySubsystem::Events));
+        std::pmr::vector<PooledEvent*> events(&arena.For(Utils::MemorySubsystem::Events));
+        for (size_t index = 0; index < EventsPerFrame; ++index)
+        {
+            events.push_back(eventAllocator.new_object<PooledEvent>(static_cast<int>(index), 1, 2,
+                                                                    std::pmr::string("WM_MOUSEMOVE over the main content area",
+                                                                                     &arena.For(Utils::MemorySubsystem::Text))));
+        }
+
+        std::pmr::vector<float> layout(&arena.For(Utils::MemorySubsystem::Layout));
+        for (size_t index = 0; index < WidgetsPerFrame * 4; ++index)
+            layout.push_back(static_cast<float>(index));
+
+        std::pmr::vector<DrawCommand> commands(&arena.For(Utils::MemorySubsystem::Drawing));
+        for (size_t index = 0; index < WidgetsPerFrame; ++index)
+            commands.push_back(DrawCommand{{1.0f, 2.0f, 3.0f, 4.0f}, 0xFF000000u | static_cast<uint32_t>(index)});
+
+        std::pmr::vector<std::pmr::string> labels(&arena.For(Utils::MemorySubsystem::Text));
+        for (size_t index = 0; index < LabelsPerFrame; ++index)
+        {
+            // std::to_chars like std::to_string in the heap frame, snprintf alone would dominate the frame.
+            char number[24];
+            const std::to_chars_result digits = std::to_chars(number, number + sizeof(number), index);
+            std::pmr::string label("Label number ", &arena.For(Utils::MemorySubsystem::Text));
+            label.append(number, digits.ptr);
+            label += " with some padding";
+            labels.push_back(std::move(label));
+        }
+
+        DoNotOptimize(layout.data());
+        DoNotOptimize(commands.data());
+        for (PooledEvent* event : events)
+            eventAllocator.delete_object(event);
+    }
+
+    void PrintFrameRow(const char* name, double allocationsPerFrame, double microsecondsPerFrame)
+    {
+        std::printf("%-36s %16.2f %16.2f\n", name, allocationsPerFrame, microsecondsPerFrame);
+    }
+
+    /**
+     * Allocates and frees mixed sizes on several threads, with a share of the blocks freed by another thread.
+     */
+    template<typename Allocate, typename Free>
+    double MeasureContention(size_t threadCount, size_t operationsPerThread, const Allocate& allocate, const Free& free)
+    {
+        std::vector<std::vector<std::pair<void*, size_t>>> handoff(threadCount);
+        std::vector<std::thread> threads;
+        const Clock::time_point start = Clock::now();
+        for (size_t thread = 0; thread < threadCount; ++thread)
+        {
+            threads.emplace_back([&, thread] {
+                std::vector<std::pair<void*, size_t>> live;
+                live.reserve(64);
+                for (size_t index = 0; index < operationsPerThread; ++index)
+                {
+                    const size_t bytes = 16 + (index * 37) % 1000;
+                    live.emplace_back(allocate(bytes), bytes);
+                    if (live.size() == 64)
+                    {
+                        for (const auto& [pointer, size] : live)
+                            free(pointer, size);
+                        live.clear();
+                    }
+                }
+                handoff[thread] = std::move(live);
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        for (const auto& blocks : handoff)
+        {
+            for (const auto& [pointer, size] : blocks)
+                free(pointer, size);
+        }
+        return ElapsedNanoseconds(start) / static_cast<double>(threadCount * operationsPerThread);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+    const size_t frames = Scaled(2000, scale);
+    const size_t warmupFrames = 10;
+
+    std::printf("\nSynthetic frame: %zu events, %zu widgets of layout and draw commands, %zu labels\n", EventsPerFrame,
+                WidgetsPerFrame, LabelsPerFrame);
+    std::printf("%-36s %16s %16s\n", "case", "heap allocs/frame", "us/frame");
+    {
+        for (size_t frame = 0; frame < warmupFrames; ++frame)
+            RunHeapFrame();
+        const uint64_t allocations = s_heapAllocations.load();
+        const Clock::time_point start = Clock::now();
+        for (size_t frame = 0; frame < frames; ++frame)
+            RunHeapFrame();
+        PrintFrameRow("new / std::string / std::vector", static_cast<double>(s_heapAllocations.load() - allocations) / frames,
+                      ElapsedNanoseconds(start) / 1e3 / frames);
+    }
+    {
+        Utils::FrameArena& arena = Utils::FrameArena::ForCurrentThread();
+        for (size_t frame = 0; frame < warmupFrames; ++frame)
+        {
+            RunArenaFrame(arena);
+            arena.Reset();
+        }
+        Utils::MemoryStatistics::Reset();
+        const uint64_t allocations = s_heapAllocations.load();
+        const Clock::time_point start = Clock::now();
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            RunArenaFrame(arena);
+            arena.Reset();
+        }
+        PrintFrameRow("FrameArena + ObjectPool", static_cast<double>(s_heapAllocations.load() - allocations) / frames,
+                      ElapsedNanoseconds(start) / 1e3 / frames);
+        std::printf("arena high water mark %zu bytes, capacity %zu bytes\n", arena.GetHighWaterMark(), arena.GetCapacity());
+    }
+
+    std::printf("\nPer subsystem counters of the pooled frames\n%-12s %14s %14s %14s %14s\n", "subsystem", "allocations",
+                "deallocations", "upstream", "bytes");
+    for (size_t index = 0; index < static_cast<size_t>(Utils::MemorySubsystem::Count); ++index)
+    {
+        const auto subsystem = static_cast<Utils::MemorySubsystem>(index);
+        const Utils::MemoryCounters counters = Utils::MemoryStatistics::GetCounters(subsystem);
+        std::printf("%-12s %14llu %14llu %14llu %14llu\n", Utils::MemoryStatistics::GetName(subsystem),
+                    static_cast<unsigned long long>(counters.Allocations), static_cast<unsigned long long>(counters.Deallocations),
+                    static_cast<unsigned long long>(counters.UpstreamAllocations),
+                    static_cast<unsigned long long>(counters.BytesAllocated));
+    }
+
+    std::printf("\nAllocate and free 16..1015 bytes (ns/op)\n%-10s %14s %14s\n", "threads", "malloc/free", "ObjectPool");
+    const size_t operations = Scaled(1000000, scale);
+    Utils::ObjectPool pool(Utils::MemorySubsystem::Widgets);
+    for (size_t threadCount : ThreadCounts(4))
+    {
+        const double heap = MeasureContention(threadCount, operations,
+                                              [](size_t bytes) { return std::malloc(bytes); },
+                                              [](void* pointer, size_t) { std::free(pointer); });
+        const double pooled = MeasureContention(threadCount, operations,
+                                                [&pool](size_t bytes) { return pool.allocate(bytes, 8); },
+                                                [&pool](void* pointer, size_t bytes) { pool.deallocate(pointer, bytes, 8); });
+        std::printf("%-10zu %14.1f %14.1f\n", threadCount, heap, pooled);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "ThreadPool.hpp"
+
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    /**
+     * A few hundred nanoseconds of arithmetic per element, standing in for pixel or layout work.
+     */
+    double ComputeElement(size_t index)
+    {
+        double value = static_cast<double>(index);
+        for (int round = 0; round < 64; ++round)
+            value = std::sqrt(value * 1.0001 + 1.0);
+        return value;
+    }
+
+    /**
+     * Splits a range in halves until it is small, spawning the halves as nested groups.
+     */
+    void RecursiveSum(Core::ThreadPool& pool, size_t first, size_t last, std::atomic<uint64_t>& total)
+    {
+        if (last - first <= 256)
+        {
+            uint64_t sum = 0;
+            for (size_t index = first; index < last; ++index)
+                sum += index;
+            total.fetch_add(sum, std::memory_order_relaxed);
+            return;
+        }
+
+        const size_t middle = first + (last - first) / 2;
+        Core::TaskGroup group(pool);
+        group.Run([&pool, first, middle, &total] { RecursiveSum(pool, first, middle, total); });
+        RecursiveSum(pool, middle, last, total);
+        group.Wait();
+    }
+
+    void PrintScalingHeader(const char* title)
+    {
+        std::printf("\n%s\n%-10s %14s %14s %10s\n", title, "workers", "ms", "items/s", "speedup");
+    }
+
+    void PrintScalingRow(size_t workers, size_t items, double nanoseconds, double baseline)
+    {
+        std::printf("%-10zu %14.2f %14.0f %10.2f\n", workers, nanoseconds / 1e6, static_cast<double>(items) * 1e9 / nanoseconds,
+                    baseline / nanoseconds);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+    const std::vector<size_t> workerCounts = ThreadCounts();
+    std::printf("hardware threads: %u, the calling thread joins ParallelFor and group waits\n", std::thread::hardware_concurrency());
+
+    {
+        PrintScalingHeader("ParallelFor, compute bound");
+        const size_t count = Scaled(4000000, scale);
+        std::vector<double> output(count);
+        double baseline = 0.0;
+        for (size_t workers : workerCounts)
+        {
+            Core::ThreadPool pool(workers);
+            const Clock::time_point start = Clock::now();
+            pool.ParallelFor(0, count, 1024, [&output](size_t first, size_t last) {
+                for (size_t index = first; index < last; ++index)
+                    output[index] = ComputeElement(index);
+            });
+            const double elapsed = ElapsedNanoseconds(start);
+            if (baseline == 0.0)
+                baseline = elapsed;
+            PrintScalingRow(workers, count, elapsed, baseline);
+        }
+        DoNotOptimize(output.data());
+    }
+
+    {
+        PrintScalingHeader("Recursive TaskGroup spawn, stealing bound");
+        const size_t count = Scaled(16000000, scale);
+        double baseline = 0.0;
+        for (size_t workers : workerCounts)
+        {
+            Core::ThreadPool pool(workers);
+            std::atomic<uint64_t> total{0};
+            const Clock::time_point start = Clock::now();
+            Core::TaskGroup root(pool);
+            root.Run([&pool, count, &total] { RecursiveSum(pool, 0, count, total); });
+            root.Wait();
+            const double elapsed = ElapsedNanoseconds(start);
+            if (baseline == 0.0)
+                baseline = elapsed;
+            PrintScalingRow(workers, count, elapsed, baseline);
+            DoNotOptimize(total);
+        }
+    }
+
+    {
+        PrintScalingHeader("Submit from outside the pool, injection bound");
+        const size_t count = Scaled(500000, scale);
+        double baseline = 0.0;
+        for (size_t workers : workerCounts)
+        {
+            Core::ThreadPool pool(workers);
+            std::atomic<size_t> completed{0};
+            const Clock::time_point start = Clock::now();
+            for (size_t index = 0; index < count; ++index)
+                pool.Submit([&completed] { completed.fetch_add(1, std::memory_order_relaxed); });
+            while (completed.load(std::memory_order_relaxed) < count)
+                std::this_thread::yield();
+            const double elapsed = ElapsedNanoseconds(start);
+            if (baseline == 0.0)
+                baseline = elapsed;
+            PrintScalingRow(workers, count, elapsed, baseline);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "UiThread.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore;
+using namespace WinCore::Benchmarks;
+
+namespace
+{
+    constexpr size_t WindowCount = 8;
+    constexpr std::chrono::milliseconds InputInterval = 16ms;
+    constexpr std::chrono::milliseconds SlowHandlerTime = 40ms;    //< Every eighth input of window 0 blocks this long.
+
+    struct Samples
+    {
+        std::mutex Mutex{};
+        std::vector<double> SharingSlowThread{};    //< Windows on the same thread as the slow window.
+        std::vector<double> OtherThreads{};
+    };
+
+    /**
+     * Spreads the windows over the UI threads and sends every window one input per interval. Window 0
+     * stalls its thread now and then, the time from posting an input to handling it is recorded for
+     * every other window.
+     */
+    void Measure(size_t threadCount, size_t rounds, Samples& samples)
+    {
+        std::vector<std::unique_ptr<Core::UiThread>> threads;
+        for (size_t index = 0; index < threadCount; ++index)
+            threads.push_back(std::make_unique<Core::UiThread>("WinCore UI " + std::to_string(index)));
+
+        // Stand-ins for HWNDs, only their addresses are used as window keys.
+        std::vector<int> windows(WindowCount);
+        for (size_t index = 0; index < WindowCount; ++index)
+        {
+            Core::UiThread& thread = *threads[index % threadCount];
+            thread.Invoke([&thread, window = &windows[index]] { thread.GetDispatcher().AttachWindow(window); }).get();
+        }
+
+        size_t slowInputs = 0;
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            const Clock::time_point sent = Clock::now();
+            for (size_t index = 0; index < WindowCount; ++index)
+            {
+                if (index == 0)
+                {
+                    const bool slow = ++slowInputs % 8 == 0;
+                    Core::WindowThread::Post(&windows[index], [slow] {
+                        if (slow)
+                            std::this_thread::sleep_for(SlowHandlerTime);
+                    });
+                    continue;
+                }
+
+                const bool sharing = index % threadCount == 0;
+                Core::WindowThread::Post(&windows[index], [&samples, sent, sharing] {
+                    const double latency = ElapsedNanoseconds(sent);
+                    std::lock_guard lock(samples.Mutex);
+                    (sharing ? samples.SharingSlowThread : samples.OtherThreads).push_back(latency);
+                });
+            }
+            std::this_thread::sleep_until(sent + InputInterval);
+        }
+
+        for (size_t index = 0; index < WindowCount; ++index)
+        {
+            Core::UiThread& thread = *threads[index % threadCount];
+            thread.Invoke([&thread, window = &windows[index]] { thread.GetDispatcher().DetachWindow(window); }).get();
+        }
+        for (const auto& thread : threads)
+            thread->Stop();
+        for (const auto& thread : threads)
+            thread->Join();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double scale = ParseScale(argc, argv);
+    const size_t rounds = Scaled(200, scale);
+
+    std::printf("\n%zu windows, one input each per %lld ms, window 0 blocks its thread for %lld ms every eighth input\n", WindowCount,
+                static_cast<long long>(InputInterval.count()), static_cast<long long>(SlowHandlerTime.count()));
+    PrintLatencyHeader("Input latency of the other windows");
+    for (size_t threadCount : ThreadCounts(WindowCount))
+    {
+        if (threadCount > WindowCount)
+            break;
+
+        Samples samples;
+        Measure(threadCount, rounds, samples);
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%zu thread(s), other threads", threadCount);
+        if (!samples.OtherThreads.empty())
+            PrintLatency(name, Summarize(samples.OtherThreads));
+        std::snprintf(name, sizeof(name), "%zu thread(s), slow window's thread", threadCount);
+        if (!samples.SharingSlowThread.empty())
+            PrintLatency(name, Summarize(samples.SharingSlowThread));
+    }
+    return 0;
+}
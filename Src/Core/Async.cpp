@@ -0,0 +1,705 @@
+#include "Async.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+#include "DebugLogger.hpp"
+#include "InputTrace.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace WinCore::Core
+{
+    namespace
+    {
+        thread_local UiDispatcher* t_currentDispatcher{nullptr};
+
+        std::mutex s_windowDispatchersMutex{};
+        std::unordered_map<const void*, UiDispatcher*> s_windowDispatchers{};
+
+        constexpr size_t FrameSizeGranularity = 64;         //< Frame sizes are rounded up to this many bytes.
+        constexpr size_t FrameSizeClassCount = 16;          //< Frames up to 1 KiB are pooled.
+        constexpr size_t MaxCachedFramesPerClass = 256;     //< Free frames kept per size class and thread.
+
+        /**
+         * Per-thread free lists of coroutine frames, one per size class.
+         */
+        struct FrameCache
+        {
+            struct FreeFrame
+            {
+                FreeFrame* Next;
+            };
+
+            FreeFrame* Heads[FrameSizeClassCount]{};
+            size_t Counts[FrameSizeClassCount]{};
+
+            ~FrameCache()
+            {
+                for (FreeFrame* head : Heads)
+                {
+                    while (head)
+                        ::operator delete(std::exchange(head, head->Next));
+                }
+            }
+        };
+
+        thread_local FrameCache t_frameCache{};
+
+        /**
+         * Runs delayed work for threads without a UiDispatcher and hands it to the shared ThreadPool.
+         */
+        class TimerThread
+        {
+            public:
+                using Clock = std::chrono::steady_clock;
+
+                TimerThread()
+                {
+                    // Construct the pool first so it outlives the timer thread at shutdown.
+                    ThreadPool::Shared();
+                    thread_ = std::thread([this] { Run(); });
+                }
+
+                ~TimerThread()
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        stopping_ = true;
+                    }
+                    condition_.notify_one();
+                    thread_.join();
+                }
+
+                uint64_t PostAt(Clock::time_point deadline, std::function<void()> work)
+                {
+                    uint64_t id = 0;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        id = sequence_++;
+                        timers_.push(Detail::TimerEntry{deadline, id, std::move(work)});
+                    }
+                    condition_.notify_one();
+                    return id;
+                }
+
+                /**
+                 * Drops a timer that has not been handed to the pool yet. The thread keeps its
+                 * current wait, it finds a different earliest timer when it wakes.
+                 */
+                bool Cancel(uint64_t id)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    return timers_.Remove(id);
+                }
+
+            private:
+                void Run()
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    while (!stopping_)
+                    {
+                        if (timers_.empty())
+                        {
+                            condition_.wait(lock);
+                            continue;
+                        }
+
+                        // Copied, a PostAt during the wait may reallocate the queue's storage.
+                        const Clock::time_point deadline = timers_.top().Deadline;
+                        if (deadline > Clock::now())
+                        {
+                            condition_.wait_until(lock, deadline);
+                            continue;
+                        }
+
+                        std::function<void()> work = std::move(const_cast<Detail::TimerEntry&>(timers_.top()).Work);
+                        timers_.pop();
+                        ThreadPool::Shared().Submit(std::move(work));
+                    }
+                }
+
+                std::mutex mutex_{};
+                std::condition_variable condition_{};
+                Detail::TimerQueue timers_{};
+                uint64_t sequence_{1};
+                bool stopping_{false};
+                std::thread thread_{};
+        };
+
+        TimerThread& GetTimerThread()
+        {
+            static TimerThread timerThread{};
+            return timerThread;
+        }
+
+        /**
+         * A coroutine that starts eagerly and frees itself on completion.
+         */
+        struct DetachedTask
+        {
+            struct promise_type
+            {
+                DetachedTask get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept {}
+
+                static void* operator new(size_t size) { return CoroutineFramePool::Allocate(size); }
+                static void operator delete(void* pointer, size_t size) noexcept { CoroutineFramePool::Deallocate(pointer, size); }
+            };
+        };
+
+        DetachedTask RunDetached(Task<void> task)
+        {
+            try
+            {
+                co_await std::move(task);
+            }
+            catch (const OperationCancelled&)
+            {
+            }
+            catch (const std::exception& exception)
+            {
+                WINCORE_LOG_ERROR("Detached task failed: {}", exception.what());
+            }
+            catch (...)
+            {
+                WINCORE_LOG_ERROR("Detached task failed with an unknown exception.");
+            }
+        }
+    }
+
+    namespace Detail
+    {
+        /**
+         * Shared between a suspended Delay, its timer and its cancellation callback.
+         * Whichever of the two fires first resumes the coroutine.
+         */
+        struct DelayState
+        {
+            std::coroutine_handle<> Handle{};
+            UiDispatcherReference Dispatcher{};
+            std::mutex Mutex{};
+            std::atomic<bool> Claimed{false};
+            bool Cancelled{false};
+            uint64_t CancellationId{0};
+            uint64_t TimerId{0};        //< Set before the cancellation callback is registered.
+        };
+    }
+
+    bool CancellationToken::IsCancellationRequested() const noexcept
+    {
+        if (!state_)
+            return false;
+
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        return state_->Cancelled;
+    }
+
+    uint64_t CancellationToken::Register(std::function<void()> callback) const
+    {
+        if (!state_)
+            return 0;
+
+        {
+            std::lock_guard<std::mutex> lock(state_->Mutex);
+            if (!state_->Cancelled)
+            {
+                const uint64_t id = state_->NextCallbackId++;
+                state_->Callbacks.emplace_back(id, std::move(callback));
+                return id;
+            }
+        }
+
+        callback();
+        return 0;
+    }
+
+    void CancellationToken::Unregister(uint64_t id) const noexcept
+    {
+        if (!state_ || id == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        std::erase_if(state_->Callbacks, [id](const auto& entry) { return entry.first == id; });
+    }
+
+    void CancellationSource::Cancel()
+    {
+        std::vector<std::pair<uint64_t, std::function<void()>>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(state_->Mutex);
+            if (state_->Cancelled)
+                return;
+
+            state_->Cancelled = true;
+            callbacks.swap(state_->Callbacks);
+        }
+
+        for (auto& [id, callback] : callbacks)
+            callback();
+    }
+
+    void* CoroutineFramePool::Allocate(size_t size)
+    {
+        const size_t sizeClass = (size + FrameSizeGranularity - 1) / FrameSizeGranularity - 1;
+        if (sizeClass >= FrameSizeClassCount)
+            return ::operator new(size);
+
+        FrameCache& cache = t_frameCache;
+        if (FrameCache::FreeFrame* frame = cache.Heads[sizeClass])
+        {
+            cache.Heads[sizeClass] = frame->Next;
+            --cache.Counts[sizeClass];
+            return frame;
+        }
+
+        return ::operator new((sizeClass + 1) * FrameSizeGranularity);
+    }
+
+    void CoroutineFramePool::Deallocate(void* pointer, size_t size) noexcept
+    {
+        const size_t sizeClass = (size + FrameSizeGranularity - 1) / FrameSizeGranularity - 1;
+        FrameCache& cache = t_frameCache;
+        if (sizeClass >= FrameSizeClassCount || cache.Counts[sizeClass] >= MaxCachedFramesPerClass)
+        {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto* frame = static_cast<FrameCache::FreeFrame*>(pointer);
+        frame->Next = cache.Heads[sizeClass];
+        cache.Heads[sizeClass] = frame;
+        ++cache.Counts[sizeClass];
+    }
+
+    UiDispatcher::UiDispatcher()
+    {
+        if (t_currentDispatcher)
+            throw std::runtime_error("The calling thread already owns a UiDispatcher.");
+
+        threadId_ = std::this_thread::get_id();
+        link_ = std::make_shared<Detail::DispatcherLink>();
+        link_->Dispatcher = this;
+        t_currentDispatcher = this;
+#ifdef _WIN32
+        wakeEvent_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        if (!wakeEvent_)
+            throw std::runtime_error("Failed to create the dispatcher wake event.");
+#endif
+    }
+
+    UiDispatcher::~UiDispatcher()
+    {
+        // Waits for posts through references that are in progress.
+        {
+            std::lock_guard<std::mutex> lock(link_->Mutex);
+            link_->Dispatcher = nullptr;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_windowDispatchersMutex);
+            std::erase_if(s_windowDispatchers, [this](const auto& entry) { return entry.second == this; });
+        }
+
+        if (t_currentDispatcher == this)
+            t_currentDispatcher = nullptr;
+#ifdef _WIN32
+        CloseHandle(static_cast<HANDLE>(wakeEvent_));
+#endif
+    }
+
+    UiDispatcher* UiDispatcher::Current() noexcept
+    {
+        return t_currentDispatcher;
+    }
+
+    UiDispatcher* UiDispatcher::FromWindow(const void* window) noexcept
+    {
+        std::lock_guard<std::mutex> lock(s_windowDispatchersMutex);
+        auto it = s_windowDispatchers.find(window);
+        return it != s_windowDispatchers.end() ? it->second : nullptr;
+    }
+
+    UiDispatcherReference UiDispatcher::ReferenceFromWindow(const void* window)
+    {
+        std::lock_guard<std::mutex> lock(s_windowDispatchersMutex);
+        auto it = s_windowDispatchers.find(window);
+        return it != s_windowDispatchers.end() ? it->second->GetReference() : UiDispatcherReference{};
+    }
+
+    bool UiDispatcher::PostToWindow(const void* window, std::function<void()> work)
+    {
+        // The destructor detaches its windows under the same lock, so the dispatcher stays alive while posting.
+        std::lock_guard<std::mutex> lock(s_windowDispatchersMutex);
+        auto it = s_windowDispatchers.find(window);
+        if (it == s_windowDispatchers.end())
+            return false;
+
+        it->second->Post(std::move(work));
+        return true;
+    }
+
+    void UiDispatcher::AttachWindow(const void* window)
+    {
+        std::lock_guard<std::mutex> lock(s_windowDispatchersMutex);
+        s_windowDispatchers[window] = this;
+    }
+
+    void UiDispatcher::DetachWindow(const void* window)
+    {
+        std::lock_guard<std::mutex> lock(s_windowDispatchersMutex);
+        auto it = s_windowDispatchers.find(window);
+        if (it != s_windowDispatchers.end() && it->second == this)
+            s_windowDispatchers.erase(it);
+    }
+
+    UiDispatcherReference UiDispatcher::GetReference() const noexcept
+    {
+        return UiDispatcherReference(link_, threadId_);
+    }
+
+    void UiDispatcher::Post(std::function<void()> work)
+    {
+        std::shared_ptr<const std::function<void()>> callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(std::move(work));
+            callback = wakeCallback_;
+        }
+        Wake(callback.get());
+    }
+
+    void UiDispatcher::Post(std::coroutine_handle<> handle)
+    {
+        Post([handle] { handle.resume(); });
+    }
+
+    uint64_t UiDispatcher::PostAt(Clock::time_point deadline, std::function<void()> work)
+    {
+        uint64_t id = 0;
+        std::shared_ptr<const std::function<void()>> callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            id = timerSequence_++;
+            timers_.push(Detail::TimerEntry{deadline, id, std::move(work)});
+            callback = wakeCallback_;
+        }
+        Wake(callback.get());
+        return id;
+    }
+
+    bool UiDispatcher::CancelTimer(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timers_.Remove(id);
+    }
+
+    void UiDispatcher::Wake(const std::function<void()>* callback)
+    {
+        condition_.notify_one();
+#ifdef _WIN32
+        SetEvent(static_cast<HANDLE>(wakeEvent_));
+#endif
+
+        if (callback && *callback)
+            (*callback)();
+    }
+
+    size_t UiDispatcher::RunPending()
+    {
+        // The batch is local, so a nested call or an exception cannot run an item twice.
+        std::vector<std::function<void()>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.swap(pending_);
+            pending_.swap(spare_);
+
+            const Clock::time_point now = Clock::now();
+            while (!timers_.empty() && timers_.top().Deadline <= now)
+            {
+                batch.push_back(std::move(const_cast<Detail::TimerEntry&>(timers_.top()).Work));
+                timers_.pop();
+            }
+        }
+
+        // Work posted while running is picked up by the next call, so a task that
+        // keeps re-posting itself cannot starve the message loop.
+        size_t next = 0;
+        try
+        {
+            while (next < batch.size())
+            {
+                std::function<void()> work = std::move(batch[next++]);
+                work();
+            }
+        }
+        catch (...)
+        {
+            // The items after the failed one have not run yet, they go back to the front of the queue.
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.insert(pending_.begin(), std::make_move_iterator(batch.begin() + static_cast<std::ptrdiff_t>(next)),
+                            std::make_move_iterator(batch.end()));
+            throw;
+        }
+
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (batch.capacity() > spare_.capacity())
+                spare_.swap(batch);
+        }
+        return next;
+    }
+
+    size_t UiDispatcher::WaitAndRunPending(std::chrono::milliseconds timeout)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            Clock::time_point deadline = Clock::now() + timeout;
+            if (!timers_.empty())
+                deadline = std::min(deadline, timers_.top().Deadline);
+
+            condition_.wait_until(lock, deadline, [this] {
+                return !pending_.empty() || (!timers_.empty() && timers_.top().Deadline <= Clock::now());
+            });
+        }
+
+        return RunPending();
+    }
+
+    std::optional<UiDispatcher::Clock::time_point> UiDispatcher::GetNextDeadline() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pending_.empty())
+            return Clock::now();
+        if (timers_.empty())
+            return std::nullopt;
+        return timers_.top().Deadline;
+    }
+
+    void UiDispatcher::SetWakeCallback(std::function<void()> callback)
+    {
+        auto shared = callback ? std::make_shared<const std::function<void()>>(std::move(callback)) : nullptr;
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeCallback_ = std::move(shared);
+    }
+
+    void UiDispatcher::RecordMessage(const void* window, uint32_t message, uint64_t wParam, int64_t lParam) noexcept
+    {
+        if (!traceRecorder_)
+            return;
+
+        try
+        {
+            traceRecorder_->Record(window, message, wParam, lParam);
+        }
+        catch (const std::exception& e)
+        {
+            // The trace ends at the failed write, there is nothing left worth recording.
+            WINCORE_LOG_ERROR("Input trace recording stopped: {}", e.what());
+            traceRecorder_ = nullptr;
+        }
+    }
+
+#ifdef _WIN32
+    int UiDispatcher::RunMessageLoop()
+    {
+        MSG message{};
+        while (true)
+        {
+            while (PeekMessageW(&message, nullptr, 0, 0, PM_REMOVE))
+            {
+                if (message.message == WM_QUIT)
+                    return static_cast<int>(message.wParam);
+
+                RecordMessage(message.hwnd, message.message, static_cast<uint64_t>(message.wParam),
+                              static_cast<int64_t>(message.lParam));
+                TranslateMessage(&message);
+                DispatchMessageW(&message);
+            }
+
+            RunPending();
+
+            DWORD timeout = INFINITE;
+            if (std::optional<Clock::time_point> deadline = GetNextDeadline())
+            {
+                const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - Clock::now());
+                timeout = static_cast<DWORD>(std::max<int64_t>(0, remaining.count()));
+            }
+
+            HANDLE wakeEvent = static_cast<HANDLE>(wakeEvent_);
+            MsgWaitForMultipleObjectsEx(1, &wakeEvent, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        }
+    }
+#endif
+
+    bool UiDispatcherReference::Post(std::function<void()> work) const
+    {
+        if (!link_)
+            return false;
+
+        std::lock_guard<std::mutex> lock(link_->Mutex);
+        if (!link_->Dispatcher)
+            return false;
+
+        link_->Dispatcher->Post(std::move(work));
+        return true;
+    }
+
+    bool UiDispatcherReference::Post(std::coroutine_handle<> handle) const
+    {
+        return Post([handle] { handle.resume(); });
+    }
+
+    uint64_t UiDispatcherReference::PostAt(UiDispatcher::Clock::time_point deadline, std::function<void()> work) const
+    {
+        if (!link_)
+            return 0;
+
+        std::lock_guard<std::mutex> lock(link_->Mutex);
+        if (!link_->Dispatcher)
+            return 0;
+
+        return link_->Dispatcher->PostAt(deadline, std::move(work));
+    }
+
+    bool UiDispatcherReference::CancelTimer(uint64_t id) const
+    {
+        if (!link_)
+            return false;
+
+        std::lock_guard<std::mutex> lock(link_->Mutex);
+        return link_->Dispatcher && link_->Dispatcher->CancelTimer(id);
+    }
+
+    ResumeOnUiThread::ResumeOnUiThread(const void* window) : dispatcher_(UiDispatcher::ReferenceFromWindow(window))
+    {
+        if (!dispatcher_)
+            throw std::runtime_error("The window is not attached to a UiDispatcher.");
+    }
+
+    void ResumeOnPool::await_suspend(std::coroutine_handle<> handle) const
+    {
+        ThreadPool::Shared().Submit([handle] { handle.resume(); }, priority_);
+    }
+
+    void Delay::await_suspend(std::coroutine_handle<> handle)
+    {
+        auto state = std::make_shared<Detail::DelayState>();
+        state->Handle = handle;
+        if (UiDispatcher* current = UiDispatcher::Current())
+            state->Dispatcher = current->GetReference();
+        state_ = state;
+
+        const CancellationToken token = token_;
+        const auto deadline = std::chrono::steady_clock::now() + duration_;
+        auto resumeIfFirst = [state](bool cancelled) {
+            if (state->Claimed.exchange(true, std::memory_order_acq_rel))
+                return;
+
+            state->Cancelled = cancelled;
+            if (cancelled)
+            {
+                // Drops the timer now instead of at its deadline, it may be far away.
+                if (state->Dispatcher)
+                    state->Dispatcher.CancelTimer(state->TimerId);
+                else
+                    GetTimerThread().Cancel(state->TimerId);
+            }
+
+            if (state->Dispatcher)
+            {
+                // The coroutine belongs to that UI thread, it cannot continue anywhere else.
+                if (!state->Dispatcher.Post(state->Handle))
+                    WINCORE_LOG_WARNING("A Delay could not resume, its UI thread has ended.");
+            }
+            else
+                ThreadPool::Shared().Submit([handle = state->Handle] { handle.resume(); });
+        };
+
+        // Once the timer is queued the coroutine may resume on another thread, so only
+        // locals are used from here on. await_resume waits on the mutex for the id.
+        std::lock_guard<std::mutex> lock(state->Mutex);
+        if (state->Dispatcher)
+            state->TimerId = state->Dispatcher.PostAt(deadline, [resumeIfFirst] { resumeIfFirst(false); });
+        else
+            state->TimerId = GetTimerThread().PostAt(deadline, [resumeIfFirst] { resumeIfFirst(false); });
+
+        state->CancellationId = token.Register([resumeIfFirst] { resumeIfFirst(true); });
+    }
+
+    void Delay::await_resume()
+    {
+        if (!state_)
+        {
+            token_.ThrowIfCancellationRequested();
+            return;
+        }
+
+        uint64_t cancellationId = 0;
+        {
+            std::lock_guard<std::mutex> lock(state_->Mutex);
+            cancellationId = state_->CancellationId;
+        }
+
+        token_.Unregister(cancellationId);
+        if (state_->Cancelled)
+            throw OperationCancelled();
+    }
+
+    void StartDetached(Task<void> task)
+    {
+        RunDetached(std::move(task));
+    }
+
+    Task<std::vector<uint8_t>> LoadFileAsync(std::string path, CancellationToken token)
+    {
+        UiDispatcher* current = UiDispatcher::Current();
+        const UiDispatcherReference origin = current ? current->GetReference() : UiDispatcherReference{};
+        token.ThrowIfCancellationRequested();
+
+        co_await ResumeOnPool();
+
+        std::vector<uint8_t> contents;
+        std::exception_ptr failure;
+        try
+        {
+            std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+            if (!file)
+                throw std::runtime_error("Failed to open file: " + path);
+
+            constexpr size_t ChunkSize = 64 * 1024;
+            size_t read = 0;
+            do
+            {
+                token.ThrowIfCancellationRequested();
+                const size_t offset = contents.size();
+                contents.resize(offset + ChunkSize);
+                read = std::fread(contents.data() + offset, 1, ChunkSize, file.get());
+                contents.resize(offset + read);
+            } while (read == ChunkSize);
+
+            if (std::ferror(file.get()))
+                throw std::runtime_error("Failed to read file: " + path);
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+
+        if (origin)
+            co_await ResumeOnUiThread(origin);
+
+        if (failure)
+            std::rethrow_exception(failure);
+
+        token.ThrowIfCancellationRequested();
+        co_return contents;
+    }
+}
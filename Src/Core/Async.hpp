@@ -0,0 +1,718 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace WinCore::Core
+{
+    /**
+     * @class OperationCancelled
+     * @brief Thrown by awaitables when the CancellationToken of the operation was cancelled.
+     */
+    class OperationCancelled : public std::runtime_error
+    {
+        public:
+            OperationCancelled() : std::runtime_error("The operation was cancelled.") {}
+    };
+
+    namespace Detail
+    {
+        struct CancellationState
+        {
+            std::mutex Mutex{};
+            bool Cancelled{false};
+            uint64_t NextCallbackId{1};
+            std::vector<std::pair<uint64_t, std::function<void()>>> Callbacks{};
+        };
+    }
+
+    /**
+     * @class CancellationToken
+     * @brief Observes cancellation requested through a CancellationSource.
+     *
+     * A default constructed token can never be cancelled. Tokens are cheap to copy.
+     */
+    class CancellationToken
+    {
+        public:
+            CancellationToken() = default;
+            explicit CancellationToken(std::shared_ptr<Detail::CancellationState> state) : state_(std::move(state)) {}
+
+            /**
+             * Checks whether cancellation has been requested.
+             * @return True if the owning source has been cancelled.
+             */
+            [[nodiscard]] bool IsCancellationRequested() const noexcept;
+
+            /**
+             * Throws OperationCancelled if cancellation has been requested.
+             * @throws OperationCancelled If the owning source has been cancelled.
+             */
+            void ThrowIfCancellationRequested() const
+            {
+                if (IsCancellationRequested())
+                    throw OperationCancelled();
+            }
+
+            /**
+             * Registers a callback invoked once when cancellation is requested.
+             * The callback runs immediately if the token is already cancelled.
+             * @param callback The callback to invoke, on the thread calling CancellationSource::Cancel.
+             * @return An id for Unregister, 0 if the token can never be cancelled or the callback already ran.
+             */
+            uint64_t Register(std::function<void()> callback) const;
+
+            /**
+             * Removes a callback added with Register.
+             * @param id The id returned by Register.
+             */
+            void Unregister(uint64_t id) const noexcept;
+
+        private:
+            std::shared_ptr<Detail::CancellationState> state_{};    //< The state shared with the source.
+    };
+
+    /**
+     * @class CancellationSource
+     * @brief Requests cooperative cancellation of the operations holding its tokens.
+     */
+    class CancellationSource
+    {
+        public:
+            CancellationSource() : state_(std::make_shared<Detail::CancellationState>()) {}
+
+            /**
+             * Returns a token observing this source.
+             * @return A token that reports cancellation once Cancel is called.
+             */
+            [[nodiscard]] CancellationToken GetToken() const { return CancellationToken(state_); }
+
+            /**
+             * Requests cancellation and runs the registered callbacks on the calling thread.
+             */
+            void Cancel();
+
+            /**
+             * Checks whether Cancel has been called.
+             * @return True if cancellation has been requested.
+             */
+            [[nodiscard]] bool IsCancellationRequested() const noexcept { return GetToken().IsCancellationRequested(); }
+
+        private:
+            std::shared_ptr<Detail::CancellationState> state_;     //< The state shared with the tokens.
+    };
+
+    /**
+     * @class CoroutineFramePool
+     * @brief Size-class allocator for coroutine frames.
+     *
+     * Frames are recycled through per-thread free lists, so suspending and resuming
+     * thousands of short tasks does not hit the global heap.
+     */
+    class CoroutineFramePool
+    {
+        private:
+            CoroutineFramePool() = default;
+            ~CoroutineFramePool() = default;
+
+            CoroutineFramePool(const CoroutineFramePool&) = delete;
+            CoroutineFramePool& operator=(const CoroutineFramePool&) = delete;
+            CoroutineFramePool(CoroutineFramePool&&) = delete;
+            CoroutineFramePool& operator=(CoroutineFramePool&&) = delete;
+
+        public:
+            /**
+             * Allocates a coroutine frame.
+             * @param size The size of the frame in bytes.
+             * @return The allocated memory.
+             * @throws std::bad_alloc If the allocation fails.
+             */
+            static void* Allocate(size_t size);
+
+            /**
+             * Returns a coroutine frame to the pool.
+             * @param pointer The memory returned by Allocate.
+             * @param size The size passed to Allocate.
+             */
+            static void Deallocate(void* pointer, size_t size) noexcept;
+    };
+
+    template<typename T = void>
+    class Task;
+
+    namespace Detail
+    {
+        class TaskPromiseBase
+        {
+            public:
+                struct FinalAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+
+                    template<typename Promise>
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                    {
+                        std::coroutine_handle<> continuation = handle.promise().continuation_;
+                        return continuation ? continuation : std::noop_coroutine();
+                    }
+
+                    void await_resume() const noexcept {}
+                };
+
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+                FinalAwaiter final_suspend() const noexcept { return {}; }
+                void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+                void SetContinuation(std::coroutine_handle<> continuation) noexcept { continuation_ = continuation; }
+
+                static void* operator new(size_t size) { return CoroutineFramePool::Allocate(size); }
+                static void operator delete(void* pointer, size_t size) noexcept { CoroutineFramePool::Deallocate(pointer, size); }
+
+            protected:
+                void RethrowIfFailed() const
+                {
+                    if (exception_)
+                        std::rethrow_exception(exception_);
+                }
+
+            private:
+                std::coroutine_handle<> continuation_{};    //< The coroutine awaiting this task.
+                std::exception_ptr exception_{};            //< The exception that escaped the task body.
+        };
+
+        template<typename T>
+        class TaskPromise : public TaskPromiseBase
+        {
+            public:
+                Task<T> get_return_object() noexcept;
+
+                template<typename U>
+                void return_value(U&& value) { value_.emplace(std::forward<U>(value)); }
+
+                T TakeResult()
+                {
+                    RethrowIfFailed();
+                    return std::move(*value_);
+                }
+
+            private:
+                std::optional<T> value_{};      //< The value produced by co_return.
+        };
+
+        template<>
+        class TaskPromise<void> : public TaskPromiseBase
+        {
+            public:
+                Task<void> get_return_object() noexcept;
+
+                void return_void() const noexcept {}
+                void TakeResult() const { RethrowIfFailed(); }
+        };
+    }
+
+    /**
+     * @class Task
+     * @brief A lazily started coroutine producing a value of type T.
+     *
+     * The body starts running when the task is awaited and the awaiting coroutine
+     * resumes on whichever thread the task completes on. Use StartDetached to run a
+     * top-level Task<void> without awaiting it.
+     */
+    template<typename T>
+    class [[nodiscard]] Task
+    {
+        public:
+            using promise_type = Detail::TaskPromise<T>;
+
+            Task() noexcept = default;
+            explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+            ~Task()
+            {
+                if (handle_)
+                    handle_.destroy();
+            }
+
+            Task(const Task&) = delete;
+            Task& operator=(const Task&) = delete;
+
+            Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+            Task& operator=(Task&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (handle_)
+                        handle_.destroy();
+                    handle_ = std::exchange(other.handle_, nullptr);
+                }
+                return *this;
+            }
+
+            /**
+             * Checks whether the task has run to completion.
+             * @return True if the body has finished, false if it has not started or is suspended.
+             */
+            [[nodiscard]] bool IsDone() const noexcept { return !handle_ || handle_.done(); }
+
+            auto operator co_await() && noexcept
+            {
+                struct Awaiter
+                {
+                    std::coroutine_handle<promise_type> Handle;
+
+                    bool await_ready() const noexcept { return !Handle || Handle.done(); }
+
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+                    {
+                        Handle.promise().SetContinuation(continuation);
+                        return Handle;
+                    }
+
+                    T await_resume() { return Handle.promise().TakeResult(); }
+                };
+
+                return Awaiter{handle_};
+            }
+
+        private:
+            std::coroutine_handle<promise_type> handle_{};      //< The owned coroutine frame.
+    };
+
+    namespace Detail
+    {
+        template<typename T>
+        Task<T> TaskPromise<T>::get_return_object() noexcept
+        {
+            return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() noexcept
+        {
+            return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+        }
+    }
+
+    class UiDispatcherReference;
+    class InputTraceRecorder;
+
+    namespace Detail
+    {
+        /**
+         * Shared by a dispatcher and its references, cleared when the dispatcher is destroyed.
+         */
+        struct DispatcherLink
+        {
+            std::mutex Mutex{};
+            UiDispatcher* Dispatcher{nullptr};
+        };
+
+        struct TimerEntry
+        {
+            std::chrono::steady_clock::time_point Deadline{};
+            uint64_t Sequence{0};
+            std::function<void()> Work{};
+
+            bool operator>(const TimerEntry& other) const noexcept
+            {
+                return Deadline != other.Deadline ? Deadline > other.Deadline : Sequence > other.Sequence;
+            }
+        };
+
+        /**
+         * A min-heap of timers that can also drop a timer before it is due, e.g. a cancelled Delay.
+         */
+        class TimerQueue : public std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>>
+        {
+            public:
+                /**
+                 * Removes a queued timer.
+                 * @param sequence The sequence number of the timer.
+                 * @return False if no queued timer has that number.
+                 */
+                bool Remove(uint64_t sequence)
+                {
+                    const auto iterator = std::find_if(c.begin(), c.end(), [sequence](const TimerEntry& entry) { return entry.Sequence == sequence; });
+                    if (iterator == c.end())
+                        return false;
+
+                    c.erase(iterator);
+                    std::make_heap(c.begin(), c.end(), comp);
+                    return true;
+                }
+        };
+    }
+
+    /**
+     * @class UiDispatcher
+     * @brief The executor of a UI thread, driven by that thread's message loop.
+     *
+     * Work and coroutine continuations can be posted from any thread. They run on the
+     * owning thread whenever the message loop calls RunPending, or inside RunMessageLoop.
+     * A UiDispatcher must be created on the thread it belongs to.
+     */
+    class UiDispatcher
+    {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * Creates the dispatcher of the calling thread.
+             * @throws std::runtime_error If the calling thread already owns a dispatcher.
+             */
+            UiDispatcher();
+
+            /**
+             * Destroys the dispatcher. Pending work that has not run is discarded.
+             */
+            ~UiDispatcher();
+
+            UiDispatcher(const UiDispatcher&) = delete;
+            UiDispatcher& operator=(const UiDispatcher&) = delete;
+            UiDispatcher(UiDispatcher&&) = delete;
+            UiDispatcher& operator=(UiDispatcher&&) = delete;
+
+            /**
+             * Returns the dispatcher owned by the calling thread.
+             * @return The dispatcher, or nullptr if the calling thread is not a UI thread.
+             */
+            [[nodiscard]] static UiDispatcher* Current() noexcept;
+
+            /**
+             * Returns the dispatcher a window has been attached to.
+             * @param window An opaque key of the window (e.g. its HWND).
+             * @return The dispatcher, or nullptr if the window is not attached.
+             */
+            [[nodiscard]] static UiDispatcher* FromWindow(const void* window) noexcept;
+
+            /**
+             * Returns a reference to the dispatcher a window is attached to.
+             * @param window An opaque key of the window (e.g. its HWND).
+             * @return The reference, empty if the window is not attached.
+             */
+            [[nodiscard]] static UiDispatcherReference ReferenceFromWindow(const void* window);
+
+            /**
+             * Queues work on the dispatcher a window is attached to. Unlike FromWindow(window)->Post(),
+             * this is safe against the dispatcher being destroyed concurrently.
+             * @param window An opaque key of the window (e.g. its HWND).
+             * @param work The work to run.
+             * @return False if the window is not attached, the work is dropped then.
+             */
+            static bool PostToWindow(const void* window, std::function<void()> work);
+
+            /**
+             * Associates a window with this dispatcher so ResumeOnUiThread(window) can find it.
+             * @param window An opaque key of the window (e.g. its HWND).
+             */
+            void AttachWindow(const void* window);
+
+            /**
+             * Removes a window added with AttachWindow.
+             * @param window An opaque key of the window.
+             */
+            void DetachWindow(const void* window);
+
+            /**
+             * Checks whether the calling thread owns this dispatcher.
+             * @return True when called on the dispatcher's UI thread.
+             */
+            [[nodiscard]] bool IsCurrentThread() const noexcept { return std::this_thread::get_id() == threadId_; }
+
+            /**
+             * Returns a reference for work that may outlive the dispatcher, e.g. jobs on the pool.
+             */
+            [[nodiscard]] UiDispatcherReference GetReference() const noexcept;
+
+            /**
+             * Queues work to run on the UI thread.
+             * @param work The work to run.
+             */
+            void Post(std::function<void()> work);
+
+            /**
+             * Queues a coroutine to be resumed on the UI thread.
+             * @param handle The suspended coroutine.
+             */
+            void Post(std::coroutine_handle<> handle);
+
+            /**
+             * Queues work to run on the UI thread once the deadline has passed.
+             * @param deadline The earliest time the work may run.
+             * @param work The work to run.
+             * @return The id of the timer for CancelTimer, never 0.
+             */
+            uint64_t PostAt(Clock::time_point deadline, std::function<void()> work);
+
+            /**
+             * Drops a timer queued with PostAt before it runs, releasing its work right away.
+             * @param id The id returned by PostAt.
+             * @return False if the timer has already run or was cancelled before.
+             */
+            bool CancelTimer(uint64_t id);
+
+            /**
+             * Runs all queued work and every timer that is due. Must be called on the UI thread.
+             * @return The number of work items that ran.
+             * @throws Rethrows the exception of a work item. The items queued after it stay queued.
+             */
+            size_t RunPending();
+
+            /**
+             * Waits until work is posted, a timer is due or the timeout elapses, then runs pending work.
+             * Used by headless loops that do not pump window messages.
+             * @param timeout The maximum time to wait.
+             * @return The number of work items that ran.
+             */
+            size_t WaitAndRunPending(std::chrono::milliseconds timeout);
+
+            /**
+             * Returns the deadline of the earliest timer.
+             * @return The deadline, or std::nullopt if no timer is pending.
+             */
+            [[nodiscard]] std::optional<Clock::time_point> GetNextDeadline() const;
+
+            /**
+             * Installs a callback invoked from Post when the UI thread needs to wake up.
+             * Used by custom message loops, RunMessageLoop does not need it.
+             * @param callback The callback, invoked on the posting thread.
+             */
+            void SetWakeCallback(std::function<void()> callback);
+
+            /**
+             * Records the window messages pumped by RunMessageLoop into an input trace. Must be called
+             * on the UI thread, FrameScheduler::SetInputTraceRecorder adds the frame boundaries.
+             * @param recorder The recorder, it must outlive the recording. nullptr stops recording.
+             */
+            void SetInputTraceRecorder(InputTraceRecorder* recorder) noexcept { traceRecorder_ = recorder; }
+
+            /**
+             * Passes a message to the input trace recorder, if one is set. RunMessageLoop calls it for
+             * every message it dispatches, custom message loops call it before DispatchMessage.
+             * A recorder that fails to write is logged and detached, the pump keeps running.
+             * @param window An opaque key of the target window (e.g. its HWND).
+             * @param message The message identifier (WM_*).
+             * @param wParam The message WPARAM.
+             * @param lParam The message LPARAM.
+             */
+            void RecordMessage(const void* window, uint32_t message, uint64_t wParam, int64_t lParam) noexcept;
+
+#ifdef _WIN32
+            /**
+             * Pumps window messages and dispatcher work until WM_QUIT is received.
+             * @return The exit code passed to PostQuitMessage.
+             */
+            int RunMessageLoop();
+#endif
+
+        private:
+            void Wake(const std::function<void()>* callback);
+
+            std::thread::id threadId_;                                      //< The owning UI thread.
+            mutable std::mutex mutex_{};                                    //< Guards the queues below.
+            std::condition_variable condition_{};                          //< Signalled when work is posted.
+            std::vector<std::function<void()>> pending_{};                  //< Work ready to run.
+            std::vector<std::function<void()>> spare_{};                   //< Storage of an earlier batch, reused for pending_.
+            Detail::TimerQueue timers_{};                                   //< Delayed work.
+            uint64_t timerSequence_{1};                                     //< Keeps timers with equal deadlines in FIFO order, doubles as their id.
+            std::shared_ptr<const std::function<void()>> wakeCallback_{};   //< Custom loop wake-up hook, shared so Post does not copy it.
+            InputTraceRecorder* traceRecorder_{nullptr};                    //< Receives pumped messages, UI thread only.
+            void* wakeEvent_{nullptr};                                      //< The auto-reset event RunMessageLoop waits on.
+            std::shared_ptr<Detail::DispatcherLink> link_;                  //< Lets references outlive the dispatcher.
+    };
+
+    /**
+     * @class UiDispatcherReference
+     * @brief A copyable handle that posts to a UiDispatcher only while it is alive.
+     *
+     * Store it instead of a UiDispatcher pointer in work that may outlive the dispatcher,
+     * such as pool jobs, timers and cancellation callbacks. Posts after the dispatcher was
+     * destroyed are dropped. A post holds a lock that the dispatcher's destructor waits on,
+     * so the wake callback of a dispatcher must not post through a reference to itself.
+     */
+    class UiDispatcherReference
+    {
+        public:
+            /**
+             * Creates an empty reference that drops every post.
+             */
+            UiDispatcherReference() = default;
+
+            /**
+             * Queues work on the dispatcher.
+             * @param work The work to run.
+             * @return False if the reference is empty or the dispatcher was destroyed, the work is dropped then.
+             */
+            bool Post(std::function<void()> work) const;
+
+            /**
+             * Queues a coroutine to be resumed on the dispatcher.
+             * @param handle The suspended coroutine.
+             * @return False if the reference is empty or the dispatcher was destroyed, the coroutine is not resumed then.
+             */
+            bool Post(std::coroutine_handle<> handle) const;
+
+            /**
+             * Queues work to run on the dispatcher once the deadline has passed.
+             * @param deadline The earliest time the work may run.
+             * @param work The work to run.
+             * @return The id of the timer, or 0 if the reference is empty or the dispatcher was destroyed, the work is dropped then.
+             */
+            uint64_t PostAt(UiDispatcher::Clock::time_point deadline, std::function<void()> work) const;
+
+            /**
+             * Drops a timer queued with PostAt before it runs.
+             * @param id The id returned by PostAt.
+             * @return False if the timer has already run, or the reference is empty or the dispatcher was destroyed.
+             */
+            bool CancelTimer(uint64_t id) const;
+
+            /**
+             * Checks whether the calling thread owns the dispatcher.
+             */
+            [[nodiscard]] bool IsCurrentThread() const noexcept { return link_ && std::this_thread::get_id() == threadId_; }
+
+            /**
+             * Checks whether the reference is empty.
+             */
+            [[nodiscard]] explicit operator bool() const noexcept { return link_ != nullptr; }
+
+        private:
+            friend class UiDispatcher;
+
+            UiDispatcherReference(std::shared_ptr<Detail::DispatcherLink> link, std::thread::id threadId) noexcept
+                : link_(std::move(link)), threadId_(threadId) {}
+
+            std::shared_ptr<Detail::DispatcherLink> link_{};    //< Cleared by the dispatcher's destructor.
+            std::thread::id threadId_{};                        //< The thread of the dispatcher.
+    };
+
+    /**
+     * @class ResumeOnUiThread
+     * @brief Awaitable that continues the coroutine on a UI thread.
+     *
+     * Completes synchronously when the coroutine already runs on that thread.
+     */
+    class ResumeOnUiThread
+    {
+        public:
+            /**
+             * @param dispatcher The dispatcher of the target UI thread.
+             */
+            explicit ResumeOnUiThread(UiDispatcher& dispatcher) noexcept : dispatcher_(dispatcher.GetReference()) {}
+
+            /**
+             * @param dispatcher A reference to the dispatcher of the target UI thread.
+             */
+            explicit ResumeOnUiThread(UiDispatcherReference dispatcher) noexcept : dispatcher_(std::move(dispatcher)) {}
+
+            /**
+             * @param window A window attached to the target UI thread with UiDispatcher::AttachWindow.
+             * @throws std::runtime_error If the window is not attached to a dispatcher.
+             */
+            explicit ResumeOnUiThread(const void* window);
+
+            bool await_ready() const noexcept { return dispatcher_.IsCurrentThread(); }
+
+            /**
+             * @throws std::runtime_error In the coroutine, if the dispatcher was destroyed in the meantime.
+             */
+            void await_suspend(std::coroutine_handle<> handle) const
+            {
+                if (!dispatcher_.Post(handle))
+                    throw std::runtime_error("The UI thread to resume on has ended.");
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            UiDispatcherReference dispatcher_;      //< The dispatcher of the target thread.
+    };
+
+    /**
+     * @class ResumeOnPool
+     * @brief Awaitable that continues the coroutine on a worker of the shared ThreadPool.
+     */
+    class ResumeOnPool
+    {
+        public:
+            /**
+             * @param priority The lane the continuation is queued in.
+             */
+            explicit ResumeOnPool(TaskPriority priority = TaskPriority::Normal) noexcept : priority_(priority) {}
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) const;
+            void await_resume() const noexcept {}
+
+        private:
+            TaskPriority priority_;     //< The lane the continuation is queued in.
+    };
+
+    namespace Detail
+    {
+        struct DelayState;
+    }
+
+    /**
+     * @class Delay
+     * @brief Awaitable that suspends the coroutine for a duration.
+     *
+     * On a UI thread the coroutine resumes on the same thread, elsewhere it resumes on
+     * the shared ThreadPool. Cancelling the token resumes it early with OperationCancelled.
+     */
+    class Delay
+    {
+        public:
+            /**
+             * @param duration The time to wait.
+             * @param token The token that cancels the wait.
+             */
+            explicit Delay(std::chrono::milliseconds duration, CancellationToken token = CancellationToken{})
+                : duration_(duration), token_(std::move(token)) {}
+
+            bool await_ready() const noexcept { return duration_.count() <= 0 && !token_.IsCancellationRequested(); }
+            void await_suspend(std::coroutine_handle<> handle);
+            void await_resume();
+
+        private:
+            std::chrono::milliseconds duration_;            //< The time to wait.
+            CancellationToken token_;                       //< The token that cancels the wait.
+            std::shared_ptr<Detail::DelayState> state_{};  //< The state shared with the timer and the cancellation callback.
+    };
+
+    /**
+     * Starts a task without awaiting it. The task frame is released when it completes.
+     * Exceptions escaping the task are reported through the DebugLogger.
+     * @param task The task to start. It runs synchronously until its first suspension.
+     */
+    void StartDetached(Task<void> task);
+
+    /**
+     * Reads a whole file on the shared ThreadPool.
+     * The awaiting coroutine resumes on its UI thread if it was started on one.
+     * @param path The path of the file to read.
+     * @param token The token that cancels the load.
+     * @return The contents of the file.
+     * @throws std::runtime_error If the file cannot be read.
+     * @throws OperationCancelled If the token is cancelled before the load completes.
+     */
+    Task<std::vector<uint8_t>> LoadFileAsync(std::string path, CancellationToken token = CancellationToken{});
+}
@@ -0,0 +1,362 @@
+#include "FrameScheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "DebugLogger.hpp"
+#include "InputTrace.hpp"
+#include "Memory.hpp"
+
+#ifdef _WIN32
+#include "Platform.hpp"
+#endif
+
+namespace WinCore::Core
+{
+    namespace
+    {
+        class SteadyFrameClock final : public FrameClock
+        {
+            public:
+                [[nodiscard]] std::chrono::nanoseconds Now() const override
+                {
+                    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+                }
+        };
+
+        double ToMilliseconds(std::chrono::nanoseconds duration) noexcept
+        {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    }
+
+    FrameClock& FrameClock::Steady()
+    {
+        static SteadyFrameClock clock{};
+        return clock;
+    }
+
+    void FrameScheduler::SampleRing::Add(double value, size_t capacity)
+    {
+        if (Values.size() < capacity)
+        {
+            Values.push_back(value);
+            return;
+        }
+
+        Values[Next] = value;
+        Next = (Next + 1) % capacity;
+    }
+
+    double FrameScheduler::SampleRing::GetPercentile(double percentile) const
+    {
+        if (Values.empty())
+            return 0.0;
+
+        std::vector<double> sorted = Values;
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const size_t index = static_cast<size_t>(clamped / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(index), sorted.end());
+        return sorted[index];
+    }
+
+    FrameScheduler::FrameScheduler(const FrameClock& clock, size_t sampleCapacity)
+        : clock_(clock), sampleCapacity_(std::max<size_t>(1, sampleCapacity))
+    {
+    }
+
+    void FrameScheduler::RegisterWindow(const void* window, uint32_t refreshRate, FrameCallbacks callbacks)
+    {
+        const auto existing = windows_.find(window);
+        if (existing != windows_.end() && !existing->second.Removed)
+            throw std::runtime_error("The window is already registered with the frame scheduler.");
+
+#ifdef _WIN32
+        if (refreshRate == 0)
+            refreshRate = Monitor::GetRefreshRate(static_cast<WindowHandle>(const_cast<void*>(window)));
+#endif
+
+        WindowState state{};
+        state.Callbacks = std::move(callbacks);
+        state.Interval = ToInterval(refreshRate);
+        state.Phase = clock_.Now();
+        windows_.insert_or_assign(window, std::move(state));
+    }
+
+    void FrameScheduler::UnregisterWindow(const void* window)
+    {
+        const auto iterator = windows_.find(window);
+        if (iterator == windows_.end())
+            return;
+
+        if (ticking_)
+        {
+            // Frame callbacks may hold a reference to the state, erase it once Tick is done.
+            iterator->second.Removed = true;
+            iterator->second.Dirty = FrameDirty::None;
+            return;
+        }
+
+        windows_.erase(iterator);
+    }
+
+    void FrameScheduler::SetRefreshRate(const void* window, uint32_t refreshRate)
+    {
+        WindowState& state = GetState(window);
+        const std::chrono::nanoseconds now = clock_.Now();
+        state.Interval = ToInterval(refreshRate);
+        state.Phase = now;
+
+        if (state.Dirty != FrameDirty::None)
+        {
+            state.ScheduledVsync = GetFrameVsync(state, now);
+            ArmWakeCallback();
+        }
+    }
+
+    void FrameScheduler::SetVsyncTime(const void* window, std::chrono::nanoseconds vsyncTime)
+    {
+        WindowState& state = GetState(window);
+        state.Phase = vsyncTime;
+
+        if (state.Dirty != FrameDirty::None)
+        {
+            state.ScheduledVsync = GetFrameVsync(state, clock_.Now());
+            ArmWakeCallback();
+        }
+    }
+
+#ifdef _WIN32
+    void FrameScheduler::UpdateRefreshRate(const void* window)
+    {
+        const WindowState& state = GetState(window);
+        const uint32_t refreshRate = Monitor::GetRefreshRate(static_cast<WindowHandle>(const_cast<void*>(window)));
+        if (ToInterval(refreshRate) != state.Interval)
+            SetRefreshRate(window, refreshRate);
+    }
+#endif
+
+    void FrameScheduler::Invalidate(const void* window, FrameDirty dirty)
+    {
+        WindowState& state = GetState(window);
+        ++statistics_.Invalidations;
+
+        if (state.Dirty != FrameDirty::None)
+        {
+            state.Dirty = state.Dirty | dirty;
+            ++statistics_.CoalescedInvalidations;
+            return;
+        }
+
+        Schedule(state, clock_.Now());
+        state.Dirty = dirty;
+    }
+
+    void FrameScheduler::RecordInput(const void* window, std::chrono::nanoseconds timestamp)
+    {
+        WindowState& state = GetState(window);
+        if (!state.PendingInput || timestamp < *state.PendingInput)
+            state.PendingInput = timestamp;
+    }
+
+    size_t FrameScheduler::Tick()
+    {
+        const std::chrono::nanoseconds now = clock_.Now();
+
+        dueWindows_.clear();
+        for (const auto& [window, state] : windows_)
+        {
+            if (state.Dirty != FrameDirty::None && state.ScheduledVsync <= now)
+                dueWindows_.push_back(window);
+        }
+
+        // The wake that led here has fired, the windows left dirty by this tick need a new one.
+        if (armedDeadline_ && *armedDeadline_ <= now)
+            armedDeadline_.reset();
+
+        ticking_ = true;
+        size_t frames = 0;
+        try
+        {
+            for (const void* window : dueWindows_)
+            {
+                WindowState& state = windows_.at(window);
+                if (state.Removed || state.Dirty == FrameDirty::None)
+                    continue;
+
+                ++frames;
+                RenderFrame(window, state);
+            }
+        }
+        catch (...)
+        {
+            // The failed window is no longer dirty, the windows after it are still due and get re-armed.
+            EndTick(true);
+            throw;
+        }
+
+        EndTick(frames > 0);
+        return frames;
+    }
+
+    std::optional<std::chrono::nanoseconds> FrameScheduler::GetNextDeadline() const
+    {
+        std::optional<std::chrono::nanoseconds> deadline;
+        for (const auto& [window, state] : windows_)
+        {
+            if (state.Dirty != FrameDirty::None && (!deadline || state.ScheduledVsync < *deadline))
+                deadline = state.ScheduledVsync;
+        }
+        return deadline;
+    }
+
+    void FrameScheduler::SetWakeCallback(WakeCallback callback)
+    {
+        wakeCallback_ = std::move(callback);
+        armedDeadline_.reset();
+        ArmWakeCallback();
+    }
+
+    double FrameScheduler::GetFrameTimePercentile(double percentile) const
+    {
+        return frameTimes_.GetPercentile(percentile);
+    }
+
+    double FrameScheduler::GetInputLatencyPercentile(double percentile) const
+    {
+        return inputLatencies_.GetPercentile(percentile);
+    }
+
+    std::chrono::nanoseconds FrameScheduler::ToInterval(uint32_t refreshRate) noexcept
+    {
+        // Windows reports 0 or 1 for "hardware default".
+        if (refreshRate <= 1)
+            refreshRate = DefaultRefreshRate;
+        return std::chrono::nanoseconds{(1'000'000'000ll + refreshRate / 2) / refreshRate};
+    }
+
+    std::chrono::nanoseconds FrameScheduler::GetNextVsync(const WindowState& state, std::chrono::nanoseconds time) noexcept
+    {
+        const int64_t offset = (time - state.Phase).count();
+        const int64_t interval = state.Interval.count();
+        const int64_t periods = offset >= 0 ? (offset + interval - 1) / interval : -((-offset) / interval);
+        return state.Phase + std::chrono::nanoseconds{periods * interval};
+    }
+
+    FrameScheduler::WindowState& FrameScheduler::GetState(const void* window)
+    {
+        const auto iterator = windows_.find(window);
+        if (iterator == windows_.end() || iterator->second.Removed)
+            throw std::runtime_error("The window is not registered with the frame scheduler.");
+        return iterator->second;
+    }
+
+    std::chrono::nanoseconds FrameScheduler::GetFrameVsync(const WindowState& state, std::chrono::nanoseconds now) noexcept
+    {
+        const std::chrono::nanoseconds vsync = GetNextVsync(state, now);
+
+        // At most one frame per refresh.
+        if (state.LastVsync.count() >= 0 && vsync <= state.LastVsync)
+            return state.LastVsync + state.Interval;
+        return vsync;
+    }
+
+    void FrameScheduler::Schedule(WindowState& state, std::chrono::nanoseconds now)
+    {
+        const std::chrono::nanoseconds vsync = GetFrameVsync(state, now);
+        if (state.LastVsync.count() >= 0)
+            statistics_.IdleRefreshes += static_cast<uint64_t>(std::max<int64_t>(0, (vsync - state.LastVsync) / state.Interval - 1));
+
+        state.ScheduledVsync = vsync;
+        if (!ticking_ && wakeCallback_ && (!armedDeadline_ || vsync < *armedDeadline_))
+        {
+            armedDeadline_ = vsync;
+            wakeCallback_(vsync);
+        }
+    }
+
+    void FrameScheduler::ArmWakeCallback()
+    {
+        if (ticking_)
+            return;
+
+        const std::optional<std::chrono::nanoseconds> deadline = GetNextDeadline();
+        if (!deadline)
+        {
+            armedDeadline_.reset();
+            return;
+        }
+
+        if (wakeCallback_ && deadline != armedDeadline_)
+        {
+            armedDeadline_ = deadline;
+            wakeCallback_(*deadline);
+        }
+    }
+
+    void FrameScheduler::EndTick(bool renderedFrames)
+    {
+        ticking_ = false;
+        std::erase_if(windows_, [](const auto& entry) { return entry.second.Removed; });
+
+        if (renderedFrames)
+        {
+            Utils::FrameArena::ForCurrentThread().Reset();
+            RecordFrameBoundary();
+        }
+
+        ArmWakeCallback();
+    }
+
+    void FrameScheduler::RecordFrameBoundary() noexcept
+    {
+        if (!traceRecorder_)
+            return;
+
+        try
+        {
+            traceRecorder_->RecordFrameBoundary();
+        }
+        catch (const std::exception& e)
+        {
+            // A recorder drops everything after a failed write, so it is detached after the first one.
+            WINCORE_LOG_ERROR("Input trace recording stopped: {}", e.what());
+            traceRecorder_ = nullptr;
+        }
+    }
+
+    void FrameScheduler::RenderFrame(const void* window, WindowState& state)
+    {
+        const std::chrono::nanoseconds start = clock_.Now();
+
+        FrameContext context{};
+        context.Window = window;
+        context.FrameIndex = state.FrameIndex++;
+        context.Dirty = std::exchange(state.Dirty, FrameDirty::None);
+        context.VsyncTime = state.ScheduledVsync;
+        context.Deadline = state.ScheduledVsync + state.Interval;
+        context.RefreshInterval = state.Interval;
+
+        // Invalidations made by the callbacks go to the refresh after the one this frame started on.
+        const std::chrono::nanoseconds nextVsync = GetNextVsync(state, start);
+        state.LastVsync = nextVsync == start ? start : nextVsync - state.Interval;
+        const std::optional<std::chrono::nanoseconds> input = std::exchange(state.PendingInput, std::nullopt);
+
+        if (HasFrameDirty(context.Dirty, FrameDirty::Layout) && state.Callbacks.Layout)
+            state.Callbacks.Layout(context);
+        if (state.Callbacks.Paint)
+            state.Callbacks.Paint(context);
+        if (state.Callbacks.Present)
+            state.Callbacks.Present(context);
+
+        const std::chrono::nanoseconds presented = clock_.Now();
+        ++statistics_.Frames;
+        if (presented > context.Deadline)
+            ++statistics_.MissedDeadlines;
+
+        frameTimes_.Add(ToMilliseconds(presented - start), sampleCapacity_);
+        if (input)
+            inputLatencies_.Add(ToMilliseconds(presented - *input), sampleCapacity_);
+    }
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace WinCore::Core
+{
+    class InputTraceRecorder;
+
+    /**
+     * @class FrameClock
+     * @brief The time source of a FrameScheduler. Times are nanoseconds since an arbitrary epoch.
+     */
+    class FrameClock
+    {
+        public:
+            virtual ~FrameClock() = default;
+
+            /**
+             * Returns the current time.
+             */
+            [[nodiscard]] virtual std::chrono::nanoseconds Now() const = 0;
+
+            /**
+             * Returns a clock backed by std::chrono::steady_clock, so its times can be converted to
+             * UiDispatcher::Clock::time_point for UiDispatcher::PostAt.
+             */
+            [[nodiscard]] static FrameClock& Steady();
+    };
+
+    /**
+     * @class ManualFrameClock
+     * @brief A clock that only moves when told to, used to drive a FrameScheduler deterministically.
+     */
+    class ManualFrameClock final : public FrameClock
+    {
+        public:
+            explicit ManualFrameClock(std::chrono::nanoseconds start = std::chrono::nanoseconds{0}) noexcept : now_(start) {}
+
+            [[nodiscard]] std::chrono::nanoseconds Now() const override { return now_; }
+
+            /**
+             * Moves the clock forward.
+             * @param duration The time to add.
+             */
+            void Advance(std::chrono::nanoseconds duration) noexcept { now_ += duration; }
+
+            /**
+             * Sets the clock to an absolute time.
+             * @param now The new time.
+             */
+            void Set(std::chrono::nanoseconds now) noexcept { now_ = now; }
+
+        private:
+            std::chrono::nanoseconds now_;
+    };
+
+    /**
+     * @enum FrameDirty
+     * @brief What has to be redone in the next frame of a window.
+     */
+    enum class FrameDirty : uint8_t
+    {
+        None = 0,           //< Nothing changed.
+        Paint = 1 << 0,     //< The window has to be repainted.
+        Layout = 1 << 1     //< The layout has to be recomputed before painting.
+    };
+
+    inline FrameDirty operator|(FrameDirty lhs, FrameDirty rhs)
+    {
+        return static_cast<FrameDirty>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+    }
+
+    inline bool HasFrameDirty(FrameDirty mask, FrameDirty flag)
+    {
+        return (static_cast<uint8_t>(mask) & static_cast<uint8_t>(flag)) != 0;
+    }
+
+    /**
+     * @struct FrameContext
+     * @brief Describes the frame a callback runs in.
+     */
+    struct FrameContext
+    {
+        const void* Window{nullptr};                    //< The window being rendered.
+        uint64_t FrameIndex{0};                         //< The number of frames rendered for the window before this one.
+        FrameDirty Dirty{FrameDirty::None};             //< The invalidations batched into this frame.
+        std::chrono::nanoseconds VsyncTime{0};          //< The refresh the frame was started on.
+        std::chrono::nanoseconds Deadline{0};           //< The refresh the frame has to be presented by.
+        std::chrono::nanoseconds RefreshInterval{0};    //< The refresh interval of the window's monitor.
+    };
+
+    /**
+     * @struct FrameCallbacks
+     * @brief The stages of a window's frame. Empty callbacks are skipped.
+     */
+    struct FrameCallbacks
+    {
+        std::function<void(const FrameContext&)> Layout{};     //< Runs when FrameDirty::Layout was set.
+        std::function<void(const FrameContext&)> Paint{};      //< Runs every frame.
+        std::function<void(const FrameContext&)> Present{};    //< Runs last, e.g. swaps buffers or calls EndPaint.
+    };
+
+    /**
+     * @struct FrameSchedulerStatistics
+     * @brief Counters collected over the lifetime of a FrameScheduler.
+     */
+    struct FrameSchedulerStatistics
+    {
+        uint64_t Frames{0};                 //< Frames rendered.
+        uint64_t MissedDeadlines{0};        //< Frames presented after the refresh they were due for.
+        uint64_t Invalidations{0};          //< Calls to Invalidate.
+        uint64_t CoalescedInvalidations{0}; //< Invalidations merged into a frame that was already scheduled.
+        uint64_t IdleRefreshes{0};          //< Refreshes skipped because nothing was dirty.
+    };
+
+    /**
+     * @class FrameScheduler
+     * @brief Aligns layout and paint of each window to the refresh rate of its monitor.
+     *
+     * Invalidate() marks a window dirty and schedules one frame on the next refresh of the
+     * window's monitor. Further invalidations before that refresh are batched into the same
+     * frame, and windows that are not dirty produce no frames at all. Call Tick() when
+     * GetNextDeadline() has passed, e.g. from UiDispatcher::PostAt via the wake callback.
+     * Tick() resets the FrameArena of the calling thread after it rendered frames.
+     * All methods must be called on the thread that owns the windows.
+     */
+    class FrameScheduler
+    {
+        public:
+            using WakeCallback = std::function<void(std::chrono::nanoseconds)>;
+
+            /**
+             * @var DefaultRefreshRate
+             * @brief The rate used when a monitor does not report one, same as Monitor::DefaultRefreshRate.
+             */
+            static constexpr uint32_t DefaultRefreshRate = 60;
+
+            /**
+             * Creates a scheduler.
+             * @param clock The time source, FrameClock::Steady() in applications and a ManualFrameClock in tests.
+             * @param sampleCapacity The number of recent frames the percentiles are computed over.
+             */
+            explicit FrameScheduler(const FrameClock& clock = FrameClock::Steady(), size_t sampleCapacity = 1024);
+            ~FrameScheduler() = default;
+
+            FrameScheduler(const FrameScheduler&) = delete;
+            FrameScheduler& operator=(const FrameScheduler&) = delete;
+            FrameScheduler(FrameScheduler&&) = delete;
+            FrameScheduler& operator=(FrameScheduler&&) = delete;
+
+            /**
+             * Adds a window.
+             * @param window An opaque key of the window (e.g. its HWND).
+             * @param refreshRate The refresh rate of the window's monitor in Hz, 0 to query it on Windows
+             *                    or use DefaultRefreshRate elsewhere.
+             * @param callbacks The stages of the window's frame.
+             * @throws std::runtime_error If the window is already registered.
+             */
+            void RegisterWindow(const void* window, uint32_t refreshRate, FrameCallbacks callbacks);
+
+            /**
+             * Removes a window. Its pending frame is dropped.
+             * @param window The window to remove.
+             */
+            void UnregisterWindow(const void* window);
+
+            /**
+             * Changes the refresh rate of a window, e.g. after it moved to another monitor.
+             * The refresh phase restarts at the current time.
+             * @param window The window.
+             * @param refreshRate The new refresh rate in Hz, 0 for the default.
+             */
+            void SetRefreshRate(const void* window, uint32_t refreshRate);
+
+            /**
+             * Aligns the refresh phase of a window to a measured vblank time.
+             * @param window The window.
+             * @param vsyncTime The time of a recent vblank on the clock of the scheduler.
+             */
+            void SetVsyncTime(const void* window, std::chrono::nanoseconds vsyncTime);
+
+#ifdef _WIN32
+            /**
+             * Queries the refresh rate of the monitor hosting the window and applies it if it changed.
+             * Call on WM_WINDOWPOSCHANGED, WM_DPICHANGED and WM_DISPLAYCHANGE.
+             * @param window The HWND of a registered window.
+             */
+            void UpdateRefreshRate(const void* window);
+#endif
+
+            /**
+             * Marks a window dirty and schedules a frame on its next refresh.
+             * @param window The window.
+             * @param dirty What has to be redone.
+             */
+            void Invalidate(const void* window, FrameDirty dirty = FrameDirty::Paint);
+
+            /**
+             * Records the arrival of an input event, the next presented frame of the window
+             * completes the input-to-present latency sample.
+             * @param window The window that received the input.
+             * @param timestamp The time the input was generated, on the clock of the scheduler.
+             */
+            void RecordInput(const void* window, std::chrono::nanoseconds timestamp);
+
+            /**
+             * Renders every dirty window whose refresh has arrived.
+             * @return The number of frames rendered.
+             * @throws Rethrows the exception of a frame callback. The window it was thrown for is no longer
+             *         dirty, windows that were not rendered yet stay due and the wake callback is re-armed.
+             */
+            size_t Tick();
+
+            /**
+             * Returns the time the next frame is due.
+             * @return The time, or std::nullopt if no window is dirty.
+             */
+            [[nodiscard]] std::optional<std::chrono::nanoseconds> GetNextDeadline() const;
+
+            /**
+             * Installs a callback invoked whenever GetNextDeadline() moves earlier, so the message
+             * loop can arm a timer for Tick().
+             * @param callback The callback, receives the new deadline.
+             */
+            void SetWakeCallback(WakeCallback callback);
+
+            /**
+             * Records a frame boundary into an input trace after every Tick() that rendered frames,
+             * so a replay runs layout and paint where the recording did. See UiDispatcher::SetInputTraceRecorder.
+             * @param recorder The recorder, it must outlive the recording. nullptr stops recording.
+             */
+            void SetInputTraceRecorder(InputTraceRecorder* recorder) noexcept { traceRecorder_ = recorder; }
+
+            /**
+             * Returns the counters of the scheduler.
+             */
+            [[nodiscard]] const FrameSchedulerStatistics& GetStatistics() const noexcept { return statistics_; }
+
+            /**
+             * Returns a percentile of the time from frame start to present over the recent frames.
+             * @param percentile The percentile in the range [0, 100].
+             * @return The frame time in milliseconds, 0 if no frame was rendered.
+             */
+            [[nodiscard]] double GetFrameTimePercentile(double percentile) const;
+
+            /**
+             * Returns a percentile of the input-to-present latency over the recent frames.
+             * @param percentile The percentile in the range [0, 100].
+             * @return The latency in milliseconds, 0 if no input was recorded.
+             */
+            [[nodiscard]] double GetInputLatencyPercentile(double percentile) const;
+
+        private:
+            struct WindowState
+            {
+                FrameCallbacks Callbacks{};
+                std::chrono::nanoseconds Interval{0};               //< The refresh interval.
+                std::chrono::nanoseconds Phase{0};                  //< A time that lies on a refresh.
+                std::chrono::nanoseconds LastVsync{-1};             //< The refresh of the last frame, -1 before the first one.
+                std::chrono::nanoseconds ScheduledVsync{0};         //< The refresh the pending frame starts on.
+                std::optional<std::chrono::nanoseconds> PendingInput{};    //< The oldest input not yet presented.
+                FrameDirty Dirty{FrameDirty::None};
+                uint64_t FrameIndex{0};
+                bool Removed{false};                                //< Unregistered during Tick, erased when it ends.
+            };
+
+            /**
+             * A fixed-size ring of the most recent samples.
+             */
+            struct SampleRing
+            {
+                std::vector<double> Values{};
+                size_t Next{0};                 //< The slot the next sample overwrites once the ring is full.
+
+                void Add(double value, size_t capacity);
+                [[nodiscard]] double GetPercentile(double percentile) const;
+            };
+
+            [[nodiscard]] static std::chrono::nanoseconds ToInterval(uint32_t refreshRate) noexcept;
+            [[nodiscard]] static std::chrono::nanoseconds GetNextVsync(const WindowState& state, std::chrono::nanoseconds time) noexcept;
+            [[nodiscard]] static std::chrono::nanoseconds GetFrameVsync(const WindowState& state, std::chrono::nanoseconds now) noexcept;
+            WindowState& GetState(const void* window);
+            void Schedule(WindowState& state, std::chrono::nanoseconds now);
+            void ArmWakeCallback();
+            void EndTick(bool renderedFrames);
+            void RecordFrameBoundary() noexcept;
+            void RenderFrame(const void* window, WindowState& state);
+
+            const FrameClock& clock_;
+            size_t sampleCapacity_;
+            std::unordered_map<const void*, WindowState> windows_{};
+            std::vector<const void*> dueWindows_{};                 //< Scratch list reused by Tick.
+            WakeCallback wakeCallback_{};
+            InputTraceRecorder* traceRecorder_{nullptr};            //< Receives a frame boundary per rendering tick.
+            std::optional<std::chrono::nanoseconds> armedDeadline_{};   //< The last deadline passed to the wake callback.
+            bool ticking_{false};                                   //< Set while Tick runs frame callbacks.
+            FrameSchedulerStatistics statistics_{};
+            SampleRing frameTimes_{};
+            SampleRing inputLatencies_{};
+    };
+}
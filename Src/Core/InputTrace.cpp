@@ -0,0 +1,467 @@
+#include "InputTrace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "Convertor.hpp"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WinCore::Core
+{
+    namespace
+    {
+        constexpr char TraceMagic[8] = {'W', 'C', 'T', 'R', 'A', 'C', 'E', '1'};
+        constexpr uint32_t TraceVersion = 1;
+        constexpr size_t TraceHeaderSize = sizeof(TraceMagic) + sizeof(uint32_t) * 2;
+        constexpr size_t TraceFlushThreshold = 64 * 1024;
+
+        constexpr uint8_t KindMask = 0x03;              //< Bits holding the TraceEntryKind.
+        constexpr uint8_t FlagSameWindow = 1 << 2;      //< The message targets the previous window.
+        constexpr uint8_t FlagZeroWParam = 1 << 3;      //< WPARAM is zero and omitted.
+        constexpr uint8_t FlagSameLParam = 1 << 4;      //< LPARAM equals the previous one and is omitted.
+
+        // Window message identifiers, spelled out so the trace code also builds without Windows.h.
+        constexpr uint32_t MsgMove = 0x0003;
+        constexpr uint32_t MsgSize = 0x0005;
+        constexpr uint32_t MsgActivate = 0x0006;
+        constexpr uint32_t MsgSetFocus = 0x0007;
+        constexpr uint32_t MsgKillFocus = 0x0008;
+        constexpr uint32_t MsgPaint = 0x000F;
+        constexpr uint32_t MsgClose = 0x0010;
+        constexpr uint32_t MsgShowWindow = 0x0018;
+        constexpr uint32_t MsgWindowPosChanged = 0x0047;
+        constexpr uint32_t MsgKeyFirst = 0x0100;
+        constexpr uint32_t MsgKeyLast = 0x0109;
+        constexpr uint32_t MsgTimer = 0x0113;
+        constexpr uint32_t MsgMouseFirst = 0x0200;
+        constexpr uint32_t MsgMouseLast = 0x020E;
+        constexpr uint32_t MsgCaptureChanged = 0x0215;
+        constexpr uint32_t MsgEnterSizeMove = 0x0231;
+        constexpr uint32_t MsgExitSizeMove = 0x0232;
+        constexpr uint32_t MsgMouseHover = 0x02A1;
+        constexpr uint32_t MsgMouseLeave = 0x02A3;
+        constexpr uint32_t MsgDpiChanged = 0x02E0;
+
+        void AppendVarint(std::vector<uint8_t>& out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        uint64_t ZigZagEncode(int64_t value)
+        {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        int64_t ZigZagDecode(uint64_t value)
+        {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        double ToMilliseconds(std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    }
+
+    InputTraceRecorder::InputTraceRecorder(const std::string& path)
+    {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_)
+            throw std::runtime_error("Failed to create input trace file.");
+
+        const uint32_t header[2] = {TraceVersion, 0};
+        if (std::fwrite(TraceMagic, 1, sizeof(TraceMagic), file_) != sizeof(TraceMagic) ||
+            std::fwrite(header, 1, sizeof(header), file_) != sizeof(header))
+        {
+            std::fclose(file_);
+            throw std::runtime_error("Failed to write input trace header.");
+        }
+
+        buffer_.reserve(TraceFlushThreshold * 2);
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    InputTraceRecorder::~InputTraceRecorder()
+    {
+        try
+        {
+            Flush();
+        }
+        catch (const std::exception&)
+        {
+            // Destructors cannot report it, call Flush() before to see write errors.
+        }
+        std::fclose(file_);
+    }
+
+    bool InputTraceRecorder::IsRecordedMessage(uint32_t message) noexcept
+    {
+        if ((message >= MsgKeyFirst && message <= MsgKeyLast) || (message >= MsgMouseFirst && message <= MsgMouseLast))
+            return true;
+
+        switch (message)
+        {
+            case MsgMove:
+            case MsgSize:
+            case MsgActivate:
+            case MsgSetFocus:
+            case MsgKillFocus:
+            case MsgPaint:
+            case MsgClose:
+            case MsgShowWindow:
+            case MsgWindowPosChanged:
+            case MsgTimer:
+            case MsgCaptureChanged:
+            case MsgEnterSizeMove:
+            case MsgExitSizeMove:
+            case MsgMouseHover:
+            case MsgMouseLeave:
+            case MsgDpiChanged:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void InputTraceRecorder::Record(const void* window, uint32_t message, uint64_t wParam, int64_t lParam)
+    {
+        if (!IsRecordedMessage(message))
+            return;
+
+        auto [it, inserted] = windowIds_.try_emplace(window, static_cast<uint32_t>(windowIds_.size() + 1));
+        Append(TraceEntryKind::Message, it->second, message, wParam, lParam);
+    }
+
+    void InputTraceRecorder::RecordFrameBoundary()
+    {
+        Append(TraceEntryKind::FrameBoundary, 0, 0, 0, 0);
+    }
+
+    void InputTraceRecorder::Append(TraceEntryKind kind, uint32_t windowId, uint32_t message, uint64_t wParam, int64_t lParam)
+    {
+        if (failed_)
+            return;
+
+        const uint64_t timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+
+        uint8_t flags = static_cast<uint8_t>(kind);
+        if (kind == TraceEntryKind::Message)
+        {
+            if (windowId == previousWindowId_)
+                flags |= FlagSameWindow;
+            if (wParam == 0)
+                flags |= FlagZeroWParam;
+            if (lParam == previousLParam_)
+                flags |= FlagSameLParam;
+        }
+
+        buffer_.push_back(flags);
+        AppendVarint(buffer_, timestamp - previousTimestamp_);
+        previousTimestamp_ = timestamp;
+
+        if (kind == TraceEntryKind::Message)
+        {
+            if (!(flags & FlagSameWindow))
+                AppendVarint(buffer_, windowId);
+            AppendVarint(buffer_, message);
+            if (!(flags & FlagZeroWParam))
+                AppendVarint(buffer_, wParam);
+            if (!(flags & FlagSameLParam))
+                AppendVarint(buffer_, ZigZagEncode(static_cast<int64_t>(static_cast<uint64_t>(lParam) - static_cast<uint64_t>(previousLParam_))));
+
+            previousWindowId_ = windowId;
+            previousLParam_ = lParam;
+        }
+
+        ++entryCount_;
+        if (buffer_.size() >= TraceFlushThreshold)
+            Flush();
+    }
+
+    void InputTraceRecorder::Flush()
+    {
+        if (buffer_.empty() || failed_)
+            return;
+
+        const bool written = std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+        buffer_.clear();
+        if (!written || std::fflush(file_) != 0)
+        {
+            // Later entries would decode against deltas that never reached the file.
+            failed_ = true;
+            throw std::runtime_error("Failed to write input trace file, the trace is truncated.");
+        }
+    }
+
+    InputTraceReader::InputTraceReader(const std::string& path)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(Utils::Convertor::ToWString(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Failed to open input trace file.");
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to query the size of the input trace file.");
+        }
+
+        // A recording that ended before its header was flushed leaves an empty file, it holds no entries.
+        if (fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            Rewind();
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view)
+        {
+            if (mapping)
+                CloseHandle(mapping);
+            CloseHandle(file);
+            throw std::runtime_error("Failed to map input trace file.");
+        }
+
+        fileHandle_ = file;
+        mappingHandle_ = mapping;
+        data_ = static_cast<const uint8_t*>(view);
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            throw std::runtime_error("Failed to open input trace file.");
+
+        struct stat status{};
+        if (fstat(file, &status) != 0)
+        {
+            close(file);
+            throw std::runtime_error("Failed to query the size of the input trace file.");
+        }
+
+        // A recording that ended before its header was flushed leaves an empty file, it holds no entries.
+        if (status.st_size == 0)
+        {
+            close(file);
+            Rewind();
+            return;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (view == MAP_FAILED)
+            throw std::runtime_error("Failed to map input trace file.");
+
+        madvise(view, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+        mappingHandle_ = view;
+        data_ = static_cast<const uint8_t*>(view);
+        size_ = static_cast<size_t>(status.st_size);
+#endif
+
+        uint32_t version = 0;
+        if (size_ >= TraceHeaderSize)
+            std::memcpy(&version, data_ + sizeof(TraceMagic), sizeof(version));
+
+        if (size_ < TraceHeaderSize || std::memcmp(data_, TraceMagic, sizeof(TraceMagic)) != 0 || version != TraceVersion)
+        {
+            Close();
+            throw std::runtime_error("The file is not a WinCore input trace.");
+        }
+
+        Rewind();
+    }
+
+    InputTraceReader::~InputTraceReader()
+    {
+        Close();
+    }
+
+    void InputTraceReader::Close() noexcept
+    {
+#ifdef _WIN32
+        if (data_)
+            UnmapViewOfFile(data_);
+        if (mappingHandle_)
+            CloseHandle(static_cast<HANDLE>(mappingHandle_));
+        if (fileHandle_)
+            CloseHandle(static_cast<HANDLE>(fileHandle_));
+#else
+        if (mappingHandle_)
+            munmap(mappingHandle_, size_);
+#endif
+        data_ = nullptr;
+        mappingHandle_ = nullptr;
+        fileHandle_ = nullptr;
+    }
+
+    void InputTraceReader::Rewind() noexcept
+    {
+        position_ = TraceHeaderSize;
+        previous_ = TraceEntry{};
+    }
+
+    uint64_t InputTraceReader::ReadVarint()
+    {
+        uint64_t value = 0;
+        for (uint32_t shift = 0; shift < 64; shift += 7)
+        {
+            if (position_ >= size_)
+                throw std::runtime_error("Truncated input trace.");
+
+            const uint8_t byte = data_[position_++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+
+        throw std::runtime_error("Malformed varint in input trace.");
+    }
+
+    bool InputTraceReader::Next(TraceEntry& entry)
+    {
+        if (position_ >= size_)
+            return false;
+
+        const uint8_t flags = data_[position_++];
+        const auto kind = static_cast<TraceEntryKind>(flags & KindMask);
+        if (kind != TraceEntryKind::Message && kind != TraceEntryKind::FrameBoundary)
+            throw std::runtime_error("Unknown entry in input trace.");
+
+        entry = previous_;
+        entry.Kind = kind;
+        entry.Timestamp = previous_.Timestamp + ReadVarint();
+        if (kind == TraceEntryKind::Message)
+        {
+            if (!(flags & FlagSameWindow))
+                entry.WindowId = static_cast<uint32_t>(ReadVarint());
+            entry.Message = static_cast<uint32_t>(ReadVarint());
+            entry.WParam = (flags & FlagZeroWParam) ? 0 : ReadVarint();
+            if (!(flags & FlagSameLParam))
+                entry.LParam = static_cast<int64_t>(static_cast<uint64_t>(previous_.LParam) + static_cast<uint64_t>(ZigZagDecode(ReadVarint())));
+
+            previous_ = entry;
+        }
+        else
+        {
+            // Frame boundaries only advance the clock, the message deltas keep their base.
+            previous_.Timestamp = entry.Timestamp;
+            entry.WindowId = 0;
+            entry.Message = 0;
+            entry.WParam = 0;
+            entry.LParam = 0;
+        }
+
+        return true;
+    }
+
+    double ReplayReport::GetFrameTimePercentile(double percentile) const
+    {
+        if (Frames.empty())
+            return 0.0;
+
+        std::vector<double> times;
+        times.reserve(Frames.size());
+        for (const ReplayFrameTiming& frame : Frames)
+            times.push_back(frame.TotalMs);
+
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const size_t index = static_cast<size_t>(clamped / 100.0 * static_cast<double>(times.size() - 1) + 0.5);
+        std::nth_element(times.begin(), times.begin() + static_cast<std::ptrdiff_t>(index), times.end());
+        return times[index];
+    }
+
+    ReplayReport InputTraceReplayer::Replay(InputTraceReader& reader, const ReplayTarget& target, ReplayPacing pacing)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        ReplayReport report{};
+        ReplayFrameTiming frame{};
+        Clock::duration dispatchTime{};
+
+        auto finishFrame = [&]() {
+            const Clock::time_point layoutStart = Clock::now();
+            if (target.Layout)
+                target.Layout();
+            const Clock::time_point paintStart = Clock::now();
+            if (target.Paint)
+                target.Paint();
+            const Clock::time_point paintEnd = Clock::now();
+
+            frame.DispatchMs = ToMilliseconds(dispatchTime);
+            frame.LayoutMs = ToMilliseconds(paintStart - layoutStart);
+            frame.PaintMs = ToMilliseconds(paintEnd - paintStart);
+            frame.TotalMs = frame.DispatchMs + frame.LayoutMs + frame.PaintMs;
+            report.Frames.push_back(frame);
+
+            frame = ReplayFrameTiming{};
+            frame.FrameIndex = report.Frames.size();
+            dispatchTime = Clock::duration{};
+        };
+
+        reader.Rewind();
+        const Clock::time_point replayStart = Clock::now();
+        TraceEntry entry{};
+        while (reader.Next(entry))
+        {
+            if (pacing == ReplayPacing::RecordedTiming)
+                std::this_thread::sleep_until(replayStart + std::chrono::microseconds(entry.Timestamp));
+
+            if (entry.Kind == TraceEntryKind::FrameBoundary)
+            {
+                finishFrame();
+                continue;
+            }
+
+            const Clock::time_point dispatchStart = Clock::now();
+            if (target.Dispatch)
+                target.Dispatch(entry);
+            dispatchTime += Clock::now() - dispatchStart;
+
+            ++frame.MessageCount;
+            ++report.MessageCount;
+        }
+
+        // Messages recorded after the last frame boundary still form a frame.
+        if (frame.MessageCount > 0)
+            finishFrame();
+
+        report.WallTimeMs = ToMilliseconds(Clock::now() - replayStart);
+        return report;
+    }
+
+    void InputTraceReplayer::WriteReport(const ReplayReport& report, const std::string& path)
+    {
+        std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+        if (!file)
+            throw std::runtime_error("Failed to create replay report file.");
+
+        std::fprintf(file.get(), "frame,messages,dispatch_ms,layout_ms,paint_ms,total_ms\n");
+        for (const ReplayFrameTiming& frame : report.Frames)
+        {
+            std::fprintf(file.get(), "%llu,%u,%.4f,%.4f,%.4f,%.4f\n", static_cast<unsigned long long>(frame.FrameIndex),
+                         frame.MessageCount, frame.DispatchMs, frame.LayoutMs, frame.PaintMs, frame.TotalMs);
+        }
+
+        if (std::ferror(file.get()) || std::fflush(file.get()) != 0)
+            throw std::runtime_error("Failed to write replay report file.");
+    }
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace WinCore::Core
+{
+    /**
+     * @enum TraceEntryKind
+     * @brief The kind of an entry stored in an input trace.
+     */
+    enum class TraceEntryKind : uint8_t
+    {
+        Message = 1,            //< A window or input message seen by the message pump.
+        FrameBoundary = 2       //< The end of a frame, layout and paint run after it on replay.
+    };
+
+    /**
+     * @struct TraceEntry
+     * @brief A single decoded entry of an input trace.
+     */
+    struct TraceEntry
+    {
+        TraceEntryKind Kind{TraceEntryKind::Message};   //< The kind of the entry.
+        uint64_t Timestamp{0};                          //< Microseconds since the recording started.
+        uint32_t WindowId{0};                           //< The dense id of the target window, in order of first appearance.
+        uint32_t Message{0};                            //< The message identifier (WM_*).
+        uint64_t WParam{0};                             //< The message WPARAM.
+        int64_t LParam{0};                              //< The message LPARAM.
+    };
+
+    /**
+     * @class InputTraceRecorder
+     * @brief Records the messages seen by the message pump into a compact binary trace.
+     *
+     * Entries are delta-encoded against the previous entry and written as variable
+     * length integers, so a typical mouse move takes only a few bytes. Hand the recorder to
+     * UiDispatcher::SetInputTraceRecorder and FrameScheduler::SetInputTraceRecorder to record
+     * what a UI thread pumps and renders. Not thread-safe, use it on one UI thread.
+     */
+    class InputTraceRecorder
+    {
+        public:
+            /**
+             * Creates the trace file and writes its header.
+             * @param path The path of the trace file to create.
+             * @throws std::runtime_error If the file cannot be created or its header cannot be written.
+             */
+            explicit InputTraceRecorder(const std::string& path);
+
+            /**
+             * Writes any buffered entries and closes the trace file.
+             */
+            ~InputTraceRecorder();
+
+            InputTraceRecorder(const InputTraceRecorder&) = delete;
+            InputTraceRecorder& operator=(const InputTraceRecorder&) = delete;
+            InputTraceRecorder(InputTraceRecorder&&) = delete;
+            InputTraceRecorder& operator=(InputTraceRecorder&&) = delete;
+
+            /**
+             * Checks whether a message affects input, layout or paint and is worth recording.
+             * @param message The message identifier (WM_*).
+             * @return True if the message should be recorded.
+             */
+            [[nodiscard]] static bool IsRecordedMessage(uint32_t message) noexcept;
+
+            /**
+             * Records a message if IsRecordedMessage accepts it.
+             * @param window An opaque key of the target window (e.g. its HWND).
+             * @param message The message identifier (WM_*).
+             * @param wParam The message WPARAM.
+             * @param lParam The message LPARAM.
+             * @throws std::runtime_error If buffered entries cannot be written, see Flush().
+             */
+            void Record(const void* window, uint32_t message, uint64_t wParam, int64_t lParam);
+
+            /**
+             * Records the end of a frame.
+             * @throws std::runtime_error If buffered entries cannot be written, see Flush().
+             */
+            void RecordFrameBoundary();
+
+            /**
+             * Writes buffered entries to the trace file.
+             * @throws std::runtime_error If the entries cannot be written. The trace ends at the
+             *         failed write and later entries are discarded.
+             */
+            void Flush();
+
+            /**
+             * Returns the number of entries recorded so far.
+             * @return The number of message and frame boundary entries.
+             */
+            [[nodiscard]] uint64_t GetEntryCount() const noexcept { return entryCount_; }
+
+        private:
+            void Append(TraceEntryKind kind, uint32_t windowId, uint32_t message, uint64_t wParam, int64_t lParam);
+
+            FILE* file_{nullptr};                                       //< The trace file.
+            std::vector<uint8_t> buffer_{};                             //< Encoded entries not yet written.
+            std::unordered_map<const void*, uint32_t> windowIds_{};     //< Dense ids of the recorded windows.
+            std::chrono::steady_clock::time_point start_{};             //< The time the recording started.
+            uint64_t previousTimestamp_{0};                             //< The timestamp of the previous entry.
+            uint32_t previousWindowId_{0};                              //< The window of the previous message.
+            int64_t previousLParam_{0};                                 //< The LPARAM of the previous message.
+            uint64_t entryCount_{0};                                    //< The number of recorded entries.
+            bool failed_{false};                                        //< A write failed, the trace is truncated.
+    };
+
+    /**
+     * @class InputTraceReader
+     * @brief Reads an input trace through a read-only memory mapping.
+     *
+     * An empty file, left behind by a recording that ended before anything was written,
+     * reads as a trace without entries.
+     */
+    class InputTraceReader
+    {
+        public:
+            /**
+             * Maps the trace file and validates its header.
+             * @param path The path of the trace file.
+             * @throws std::runtime_error If the file cannot be mapped or is neither empty nor an input trace.
+             */
+            explicit InputTraceReader(const std::string& path);
+
+            /**
+             * Unmaps the trace file.
+             */
+            ~InputTraceReader();
+
+            InputTraceReader(const InputTraceReader&) = delete;
+            InputTraceReader& operator=(const InputTraceReader&) = delete;
+            InputTraceReader(InputTraceReader&&) = delete;
+            InputTraceReader& operator=(InputTraceReader&&) = delete;
+
+            /**
+             * Decodes the next entry.
+             * @param entry Receives the decoded entry.
+             * @return True if an entry was decoded, false at the end of the trace.
+             * @throws std::runtime_error If the trace is truncated or malformed.
+             */
+            bool Next(TraceEntry& entry);
+
+            /**
+             * Restarts decoding from the first entry.
+             */
+            void Rewind() noexcept;
+
+        private:
+            uint64_t ReadVarint();
+            void Close() noexcept;
+
+            const uint8_t* data_{nullptr};      //< The mapped file contents.
+            size_t size_{0};                    //< The size of the mapping.
+            size_t position_{0};                //< The decode position.
+            TraceEntry previous_{};             //< The previously decoded entry, base of the deltas.
+            void* fileHandle_{nullptr};         //< The platform file handle.
+            void* mappingHandle_{nullptr};      //< The platform mapping handle.
+    };
+
+    /**
+     * @enum ReplayPacing
+     * @brief Controls how fast a trace is replayed.
+     */
+    enum class ReplayPacing : uint8_t
+    {
+        AsFastAsPossible = 0,   //< Entries are dispatched back to back.
+        RecordedTiming = 1      //< Entries are dispatched at their recorded offsets.
+    };
+
+    /**
+     * @struct ReplayTarget
+     * @brief The pipeline stages driven by InputTraceReplayer.
+     *
+     * Dispatch receives every message entry. Layout and Paint run once per frame boundary.
+     * Empty stages are skipped, so a replay can drive any subset of the pipeline.
+     */
+    struct ReplayTarget
+    {
+        std::function<void(const TraceEntry&)> Dispatch{};     //< Delivers a recorded message to the event dispatcher.
+        std::function<void()> Layout{};                        //< Runs the layout pass of the frame.
+        std::function<void()> Paint{};                         //< Runs the paint pass of the frame.
+    };
+
+    /**
+     * @struct ReplayFrameTiming
+     * @brief The measured cost of one replayed frame.
+     */
+    struct ReplayFrameTiming
+    {
+        uint64_t FrameIndex{0};         //< The index of the frame in the trace.
+        uint32_t MessageCount{0};       //< The number of messages dispatched during the frame.
+        double DispatchMs{0.0};         //< The time spent dispatching messages.
+        double LayoutMs{0.0};           //< The time spent in the layout pass.
+        double PaintMs{0.0};            //< The time spent in the paint pass.
+        double TotalMs{0.0};            //< The sum of the three stages.
+    };
+
+    /**
+     * @struct ReplayReport
+     * @brief The result of replaying a trace.
+     */
+    struct ReplayReport
+    {
+        std::vector<ReplayFrameTiming> Frames{};    //< The timing of every replayed frame.
+        uint64_t MessageCount{0};                   //< The total number of dispatched messages.
+        double WallTimeMs{0.0};                     //< The wall clock time of the whole replay.
+
+        /**
+         * Returns a percentile of the total frame time.
+         * @param percentile The percentile in the range [0, 100].
+         * @return The frame time in milliseconds, 0 if no frame was replayed.
+         */
+        [[nodiscard]] double GetFrameTimePercentile(double percentile) const;
+    };
+
+    /**
+     * @class InputTraceReplayer
+     * @brief Replays an input trace deterministically through a ReplayTarget.
+     *
+     * The replayer does not touch any window system API, so traces recorded in the
+     * field can be replayed headless as repeatable benchmarks.
+     */
+    class InputTraceReplayer
+    {
+        private:
+            InputTraceReplayer() = default;
+            ~InputTraceReplayer() = default;
+
+            InputTraceReplayer(const InputTraceReplayer&) = delete;
+            InputTraceReplayer& operator=(const InputTraceReplayer&) = delete;
+            InputTraceReplayer(InputTraceReplayer&&) = delete;
+            InputTraceReplayer& operator=(InputTraceReplayer&&) = delete;
+
+        public:
+            /**
+             * Replays every entry of the trace.
+             * @param reader The trace to replay, rewound before the replay starts.
+             * @param target The pipeline stages to drive.
+             * @param pacing Whether to honour the recorded timing.
+             * @return The per-frame timing of the replay.
+             * @throws std::runtime_error If the trace is malformed.
+             */
+            static ReplayReport Replay(InputTraceReader& reader, const ReplayTarget& target,
+                                       ReplayPacing pacing = ReplayPacing::AsFastAsPossible);
+
+            /**
+             * Writes a replay report as CSV, one line per frame.
+             * @param report The report to write.
+             * @param path The path of the CSV file.
+             * @throws std::runtime_error If the file cannot be created.
+             */
+            static void WriteReport(const ReplayReport& report, const std::string& path);
+    };
+}
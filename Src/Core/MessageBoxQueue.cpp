@@ -0,0 +1,196 @@
+#include "MessageBoxQueue.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "DebugLogger.hpp"
+
+namespace WinCore::Core
+{
+    namespace
+    {
+        bool IsSameMessage(const MessageBoxRequest& lhs, const MessageBoxRequest& rhs) noexcept
+        {
+            // Message boxes of different owners disable different windows, they are never merged.
+            return lhs.Owner == rhs.Owner && lhs.Style == rhs.Style && lhs.Title == rhs.Title && lhs.Text == rhs.Text;
+        }
+    }
+
+    MessageBoxQueue::MessageBoxQueue(UiDispatcherReference ui, std::shared_ptr<MessageBoxPresenter> presenter)
+        : ui_(std::move(ui)), state_(std::make_shared<State>())
+    {
+        if (!ui_)
+            throw std::invalid_argument("A message box queue needs a dispatcher.");
+        if (!presenter)
+            throw std::invalid_argument("A message box queue needs a presenter.");
+        state_->Presenter = std::move(presenter);
+    }
+
+    std::shared_future<int32_t> MessageBoxQueue::Enqueue(MessageBoxRequest request)
+    {
+        bool schedule = false;
+        std::shared_future<int32_t> result;
+        {
+            std::lock_guard<std::mutex> lock(state_->Mutex);
+            result = AddLocked(*state_, std::move(request), schedule)->Result;
+        }
+
+        if (schedule)
+            Schedule();
+        return result;
+    }
+
+    void MessageBoxQueue::Enqueue(MessageBoxRequest request, CloseCallback onClosed)
+    {
+        bool schedule = false;
+        {
+            std::lock_guard<std::mutex> lock(state_->Mutex);
+            std::shared_ptr<Entry> entry = AddLocked(*state_, std::move(request), schedule);
+            if (onClosed)
+                entry->Callbacks.push_back(std::move(onClosed));
+        }
+
+        if (schedule)
+            Schedule();
+    }
+
+    MessageBoxQueueStatistics MessageBoxQueue::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        MessageBoxQueueStatistics statistics = state_->Statistics;
+        statistics.Pending = state_->Pending.size();
+        return statistics;
+    }
+
+    std::shared_ptr<MessageBoxQueue::Entry> MessageBoxQueue::AddLocked(State& state, MessageBoxRequest request, bool& schedule)
+    {
+        ++state.Statistics.Requested;
+
+        // The visible message box cannot be updated, its later duplicates still share its result.
+        if (state.Visible && IsSameMessage(state.Visible->Request, request))
+        {
+            ++state.Visible->Request.Count;
+            ++state.Statistics.Coalesced;
+            return state.Visible;
+        }
+
+        for (const std::shared_ptr<Entry>& pending : state.Pending)
+        {
+            if (IsSameMessage(pending->Request, request))
+            {
+                ++pending->Request.Count;
+                ++state.Statistics.Coalesced;
+                return pending;
+            }
+        }
+
+        auto entry = std::make_shared<Entry>();
+        entry->Request = std::move(request);
+        entry->Request.Count = 1;
+        entry->Result = entry->Promise.get_future().share();
+        state.Pending.push_back(entry);
+
+        schedule = !state.Scheduled;
+        state.Scheduled = true;
+        return entry;
+    }
+
+    void MessageBoxQueue::PresentNext(const std::shared_ptr<State>& state, const UiDispatcherReference& ui)
+    {
+        std::shared_ptr<Entry> entry;
+        MessageBoxRequest request;
+        {
+            std::lock_guard<std::mutex> lock(state->Mutex);
+            if (state->Pending.empty())
+            {
+                state->Scheduled = false;
+                return;
+            }
+
+            entry = std::move(state->Pending.front());
+            state->Pending.pop_front();
+            state->Visible = entry;
+            request = entry->Request;
+            ++state->Statistics.Presented;
+        }
+
+        int32_t result = 0;
+        std::exception_ptr error;
+        try
+        {
+            result = state->Presenter->Present(request);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::vector<CloseCallback> callbacks;
+        bool more = false;
+        {
+            std::lock_guard<std::mutex> lock(state->Mutex);
+            state->Visible.reset();
+            callbacks = std::move(entry->Callbacks);
+            more = !state->Pending.empty();
+            state->Scheduled = more;
+        }
+
+        // One message box per work item, so the rest of the thread's work runs in between. The next one is
+        // posted before the callbacks run, whatever they do cannot stall the queue.
+        if (more)
+            PostNext(state, ui);
+        Complete(*entry, callbacks, result, error);
+    }
+
+    void MessageBoxQueue::PostNext(const std::shared_ptr<State>& state, const UiDispatcherReference& ui)
+    {
+        if (ui.Post([state, ui] { PresentNext(state, ui); }))
+            return;
+
+        // The presenting thread has ended, nothing would ever show the queued message boxes.
+        std::deque<std::shared_ptr<Entry>> pending;
+        std::vector<std::vector<CloseCallback>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(state->Mutex);
+            pending.swap(state->Pending);
+            state->Scheduled = false;
+            for (const std::shared_ptr<Entry>& entry : pending)
+                callbacks.push_back(std::move(entry->Callbacks));
+        }
+
+        WINCORE_LOG_WARNING("{} message box(es) dropped, the message box thread has ended.", pending.size());
+        const auto error = std::make_exception_ptr(std::runtime_error("The message box thread has ended."));
+        for (size_t index = 0; index < pending.size(); ++index)
+            Complete(*pending[index], callbacks[index], 0, error);
+    }
+
+    void MessageBoxQueue::Complete(Entry& entry, std::vector<CloseCallback>& callbacks, int32_t result, const std::exception_ptr& error)
+    {
+        if (error)
+            entry.Promise.set_exception(error);
+        else
+            entry.Promise.set_value(result);
+
+        // A throwing callback must not keep the others from running, nor escape into the dispatcher's message loop.
+        for (CloseCallback& callback : callbacks)
+        {
+            try
+            {
+                callback(result, error);
+            }
+            catch (const std::exception& exception)
+            {
+                WINCORE_LOG_ERROR("Message box callback failed: {}", exception.what());
+            }
+            catch (...)
+            {
+                WINCORE_LOG_ERROR("Message box callback failed with an unknown exception.");
+            }
+        }
+    }
+
+    void MessageBoxQueue::Schedule()
+    {
+        PostNext(state_, ui_);
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Async.hpp"
+
+namespace WinCore::Core
+{
+    /**
+     * @struct MessageBoxRequest
+     * @brief A message box waiting to be shown.
+     */
+    struct MessageBoxRequest
+    {
+        const void* Owner{nullptr};     //< The owner window (e.g. its HWND), nullptr for none. Part of the coalescing key.
+        std::string Text{};             //< UTF-8.
+        std::string Title{};            //< UTF-8.
+        uint32_t Style{0};              //< The icon and buttons, e.g. MessageBoxIcon | MessageBoxButton.
+        uint32_t Count{1};              //< Identical requests coalesced into this one when it was presented.
+    };
+
+    /**
+     * @class MessageBoxPresenter
+     * @brief Shows one message box and blocks until it is closed.
+     *
+     * The Win32 presenter calls MessageBoxW, tests substitute a stub.
+     */
+    class MessageBoxPresenter
+    {
+        public:
+            virtual ~MessageBoxPresenter() = default;
+
+            /**
+             * Shows a message box.
+             * @param request The message box, Count tells how many identical requests it stands for.
+             * @return The result code, e.g. a MessageBoxResult.
+             */
+            virtual int32_t Present(const MessageBoxRequest& request) = 0;
+    };
+
+    /**
+     * @struct MessageBoxQueueStatistics
+     * @brief Counters of a MessageBoxQueue.
+     */
+    struct MessageBoxQueueStatistics
+    {
+        uint64_t Requested{0};          //< Calls to Enqueue.
+        uint64_t Presented{0};          //< Message boxes shown.
+        uint64_t Coalesced{0};          //< Requests merged into a queued or visible identical message box.
+        size_t Pending{0};              //< Message boxes waiting to be shown.
+    };
+
+    /**
+     * @class MessageBoxQueue
+     * @brief Shows message boxes one at a time without blocking the threads requesting them.
+     *
+     * Enqueue() can be called from any thread and returns immediately. The message boxes are
+     * presented in order on the thread of a UiDispatcher, one per dispatched work item, so
+     * other work of that thread still runs between them. A request with the same owner, title,
+     * text and style as one that is queued or visible is merged into it: its counter goes up
+     * and both callers receive the same result. Exceptions thrown by close callbacks are
+     * logged and do not affect the other callbacks or the queue. Message boxes that cannot be
+     * posted because the dispatcher was destroyed fail with std::runtime_error, destroy the
+     * queue before its dispatcher.
+     */
+    class MessageBoxQueue
+    {
+        public:
+            using CloseCallback = std::function<void(int32_t, std::exception_ptr)>;
+
+            /**
+             * Creates a queue.
+             * @param ui The dispatcher of the thread that presents the message boxes.
+             * @param presenter The presenter.
+             * @throws std::invalid_argument If ui is empty or presenter is null.
+             */
+            MessageBoxQueue(UiDispatcherReference ui, std::shared_ptr<MessageBoxPresenter> presenter);
+            ~MessageBoxQueue() = default;
+
+            MessageBoxQueue(const MessageBoxQueue&) = delete;
+            MessageBoxQueue& operator=(const MessageBoxQueue&) = delete;
+            MessageBoxQueue(MessageBoxQueue&&) = delete;
+            MessageBoxQueue& operator=(MessageBoxQueue&&) = delete;
+
+            /**
+             * Queues a message box.
+             * @param request The message box, Count is ignored.
+             * @return The result code once the message box was closed, or the exception the presenter threw.
+             */
+            std::shared_future<int32_t> Enqueue(MessageBoxRequest request);
+
+            /**
+             * Queues a message box and invokes a callback when it was closed.
+             * @param request The message box, Count is ignored.
+             * @param onClosed Receives the result code or the exception the presenter threw, on the presenting thread.
+             *                 Runs on the calling thread instead if the dispatcher has already been destroyed.
+             */
+            void Enqueue(MessageBoxRequest request, CloseCallback onClosed);
+
+            /**
+             * Returns a snapshot of the queue counters.
+             */
+            [[nodiscard]] MessageBoxQueueStatistics GetStatistics() const;
+
+        private:
+            struct Entry
+            {
+                MessageBoxRequest Request{};
+                std::promise<int32_t> Promise{};
+                std::shared_future<int32_t> Result{};
+                std::vector<CloseCallback> Callbacks{};
+            };
+
+            /**
+             * The state shared with the work posted to the dispatcher.
+             */
+            struct State
+            {
+                mutable std::mutex Mutex{};
+                std::shared_ptr<MessageBoxPresenter> Presenter{};
+                std::deque<std::shared_ptr<Entry>> Pending{};
+                std::shared_ptr<Entry> Visible{};           //< The message box being presented.
+                bool Scheduled{false};                      //< Presentation work has been posted.
+                MessageBoxQueueStatistics Statistics{};
+            };
+
+            static std::shared_ptr<Entry> AddLocked(State& state, MessageBoxRequest request, bool& schedule);
+            static void PresentNext(const std::shared_ptr<State>& state, const UiDispatcherReference& ui);
+            static void PostNext(const std::shared_ptr<State>& state, const UiDispatcherReference& ui);
+            static void Complete(Entry& entry, std::vector<CloseCallback>& callbacks, int32_t result, const std::exception_ptr& error);
+            void Schedule();
+
+            UiDispatcherReference ui_;
+            std::shared_ptr<State> state_;
+    };
+}
@@ -5,10 +5,64 @@
 #pragma comment(lib, "User32.lib")
 #pragma comment(lib, "Kernel32.lib")
 
+#include <mutex>
+#include <utility>
+
 #include "Platform.hpp"
+#include "Convertor.hpp"
+#include "MessageBoxQueue.hpp"
+#include "UiThread.hpp"
 
 namespace WinCore::Core
 {
+    namespace
+    {
+        /**
+         * Shows the queued message boxes with MessageBoxW on the message box thread.
+         *
+         * An owner created on another thread makes Windows attach the input queues of both threads
+         * while the message box is open, see MessageBox::ShowAsync.
+         */
+        class Win32MessageBoxPresenter final : public MessageBoxPresenter
+        {
+            public:
+                int32_t Present(const MessageBoxRequest& request) override
+                {
+                    std::wstring text = Utils::Convertor::ToWString(request.Text);
+                    if (request.Count > 1)
+                        text += L"\n\n(This message occurred " + std::to_wstring(request.Count) + L" times.)";
+
+                    const std::wstring title = Utils::Convertor::ToWString(request.Title);
+                    return MessageBoxW(static_cast<HWND>(const_cast<void*>(request.Owner)), text.c_str(), title.c_str(), request.Style);
+                }
+        };
+
+        MessageBoxQueue& GetMessageBoxQueue()
+        {
+            // Leaked on purpose: message boxes still open at exit must not race static destruction.
+            static MessageBoxQueue* queue = [] {
+                auto* thread = new UiThread("WinCore MessageBox");
+                return new MessageBoxQueue(thread->GetDispatcher().GetReference(), std::make_shared<Win32MessageBoxPresenter>());
+            }();
+            return *queue;
+        }
+
+        std::future<MessageBoxResult> EnqueueMessageBox(WindowHandle windowHandle, std::string text, std::string title,
+                                                        MessageBoxIcon icon, MessageBoxButton buttons)
+        {
+            auto promise = std::make_shared<std::promise<MessageBoxResult>>();
+            std::future<MessageBoxResult> result = promise->get_future();
+
+            GetMessageBoxQueue().Enqueue(MessageBoxRequest{windowHandle, std::move(text), std::move(title), icon | buttons},
+                [promise](int32_t code, std::exception_ptr error) {
+                    if (error)
+                        promise->set_exception(error);
+                    else
+                        promise->set_value(static_cast<MessageBoxResult>(code));
+                });
+            return result;
+        }
+    }
 
     MessageBoxResult MessageBox::Show(const wchar_t * text, const wchar_t * title, MessageBoxIcon icon, MessageBoxButton buttons)
     {
@@ -17,7 +71,7 @@ namespace WinCore::Core
 
     MessageBoxResult MessageBox::Show(const char * text, const char * title, MessageBoxIcon icon, MessageBoxButton buttons)
     {
-        return static_cast<MessageBoxResult>(MessageBoxA(nullptr, text, title, icon | buttons));
+        return Show(nullptr, text, title, icon, buttons);
     }
 
     MessageBoxResult MessageBox::Show(const std::wstring & text, const std::wstring & title, MessageBoxIcon icon, MessageBoxButton buttons)
@@ -37,7 +91,10 @@ namespace WinCore::Core
 
     MessageBoxResult MessageBox::Show(WindowHandle windowHandle, const char * text, const char * title, MessageBoxIcon icon, MessageBoxButton buttons)
     {
-        return static_cast<MessageBoxResult>(MessageBoxA(windowHandle, text, title, icon | buttons));
+        // The text is UTF-8, MessageBoxA would read it in the ANSI code page.
+        const std::wstring wideText = text ? Utils::Convertor::ToWString(text) : std::wstring();
+        const std::wstring wideTitle = title ? Utils::Convertor::ToWString(title) : std::wstring();
+        return Show(windowHandle, wideText.c_str(), title ? wideTitle.c_str() : nullptr, icon, buttons);
     }
 
     MessageBoxResult MessageBox::Show(WindowHandle windowHandle, const std::wstring & text, const std::wstring & title, MessageBoxIcon icon, MessageBoxButton buttons)
@@ -50,6 +107,37 @@ namespace WinCore::Core
         return Show(windowHandle, text.c_str(), title.c_str(), icon, buttons);
     }
 
+    std::future<MessageBoxResult> MessageBox::ShowAsync(const std::string& text, const std::string& title, MessageBoxIcon icon, MessageBoxButton buttons)
+    {
+        return EnqueueMessageBox(nullptr, text, title, icon, buttons);
+    }
+
+    std::future<MessageBoxResult> MessageBox::ShowAsync(const std::wstring& text, const std::wstring& title, MessageBoxIcon icon, MessageBoxButton buttons)
+    {
+        return EnqueueMessageBox(nullptr, Utils::Convertor::ToUTF8(text), Utils::Convertor::ToUTF8(title), icon, buttons);
+    }
+
+    std::future<MessageBoxResult> MessageBox::ShowAsync(WindowHandle windowHandle, const std::string& text, const std::string& title, MessageBoxIcon icon, MessageBoxButton buttons)
+    {
+        return EnqueueMessageBox(windowHandle, text, title, icon, buttons);
+    }
+
+    std::future<MessageBoxResult> MessageBox::ShowAsync(WindowHandle windowHandle, const std::wstring& text, const std::wstring& title, MessageBoxIcon icon, MessageBoxButton buttons)
+    {
+        return EnqueueMessageBox(windowHandle, Utils::Convertor::ToUTF8(text), Utils::Convertor::ToUTF8(title), icon, buttons);
+    }
+
+    void MessageBox::ShowAsync(WindowHandle windowHandle, const std::string& text, const std::string& title, MessageBoxIcon icon, MessageBoxButton buttons,
+                               std::function<void(MessageBoxResult)> onClosed)
+    {
+        GetMessageBoxQueue().Enqueue(MessageBoxRequest{windowHandle, text, title, icon | buttons},
+            [onClosed = std::move(onClosed)](int32_t code, std::exception_ptr error) {
+                // MessageBoxW reports failure as 0, which is not a MessageBoxResult either.
+                if (onClosed)
+                    onClosed(error ? static_cast<MessageBoxResult>(0) : static_cast<MessageBoxResult>(code));
+            });
+    }
+
 
 
     void Monitor::SetProcessDPIAwareness(DPIAwareness awareness)
@@ -84,7 +172,10 @@ namespace WinCore::Core
 
     std::shared_ptr<Monitor::MonitorInfo> Monitor::GetPrimaryMonitor()
     {
+        // Several UI threads may ask for the primary monitor at once.
+        static std::mutex primaryMonitorMutex{};
         static std::shared_ptr<Monitor::MonitorInfo> primaryMonitor{nullptr};
+        std::lock_guard<std::mutex> lock(primaryMonitorMutex);
         if(!primaryMonitor)
         {
             primaryMonitor = std::make_shared<Monitor::MonitorInfo>();
@@ -131,4 +222,24 @@ namespace WinCore::Core
         return primaryMonitor;
     }
 
+    uint32_t Monitor::GetRefreshRate(WindowHandle windowHandle)
+    {
+        HMONITOR hMonitor = MonitorFromWindow(windowHandle, windowHandle ? MONITOR_DEFAULTTONEAREST : MONITOR_DEFAULTTOPRIMARY);
+        if (!hMonitor)
+            return DefaultRefreshRate;
+
+        MONITORINFOEXW monitorInfo{};
+        monitorInfo.cbSize = sizeof(MONITORINFOEXW);
+        if (!GetMonitorInfoW(hMonitor, &monitorInfo))
+            return DefaultRefreshRate;
+
+        DEVMODEW devMode = {};
+        devMode.dmSize = sizeof(devMode);
+        if (!EnumDisplaySettingsW(monitorInfo.szDevice, ENUM_CURRENT_SETTINGS, &devMode))
+            return DefaultRefreshRate;
+
+        // 0 and 1 stand for the hardware default rate.
+        return devMode.dmDisplayFrequency > 1 ? devMode.dmDisplayFrequency : DefaultRefreshRate;
+    }
+
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <functional>
+#include <future>
 #include <memory>
+#include <string>
 
 #include "WinDef.hpp"
 #include "WinClass.hpp"
@@ -111,8 +114,8 @@ namespace WinCore::Core
 
             /**
              * Displays a message box with the specified text, title, icon, buttons, default button, and mode.
-             * @param text The text to display in the message box.
-             * @param title The title of the message box.
+             * @param text The UTF-8 text to display in the message box.
+             * @param title The UTF-8 title of the message box.
              * @param icon The icon to display in the message box.
              * @param buttons The buttons to display in the message box.
              * @return The result of the message box (e.g., which button was clicked).
@@ -136,8 +139,8 @@ namespace WinCore::Core
 
             /**
              * Displays a message box with the specified text, title, icon, buttons, default button, and mode.
-             * @param text The text to display in the message box.
-             * @param title The title of the message box.
+             * @param text The UTF-8 text to display in the message box.
+             * @param title The UTF-8 title of the message box.
              * @param icon The icon to display in the message box.
              * @param buttons The buttons to display in the message box.
              * @return The result of the message box (e.g., which button was clicked).
@@ -163,8 +166,8 @@ namespace WinCore::Core
             /**
              * Displays a message box with the specified text, title, icon, buttons, default button, and mode.
              * @param windowHandle The handle of the window to associate with the message box.
-             * @param text The text to display in the message box.
-             * @param title The title of the message box.
+             * @param text The UTF-8 text to display in the message box.
+             * @param title The UTF-8 title of the message box.
              * @param icon The icon to display in the message box.
              * @param buttons The buttons to display in the message box.
              * @return The result of the message box (e.g., which button was clicked).
@@ -189,8 +192,8 @@ namespace WinCore::Core
             /**
              * Displays a message box with the specified text, title, icon, buttons, default button, and mode.
              * @param windowHandle The handle of the window to associate with the message box.
-             * @param text The text to display in the message box.
-             * @param title The title of the message box.
+             * @param text The UTF-8 text to display in the message box.
+             * @param title The UTF-8 title of the message box.
              * @param icon The icon to display in the message box.
              * @param buttons The buttons to display in the message box.
              * @return The result of the message box (e.g., which button was clicked).
@@ -198,6 +201,83 @@ namespace WinCore::Core
             static MessageBoxResult Show(WindowHandle windowHandle, const std::string& text, const std::string& title,
                                          MessageBoxIcon icon = MessageBoxIcon::None,
                                          MessageBoxButton buttons = MessageBoxButton::OK);
+
+            /**
+             * Queues a message box and returns without waiting for it.
+             *
+             * The message boxes are shown one at a time on a dedicated UI thread, so neither the
+             * calling thread nor the message loop of another window is blocked. A message box with
+             * the same owner, text, title, icon and buttons as one that is queued or visible is not shown
+             * again: the visible one notes how many times the message occurred and all callers
+             * receive its result.
+             * @param text The UTF-8 text to display in the message box.
+             * @param title The UTF-8 title of the message box.
+             * @param icon The icon to display in the message box.
+             * @param buttons The buttons to display in the message box.
+             * @return The result of the message box once it was closed.
+             */
+            static std::future<MessageBoxResult> ShowAsync(const std::string& text, const std::string& title,
+                                                           MessageBoxIcon icon = MessageBoxIcon::None,
+                                                           MessageBoxButton buttons = MessageBoxButton::OK);
+
+            /**
+             * Queues a message box and returns without waiting for it, see ShowAsync(const std::string&, ...).
+             * @param text The text to display in the message box.
+             * @param title The title of the message box.
+             * @param icon The icon to display in the message box.
+             * @param buttons The buttons to display in the message box.
+             * @return The result of the message box once it was closed.
+             */
+            static std::future<MessageBoxResult> ShowAsync(const std::wstring& text, const std::wstring& title,
+                                                           MessageBoxIcon icon = MessageBoxIcon::None,
+                                                           MessageBoxButton buttons = MessageBoxButton::OK);
+
+            /**
+             * Queues a message box owned by a window and returns without waiting for it, see ShowAsync(const std::string&, ...).
+             *
+             * The message box runs on the message box thread while its owner belongs to another
+             * thread, so Windows attaches the input queues of the two threads until it is closed.
+             * The owner's thread then shares keyboard focus and input state with the message box,
+             * and a hung owner thread can delay input to it. Pass nullptr for message boxes that
+             * must stay responsive regardless of the window that triggered them. Message boxes are
+             * only merged with identical ones of the same owner.
+             * @param windowHandle The handle of the window to associate with the message box.
+             * @param text The UTF-8 text to display in the message box.
+             * @param title The UTF-8 title of the message box.
+             * @param icon The icon to display in the message box.
+             * @param buttons The buttons to display in the message box.
+             * @return The result of the message box once it was closed.
+             */
+            static std::future<MessageBoxResult> ShowAsync(WindowHandle windowHandle, const std::string& text, const std::string& title,
+                                                           MessageBoxIcon icon = MessageBoxIcon::None,
+                                                           MessageBoxButton buttons = MessageBoxButton::OK);
+
+            /**
+             * Queues a message box owned by a window and returns without waiting for it, see ShowAsync(const std::string&, ...).
+             * @param windowHandle The handle of the window to associate with the message box.
+             * @param text The text to display in the message box.
+             * @param title The title of the message box.
+             * @param icon The icon to display in the message box.
+             * @param buttons The buttons to display in the message box.
+             * @return The result of the message box once it was closed.
+             */
+            static std::future<MessageBoxResult> ShowAsync(WindowHandle windowHandle, const std::wstring& text, const std::wstring& title,
+                                                           MessageBoxIcon icon = MessageBoxIcon::None,
+                                                           MessageBoxButton buttons = MessageBoxButton::OK);
+
+            /**
+             * Queues a message box and invokes a callback once it was closed, without blocking the caller.
+             * An owner ties the input queue of its thread to the message box thread, see ShowAsync(WindowHandle, const std::string&, ...).
+             * @param windowHandle The handle of the window to associate with the message box, or nullptr.
+             * @param text The UTF-8 text to display in the message box.
+             * @param title The UTF-8 title of the message box.
+             * @param icon The icon to display in the message box.
+             * @param buttons The buttons to display in the message box.
+             * @param onClosed Receives the result on the message box thread, marshal it to your UI thread if needed.
+             */
+            static void ShowAsync(WindowHandle windowHandle, const std::string& text, const std::string& title,
+                                  MessageBoxIcon icon, MessageBoxButton buttons,
+                                  std::function<void(MessageBoxResult)> onClosed);
     };
 
     /**
@@ -365,5 +445,15 @@ namespace WinCore::Core
              * which are used to scale UI elements appropriately on high-DPI displays.
              */
             static std::shared_ptr<MonitorInfo> GetPrimaryMonitor();
+
+            /**
+             * @brief Gets the refresh rate of the monitor that hosts a window.
+             * @param windowHandle The window, or nullptr for the primary monitor.
+             * @return The refresh rate in Hz, DefaultRefreshRate if the monitor does not report one.
+             *
+             * Unlike GetPrimaryMonitor the result is not cached, call it again after the window
+             * moved to another monitor or the display settings changed.
+             */
+            static uint32_t GetRefreshRate(WindowHandle windowHandle);
     };
 }
\ No newline at end of file
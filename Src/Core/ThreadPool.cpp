@@ -0,0 +1,473 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+#include "Async.hpp"
+#include "DebugLogger.hpp"
+#include "Memory.hpp"
+
+namespace WinCore::Core
+{
+    namespace Detail
+    {
+        struct PoolJob
+        {
+            std::function<void()> Work{};
+            TaskGroup* Group{nullptr};
+            TaskPriority Priority{TaskPriority::Normal};
+        };
+    }
+
+    namespace
+    {
+        constexpr int64_t InitialDequeCapacity = 256;
+        constexpr int SpinRoundsBeforeSleep = 64;
+
+        struct WorkerIdentity
+        {
+            const ThreadPool* Pool{nullptr};
+            size_t Index{0};
+        };
+
+        thread_local WorkerIdentity t_worker{};
+
+        /**
+         * Jobs are created and destroyed on different threads all the time, the pooled
+         * resource keeps that off the global heap.
+         */
+        std::pmr::polymorphic_allocator<Detail::PoolJob> GetJobAllocator()
+        {
+            return std::pmr::polymorphic_allocator<Detail::PoolJob>(&Utils::ObjectPool::Shared(Utils::MemorySubsystem::Tasks));
+        }
+
+        struct PoolJobDeleter
+        {
+            void operator()(Detail::PoolJob* job) const { GetJobAllocator().delete_object(job); }
+        };
+    }
+
+    namespace Detail
+    {
+        WorkStealingDeque::Ring::Ring(int64_t capacity)
+            : Capacity(capacity), Mask(capacity - 1), Slots(std::make_unique<std::atomic<PoolJob*>[]>(static_cast<size_t>(capacity)))
+        {
+        }
+
+        WorkStealingDeque::WorkStealingDeque()
+        {
+            rings_.push_back(std::make_unique<Ring>(InitialDequeCapacity));
+            ring_.store(rings_.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque::~WorkStealingDeque() = default;
+
+        void WorkStealingDeque::Push(PoolJob* job)
+        {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const int64_t top = top_.load(std::memory_order_acquire);
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+
+            if (bottom - top > ring->Capacity - 1)
+            {
+                // Grow into a new ring. The old one stays alive because thieves may still read it.
+                auto grown = std::make_unique<Ring>(ring->Capacity * 2);
+                for (int64_t index = top; index < bottom; ++index)
+                    grown->Put(index, ring->Get(index));
+
+                ring = grown.get();
+                rings_.push_back(std::move(grown));
+                ring_.store(ring, std::memory_order_release);
+            }
+
+            ring->Put(bottom, job);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        PoolJob* WorkStealingDeque::Pop() noexcept
+        {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = top_.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            PoolJob* job = ring->Get(bottom);
+            if (top == bottom)
+            {
+                // Last element: race against thieves for it.
+                if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    job = nullptr;
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        PoolJob* WorkStealingDeque::Steal() noexcept
+        {
+            int64_t top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = bottom_.load(std::memory_order_acquire);
+            if (top >= bottom)
+                return nullptr;
+
+            Ring* ring = ring_.load(std::memory_order_acquire);
+            PoolJob* job = ring->Get(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return job;
+        }
+
+        int64_t WorkStealingDeque::GetSizeEstimate() const noexcept
+        {
+            return std::max<int64_t>(0, bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed));
+        }
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        try
+        {
+            Wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void TaskGroup::Run(std::function<void()> work, TaskPriority priority)
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.Enqueue(GetJobAllocator().new_object<Detail::PoolJob>(std::move(work), this, priority));
+    }
+
+    void TaskGroup::Wait()
+    {
+        if (pool_.IsWorkerThread())
+        {
+            while (pending_.load(std::memory_order_acquire) > 0)
+            {
+                if (!pool_.RunOneJob())
+                    std::this_thread::yield();
+            }
+        }
+        else
+        {
+            // Jobs left to the workers were taken by them already or are queued on their deques.
+            while (pending_.load(std::memory_order_acquire) > 0 && pool_.RunGroupJob(*this))
+            {
+            }
+
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            waitCondition_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+        }
+
+        // Complete may still be inside waitMutex_ after the count dropped, the group must not die before it leaves.
+        {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+        }
+
+        std::exception_ptr failure;
+        {
+            std::lock_guard<std::mutex> lock(failureMutex_);
+            failure = std::exchange(failure_, nullptr);
+        }
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+
+    void TaskGroup::Complete(std::exception_ptr failure) noexcept
+    {
+        if (failure)
+        {
+            std::lock_guard<std::mutex> lock(failureMutex_);
+            if (!failure_)
+                failure_ = failure;
+        }
+
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            waitCondition_.notify_all();
+    }
+
+    ThreadPool::ThreadPool(size_t workerCount)
+    {
+        if (workerCount == 0)
+            workerCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+        workers_.reserve(workerCount);
+        for (size_t index = 0; index < workerCount; ++index)
+            workers_.push_back(std::make_unique<Worker>());
+
+        // Deques must all exist before any worker starts stealing.
+        for (size_t index = 0; index < workerCount; ++index)
+            workers_[index]->Thread = std::thread([this, index] { WorkerLoop(index); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        stopping_.store(true, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        sleepCondition_.notify_all();
+
+        for (const auto& worker : workers_)
+            worker->Thread.join();
+
+        // Workers drain their own deques before exiting, only injected jobs can remain.
+        while (RunOneJob())
+        {
+        }
+    }
+
+    ThreadPool& ThreadPool::Shared()
+    {
+        static ThreadPool pool{};
+        return pool;
+    }
+
+    bool ThreadPool::IsWorkerThread() const noexcept
+    {
+        return t_worker.Pool == this;
+    }
+
+    void ThreadPool::Submit(std::function<void()> work, TaskPriority priority)
+    {
+        Enqueue(GetJobAllocator().new_object<Detail::PoolJob>(std::move(work), nullptr, priority));
+    }
+
+    void ThreadPool::SubmitThen(UiDispatcher& ui, std::function<void()> work, std::function<void(std::exception_ptr)> continuation,
+                                TaskPriority priority)
+    {
+        Submit([ui = ui.GetReference(), work = std::move(work), continuation = std::move(continuation)]() mutable {
+            std::exception_ptr failure;
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+
+            if (!ui.Post([continuation = std::move(continuation), failure] { continuation(failure); }))
+                WINCORE_LOG_WARNING("A pool continuation was dropped, its UI thread has ended.");
+        }, priority);
+    }
+
+    void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& body,
+                                 TaskPriority priority)
+    {
+        if (begin >= end)
+            return;
+
+        const size_t count = end - begin;
+        const size_t targetChunks = workers_.size() * 4;
+        const size_t chunkSize = std::max<size_t>(std::max<size_t>(grainSize, 1), (count + targetChunks - 1) / targetChunks);
+        if (chunkSize >= count)
+        {
+            body(begin, end);
+            return;
+        }
+
+        TaskGroup group(*this);
+        for (size_t first = begin + chunkSize; first < end; first += chunkSize)
+        {
+            const size_t last = std::min(end, first + chunkSize);
+            group.Run([&body, first, last] { body(first, last); }, priority);
+        }
+
+        // The calling thread takes the first chunk itself.
+        std::exception_ptr failure;
+        try
+        {
+            body(begin, begin + chunkSize);
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+
+        group.Wait();
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+
+    void ThreadPool::Enqueue(Detail::PoolJob* job)
+    {
+        const size_t lane = static_cast<size_t>(job->Priority);
+        if (t_worker.Pool == this)
+        {
+            workers_[t_worker.Index]->Deques[lane].Push(job);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(injectionMutex_);
+            injection_[lane].push_back(job);
+            injectionCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+            }
+            sleepCondition_.notify_one();
+        }
+    }
+
+    Detail::PoolJob* ThreadPool::FindJob(size_t selfIndex)
+    {
+        const size_t workerCount = workers_.size();
+        const bool isWorker = selfIndex < workerCount;
+        for (size_t lane = 0; lane < PriorityCount; ++lane)
+        {
+            if (isWorker)
+            {
+                if (Detail::PoolJob* job = workers_[selfIndex]->Deques[lane].Pop())
+                    return job;
+            }
+
+            if (injectionCount_.load(std::memory_order_relaxed) > 0)
+            {
+                std::lock_guard<std::mutex> lock(injectionMutex_);
+                if (!injection_[lane].empty())
+                {
+                    Detail::PoolJob* job = injection_[lane].front();
+                    injection_[lane].pop_front();
+                    injectionCount_.fetch_sub(1, std::memory_order_relaxed);
+                    return job;
+                }
+            }
+
+            // Start stealing at the next worker so thieves spread over the victims.
+            const size_t start = isWorker ? selfIndex + 1 : 0;
+            for (size_t offset = 0; offset < workerCount; ++offset)
+            {
+                const size_t victim = (start + offset) % workerCount;
+                if (victim == selfIndex)
+                    continue;
+
+                if (Detail::PoolJob* job = workers_[victim]->Deques[lane].Steal())
+                    return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool ThreadPool::RunOneJob()
+    {
+        const size_t selfIndex = (t_worker.Pool == this) ? t_worker.Index : workers_.size();
+        Detail::PoolJob* job = FindJob(selfIndex);
+        if (!job)
+            return false;
+
+        Execute(job);
+        return true;
+    }
+
+    bool ThreadPool::RunGroupJob(const TaskGroup& group)
+    {
+        Detail::PoolJob* job = nullptr;
+        if (injectionCount_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(injectionMutex_);
+            for (size_t lane = 0; lane < PriorityCount && !job; ++lane)
+            {
+                auto iterator = std::find_if(injection_[lane].begin(), injection_[lane].end(),
+                                             [&group](const Detail::PoolJob* queued) { return queued->Group == &group; });
+                if (iterator != injection_[lane].end())
+                {
+                    job = *iterator;
+                    injection_[lane].erase(iterator);
+                    injectionCount_.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        if (!job)
+            return false;
+
+        Execute(job);
+        return true;
+    }
+
+    void ThreadPool::Execute(Detail::PoolJob* job)
+    {
+        std::unique_ptr<Detail::PoolJob, PoolJobDeleter> owned(job);
+        std::exception_ptr failure;
+        try
+        {
+            owned->Work();
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+
+        if (owned->Group)
+        {
+            owned->Group->Complete(failure);
+        }
+        else if (failure)
+        {
+            try
+            {
+                std::rethrow_exception(failure);
+            }
+            catch (const std::exception& exception)
+            {
+                WINCORE_LOG_ERROR("Thread pool job failed: {}", exception.what());
+            }
+            catch (...)
+            {
+                WINCORE_LOG_ERROR("Thread pool job failed with an unknown exception.");
+            }
+        }
+    }
+
+    void ThreadPool::WorkerLoop(size_t index)
+    {
+        t_worker = WorkerIdentity{this, index};
+
+        int idleRounds = 0;
+        while (true)
+        {
+            const uint64_t observedEpoch = epoch_.load(std::memory_order_seq_cst);
+            if (Detail::PoolJob* job = FindJob(index))
+            {
+                Execute(job);
+                idleRounds = 0;
+                continue;
+            }
+
+            if (stopping_.load(std::memory_order_acquire))
+                break;
+
+            if (++idleRounds < SpinRoundsBeforeSleep)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            sleepCondition_.wait(lock, [this, observedEpoch] {
+                return stopping_.load(std::memory_order_acquire) || epoch_.load(std::memory_order_seq_cst) != observedEpoch;
+            });
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            idleRounds = 0;
+        }
+
+        t_worker = WorkerIdentity{};
+    }
+}
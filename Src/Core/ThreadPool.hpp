@@ -0,0 +1,245 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinCore::Core
+{
+    class ThreadPool;
+    class UiDispatcher;
+
+    /**
+     * @enum TaskPriority
+     * @brief The lane a background job is queued in. Workers always drain higher lanes first.
+     */
+    enum class TaskPriority : uint8_t
+    {
+        Interactive = 0,    //< Work the user is waiting for, e.g. decoding a visible image.
+        Normal = 1,         //< Regular background work.
+        Prefetch = 2        //< Speculative work, e.g. shaping text of off-screen content.
+    };
+
+    namespace Detail
+    {
+        struct PoolJob;
+
+        /**
+         * @class WorkStealingDeque
+         * @brief Chase-Lev deque. The owner pushes and pops at the bottom, thieves steal from the top.
+         */
+        class WorkStealingDeque
+        {
+            public:
+                WorkStealingDeque();
+                ~WorkStealingDeque();
+
+                WorkStealingDeque(const WorkStealingDeque&) = delete;
+                WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+                WorkStealingDeque(WorkStealingDeque&&) = delete;
+                WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+                /**
+                 * Pushes a job at the bottom. Owner thread only.
+                 */
+                void Push(PoolJob* job);
+
+                /**
+                 * Pops the most recently pushed job. Owner thread only.
+                 * @return The job, or nullptr if the deque is empty.
+                 */
+                PoolJob* Pop() noexcept;
+
+                /**
+                 * Steals the oldest job. Any thread.
+                 * @return The job, or nullptr if the deque is empty or the steal lost a race.
+                 */
+                PoolJob* Steal() noexcept;
+
+                /**
+                 * Returns an estimate of the number of queued jobs.
+                 */
+                [[nodiscard]] int64_t GetSizeEstimate() const noexcept;
+
+            private:
+                struct Ring
+                {
+                    explicit Ring(int64_t capacity);
+
+                    int64_t Capacity;
+                    int64_t Mask;
+                    std::unique_ptr<std::atomic<PoolJob*>[]> Slots;
+
+                    PoolJob* Get(int64_t index) const noexcept { return Slots[index & Mask].load(std::memory_order_relaxed); }
+                    void Put(int64_t index, PoolJob* job) noexcept { Slots[index & Mask].store(job, std::memory_order_relaxed); }
+                };
+
+                alignas(64) std::atomic<int64_t> top_{0};              //< The steal end.
+                alignas(64) std::atomic<int64_t> bottom_{0};           //< The owner end.
+                alignas(64) std::atomic<Ring*> ring_{nullptr};         //< The current storage.
+                std::vector<std::unique_ptr<Ring>> rings_{};           //< Every ring ever allocated, old rings may still be read by thieves.
+        };
+    }
+
+    /**
+     * @class TaskGroup
+     * @brief Tracks a set of jobs submitted to a ThreadPool so they can be awaited together.
+     *
+     * On a worker, Wait helps running queued jobs instead of blocking, so groups can be
+     * nested without deadlocking the pool. Other threads, e.g. a UI thread, only run jobs
+     * of their own group and block otherwise, since an unrelated job might wait on them.
+     */
+    class TaskGroup
+    {
+        public:
+            /**
+             * @param pool The pool the group's jobs run on.
+             */
+            explicit TaskGroup(ThreadPool& pool) noexcept : pool_(pool) {}
+
+            /**
+             * Waits for the outstanding jobs. Exceptions thrown by jobs are discarded.
+             */
+            ~TaskGroup();
+
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+            TaskGroup(TaskGroup&&) = delete;
+            TaskGroup& operator=(TaskGroup&&) = delete;
+
+            /**
+             * Submits a job belonging to this group.
+             * @param work The job to run.
+             * @param priority The lane of the job.
+             */
+            void Run(std::function<void()> work, TaskPriority priority = TaskPriority::Normal);
+
+            /**
+             * Waits until every job of the group has finished, running queued jobs meanwhile.
+             * @throws The first exception thrown by a job of the group.
+             */
+            void Wait();
+
+        private:
+            friend class ThreadPool;
+
+            void Complete(std::exception_ptr failure) noexcept;
+
+            ThreadPool& pool_;                          //< The pool the jobs run on.
+            std::atomic<int64_t> pending_{0};           //< The number of jobs that have not finished.
+            std::mutex waitMutex_{};                    //< Held when the last job finishes, so the group outlives Complete.
+            std::condition_variable waitCondition_{};   //< Signalled when pending_ drops to zero.
+            std::mutex failureMutex_{};                 //< Guards failure_.
+            std::exception_ptr failure_{};              //< The first exception thrown by a job.
+    };
+
+    /**
+     * @class ThreadPool
+     * @brief Work-stealing pool of background workers with priority lanes.
+     *
+     * Every worker owns one Chase-Lev deque per priority. Jobs submitted from a worker
+     * go to its own deque, jobs submitted from other threads go to a shared injection
+     * queue. Idle workers steal from each other, always preferring higher priorities.
+     */
+    class ThreadPool
+    {
+        public:
+            static constexpr size_t PriorityCount = 3;      //< The number of TaskPriority lanes.
+
+            /**
+             * Starts the worker threads.
+             * @param workerCount The number of workers, 0 to use one per hardware thread.
+             */
+            explicit ThreadPool(size_t workerCount = 0);
+
+            /**
+             * Runs the remaining jobs and joins the workers.
+             */
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+            ThreadPool(ThreadPool&&) = delete;
+            ThreadPool& operator=(ThreadPool&&) = delete;
+
+            /**
+             * Returns the process-wide pool, sized to the machine.
+             * @return The shared pool, created on first use.
+             */
+            static ThreadPool& Shared();
+
+            /**
+             * Returns the number of worker threads.
+             */
+            [[nodiscard]] size_t GetWorkerCount() const noexcept { return workers_.size(); }
+
+            /**
+             * Checks whether the calling thread is a worker of this pool.
+             */
+            [[nodiscard]] bool IsWorkerThread() const noexcept;
+
+            /**
+             * Queues a job. Exceptions escaping the job are reported through the DebugLogger.
+             * @param work The job to run.
+             * @param priority The lane of the job.
+             */
+            void Submit(std::function<void()> work, TaskPriority priority = TaskPriority::Normal);
+
+            /**
+             * Runs a job on the pool and then a continuation on a UI thread. The continuation is
+             * dropped if the dispatcher is destroyed before the job ends.
+             * @param ui The dispatcher of the UI thread that runs the continuation.
+             * @param work The job to run on the pool.
+             * @param continuation The continuation, receiving the exception of the job or nullptr on success.
+             * @param priority The lane of the job.
+             */
+            void SubmitThen(UiDispatcher& ui, std::function<void()> work, std::function<void(std::exception_ptr)> continuation,
+                            TaskPriority priority = TaskPriority::Normal);
+
+            /**
+             * Splits [begin, end) into chunks of at least grainSize elements and runs them in parallel.
+             * The calling thread takes part and returns once every chunk has run.
+             * @param begin The first index.
+             * @param end One past the last index.
+             * @param grainSize The minimum number of indices per chunk.
+             * @param body Called with the [first, last) range of each chunk.
+             * @param priority The lane of the chunks.
+             * @throws The first exception thrown by body.
+             */
+            void ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& body,
+                             TaskPriority priority = TaskPriority::Normal);
+
+        private:
+            friend class TaskGroup;
+
+            struct Worker
+            {
+                Detail::WorkStealingDeque Deques[PriorityCount];
+                std::thread Thread{};
+            };
+
+            void Enqueue(Detail::PoolJob* job);
+            Detail::PoolJob* FindJob(size_t selfIndex);
+            bool RunOneJob();
+            bool RunGroupJob(const TaskGroup& group);
+            void Execute(Detail::PoolJob* job);
+            void WorkerLoop(size_t index);
+
+            std::vector<std::unique_ptr<Worker>> workers_{};                    //< The workers and their deques.
+            std::mutex injectionMutex_{};                                       //< Guards injection_.
+            std::deque<Detail::PoolJob*> injection_[PriorityCount]{};           //< Jobs submitted from outside the pool.
+            std::atomic<int64_t> injectionCount_{0};                            //< The number of jobs in injection_.
+            std::atomic<uint64_t> epoch_{0};                                    //< Incremented on every submission.
+            std::atomic<uint32_t> sleepers_{0};                                 //< The number of workers waiting for work.
+            std::mutex sleepMutex_{};                                           //< Guards the sleep condition.
+            std::condition_variable sleepCondition_{};                          //< Wakes idle workers.
+            std::atomic<bool> stopping_{false};                                 //< Set when the pool shuts down.
+    };
+}
@@ -0,0 +1,167 @@
+#include "UiThread.hpp"
+
+#include "DebugLogger.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "Convertor.hpp"
+#endif
+
+namespace WinCore::Core
+{
+    bool WindowThread::CheckAccess(const void* window) noexcept
+    {
+        const UiDispatcher* current = UiDispatcher::Current();
+        return current && UiDispatcher::FromWindow(window) == current;
+    }
+
+    void WindowThread::VerifyAccess(const void* window)
+    {
+        if (!CheckAccess(window))
+            throw std::runtime_error("The window belongs to another thread, marshal the call with WindowThread::Invoke.");
+    }
+
+    void WindowThread::Post(const void* window, std::function<void()> work)
+    {
+        if (!UiDispatcher::PostToWindow(window, std::move(work)))
+            throw std::runtime_error("The window is not attached to a UiDispatcher.");
+    }
+
+    UiThread::UiThread(std::string name) : state_(std::make_shared<State>())
+    {
+        state_->Name = std::move(name);
+
+        std::promise<void> started;
+        std::future<void> ready = started.get_future();
+        thread_ = std::thread([state = state_, &started] { Run(state, started); });
+
+        try
+        {
+            ready.get();
+        }
+        catch (...)
+        {
+            thread_.join();
+            throw;
+        }
+    }
+
+    UiThread::~UiThread()
+    {
+        Stop();
+        if (thread_.joinable())
+        {
+            if (IsCurrentThread())
+            {
+                // Destroyed from one of its own work items. The thread owns the state too and ends after it.
+                thread_.detach();
+                return;
+            }
+            thread_.join();
+        }
+    }
+
+    bool UiThread::Post(std::function<void()> work)
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        if (state_->Stopping)
+            return false;
+
+        state_->Dispatcher->Post(std::move(work));
+        return true;
+    }
+
+    void UiThread::Stop()
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        if (state_->Stopping)
+            return;
+
+        state_->Stopping = true;
+#ifdef _WIN32
+        state_->Dispatcher->Post([] { PostQuitMessage(0); });
+#else
+        state_->Dispatcher->Post([state = state_.get()] { state->Running.store(false, std::memory_order_release); });
+#endif
+    }
+
+    void UiThread::Join()
+    {
+        if (IsCurrentThread())
+            throw std::runtime_error("A UI thread cannot join itself.");
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void UiThread::Run(const std::shared_ptr<State>& state, std::promise<void>& started)
+    {
+        std::unique_ptr<UiDispatcher> dispatcher;
+        std::unique_ptr<FrameScheduler> scheduler;
+        try
+        {
+#ifdef _WIN32
+            SetThreadDescription(GetCurrentThread(), Utils::Convertor::ToWString(state->Name).c_str());
+#endif
+            dispatcher = std::make_unique<UiDispatcher>();
+            scheduler = std::make_unique<FrameScheduler>(FrameClock::Steady());
+
+            // FrameClock::Steady() and UiDispatcher::Clock share the steady_clock epoch.
+            scheduler->SetWakeCallback([ui = dispatcher.get(), frames = scheduler.get()](std::chrono::nanoseconds deadline) {
+                const auto wakeTime = UiDispatcher::Clock::time_point(std::chrono::duration_cast<UiDispatcher::Clock::duration>(deadline));
+                ui->PostAt(wakeTime, [frames] { frames->Tick(); });
+            });
+
+            state->Dispatcher = dispatcher.get();
+            state->Scheduler = scheduler.get();
+            state->Running.store(true, std::memory_order_release);
+        }
+        catch (...)
+        {
+            started.set_exception(std::current_exception());
+            return;
+        }
+
+        // The constructor returns and destroys the promise after this, it must not be touched again.
+        started.set_value();
+        WINCORE_LOG_DEBUG("UI thread '{}' started.", state->Name);
+
+        RunLoop(*state, *dispatcher);
+
+        // Stop() may still be inside Post() on another thread, it holds the lock until it returns.
+        {
+            std::lock_guard<std::mutex> lock(state->Mutex);
+            state->Stopping = true;
+            state->Dispatcher = nullptr;
+            state->Scheduler = nullptr;
+        }
+        scheduler.reset();
+        dispatcher.reset();
+        WINCORE_LOG_DEBUG("UI thread '{}' stopped.", state->Name);
+    }
+
+    void UiThread::RunLoop(State& state, UiDispatcher& dispatcher)
+    {
+        // RunPending rethrows the first failing work item and keeps the rest queued, so pumping again
+        // after logging loses nothing. Frame callbacks reach here through FrameScheduler::Tick.
+        while (state.Running.load(std::memory_order_acquire))
+        {
+            try
+            {
+#ifdef _WIN32
+                dispatcher.RunMessageLoop();
+                state.Running.store(false, std::memory_order_release);
+#else
+                dispatcher.WaitAndRunPending(std::chrono::milliseconds(100));
+#endif
+            }
+            catch (const std::exception& exception)
+            {
+                WINCORE_LOG_ERROR("Work on UI thread '{}' failed: {}", state.Name, exception.what());
+            }
+            catch (...)
+            {
+                WINCORE_LOG_ERROR("Work on UI thread '{}' failed with an unknown exception.", state.Name);
+            }
+        }
+    }
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Async.hpp"
+#include "FrameScheduler.hpp"
+
+namespace WinCore::Core
+{
+    /**
+     * @class WindowThread
+     * @brief Marshals operations on a window to the UI thread that owns it.
+     *
+     * Win32 windows belong to the thread that created them, and most window state in this
+     * library is not synchronized. Code running on another thread, including another UI
+     * thread, goes through these helpers instead of touching the window directly. Windows
+     * are found through UiDispatcher::AttachWindow.
+     */
+    class WindowThread
+    {
+        private:
+            WindowThread() = default;
+            ~WindowThread() = default;
+
+            WindowThread(const WindowThread&) = delete;
+            WindowThread& operator=(const WindowThread&) = delete;
+            WindowThread(WindowThread&&) = delete;
+            WindowThread& operator=(WindowThread&&) = delete;
+
+        public:
+            /**
+             * Checks whether the calling thread owns a window.
+             * @param window An opaque key of the window (e.g. its HWND).
+             * @return True if the window is attached to the dispatcher of the calling thread.
+             */
+            [[nodiscard]] static bool CheckAccess(const void* window) noexcept;
+
+            /**
+             * Throws unless the calling thread owns a window, for use at the top of window operations.
+             * @param window An opaque key of the window.
+             * @throws std::runtime_error If the window belongs to another thread or is not attached.
+             */
+            static void VerifyAccess(const void* window);
+
+            /**
+             * Queues work on the thread that owns a window without waiting for it.
+             * @param window An opaque key of the window.
+             * @param work The work to run.
+             * @throws std::runtime_error If the window is not attached to a dispatcher.
+             */
+            static void Post(const void* window, std::function<void()> work);
+
+            /**
+             * Runs work on the thread that owns a window. Runs it inline when called on that thread,
+             * so waiting on the result from the owning thread cannot deadlock.
+             * @param window An opaque key of the window.
+             * @param function The work to run.
+             * @return A future holding the result or the exception thrown by the work. It is broken
+             *         if the owning thread stops before running the work.
+             * @throws std::runtime_error If the window is not attached to a dispatcher.
+             */
+            template<typename Function>
+            static auto Invoke(const void* window, Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>&>>
+            {
+                using Result = std::invoke_result_t<std::decay_t<Function>&>;
+                auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+                std::future<Result> result = task->get_future();
+
+                if (CheckAccess(window))
+                    (*task)();
+                else
+                    Post(window, [task] { (*task)(); });
+                return result;
+            }
+
+            /**
+             * Runs work on the thread of a dispatcher, inline when called on that thread.
+             * @param dispatcher The dispatcher of the target thread, must be alive.
+             * @param function The work to run.
+             * @return A future holding the result or the exception thrown by the work.
+             */
+            template<typename Function>
+            static auto Invoke(UiDispatcher& dispatcher, Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>&>>
+            {
+                using Result = std::invoke_result_t<std::decay_t<Function>&>;
+                auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+                std::future<Result> result = task->get_future();
+
+                if (dispatcher.IsCurrentThread())
+                    (*task)();
+                else
+                    dispatcher.Post([task] { (*task)(); });
+                return result;
+            }
+    };
+
+    /**
+     * @class UiThread
+     * @brief A dedicated UI thread with its own message loop, dispatcher and frame scheduler.
+     *
+     * Windows created on a UiThread (e.g. through Invoke) belong to it, and a slow window
+     * only stalls the windows of its own thread. Each UiThread owns a UiDispatcher and a
+     * FrameScheduler whose wake callback is wired to the dispatcher, and frames reset the
+     * FrameArena of that thread. Window classes registered through WindowRegistry are shared
+     * by all threads. Destroy the windows of a thread on that thread before stopping it.
+     * Exceptions escaping work items or frame callbacks are logged and the loop keeps running,
+     * so a failing window cannot take down the other windows of its thread either.
+     */
+    class UiThread
+    {
+        public:
+            /**
+             * Starts the thread and waits until its dispatcher is ready.
+             * @param name The name of the thread shown in debuggers.
+             * @throws std::runtime_error If the dispatcher or the scheduler could not be created.
+             */
+            explicit UiThread(std::string name = "WinCore UI");
+
+            /**
+             * Stops the message loop and joins the thread. When called on the thread itself, e.g. from
+             * one of its work items, the thread is detached and ends after that work item instead.
+             */
+            ~UiThread();
+
+            UiThread(const UiThread&) = delete;
+            UiThread& operator=(const UiThread&) = delete;
+            UiThread(UiThread&&) = delete;
+            UiThread& operator=(UiThread&&) = delete;
+
+            /**
+             * Returns the dispatcher of the thread. Valid until the thread ends, prefer Post() and Invoke() from other threads.
+             */
+            [[nodiscard]] UiDispatcher& GetDispatcher() noexcept { return *state_->Dispatcher; }
+
+            /**
+             * Returns the frame scheduler of the thread. Only use it on the thread itself.
+             */
+            [[nodiscard]] FrameScheduler& GetFrameScheduler() noexcept { return *state_->Scheduler; }
+
+            /**
+             * Returns the id of the thread.
+             */
+            [[nodiscard]] std::thread::id GetId() const noexcept { return thread_.get_id(); }
+
+            /**
+             * Returns the name of the thread.
+             */
+            [[nodiscard]] const std::string& GetName() const noexcept { return state_->Name; }
+
+            /**
+             * Checks whether the calling thread is this UI thread.
+             */
+            [[nodiscard]] bool IsCurrentThread() const noexcept { return std::this_thread::get_id() == thread_.get_id(); }
+
+            /**
+             * Checks whether the message loop is still running.
+             */
+            [[nodiscard]] bool IsRunning() const noexcept { return state_->Running.load(std::memory_order_acquire); }
+
+            /**
+             * Queues work on the thread.
+             * @param work The work to run.
+             * @return False if the thread has been stopped, the work is dropped then.
+             */
+            bool Post(std::function<void()> work);
+
+            /**
+             * Runs work on the thread, see WindowThread::Invoke.
+             * @param function The work to run.
+             * @return A future holding the result or the exception thrown by the work.
+             * @throws std::runtime_error If the thread has been stopped.
+             */
+            template<typename Function>
+            auto Invoke(Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>&>>
+            {
+                using Result = std::invoke_result_t<std::decay_t<Function>&>;
+                auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+                std::future<Result> result = task->get_future();
+
+                if (IsCurrentThread())
+                    (*task)();
+                else if (!Post([task] { (*task)(); }))
+                    throw std::runtime_error("The UI thread has been stopped.");
+                return result;
+            }
+
+            /**
+             * Asks the message loop to end after the work queued so far. Returns without waiting.
+             */
+            void Stop();
+
+            /**
+             * Waits for the thread to end. Must not be called on the thread itself.
+             * @throws std::runtime_error If called on the thread itself.
+             */
+            void Join();
+
+        private:
+            /**
+             * The state shared with the thread, which outlives a UiThread destroyed from its own work.
+             */
+            struct State
+            {
+                std::string Name{};
+                std::mutex Mutex{};                         //< Guards Stopping against concurrent posts.
+                bool Stopping{false};
+                std::atomic<bool> Running{false};
+                UiDispatcher* Dispatcher{nullptr};          //< Lives on the stack of the thread.
+                FrameScheduler* Scheduler{nullptr};         //< Lives on the stack of the thread.
+            };
+
+            static void Run(const std::shared_ptr<State>& state, std::promise<void>& started);
+            static void RunLoop(State& state, UiDispatcher& dispatcher);
+
+            std::shared_ptr<State> state_;
+            std::thread thread_{};
+    };
+}
@@ -1,11 +1,32 @@
 #include "WinClass.hpp"
 
+#include <mutex>
+
 namespace WinCore::Core
 {
-    static std::unordered_map<std::wstring, HandleInstance> s_registeredClasses{};
+    namespace
+    {
+        struct RegisteredClass
+        {
+            HandleInstance Instance{nullptr};
+            uint32_t References{0};     //< Register calls not yet matched by Unregister.
+        };
+    }
+
+    // Window classes are process-wide while the UI threads registering them are not.
+    static std::mutex s_registeredClassesMutex{};
+    static std::unordered_map<std::wstring, RegisteredClass> s_registeredClasses{};
 
     void WindowRegistry::Register(const WindowClass& windowClass)
     {
+        std::lock_guard<std::mutex> lock(s_registeredClassesMutex);
+        auto existing = s_registeredClasses.find(windowClass.GetName());
+        if (existing != s_registeredClasses.end())
+        {
+            ++existing->second.References;
+            return;
+        }
+
         WNDCLASS wc = {};
         wc.lpfnWndProc = DefWindowProc; //[TODO]: Replace with actual window procedure function.
         wc.hInstance = windowClass.GetInstance();
@@ -19,11 +40,19 @@ namespace WinCore::Core
         }
 
         // Store the registered class in the map
-        s_registeredClasses[windowClass.GetName()] = windowClass.GetInstance();
+        s_registeredClasses[windowClass.GetName()] = RegisteredClass{windowClass.GetInstance(), 1};
     }
 
     void WindowRegistry::Unregister(const WindowClass& windowClass)
     {
+        std::lock_guard<std::mutex> lock(s_registeredClassesMutex);
+        auto existing = s_registeredClasses.find(windowClass.GetName());
+        if (existing != s_registeredClasses.end() && existing->second.References > 1)
+        {
+            --existing->second.References;
+            return;
+        }
+
         if (!UnregisterClass(windowClass.GetName().c_str(), windowClass.GetInstance()))
         {
             throw std::runtime_error("Failed to unregister window class.");
@@ -36,6 +65,7 @@ namespace WinCore::Core
     bool WindowRegistry::IsRegistered(const std::string& className)
     {
         std::wstring wideClassName = Utils::Convertor::ToWString(className);
+        std::lock_guard<std::mutex> lock(s_registeredClassesMutex);
         return s_registeredClasses.find(wideClassName) != s_registeredClasses.end();
     }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <unordered_map>
 #include "WinDef.hpp"
 #include "Convertor.hpp"
@@ -74,18 +75,26 @@ namespace WinCore::Core
             WindowExtenedStyle extendedStyles_;     //< The extended styles applied to the window class.
     };
 
+    /**
+     * @class WindowRegistry
+     * @brief Registers window classes once per process for all UI threads.
+     *
+     * Registration is reference counted and guarded by a mutex, so every UI thread may
+     * register the classes it needs and unregister them when it ends.
+     */
     class WindowRegistry
     {
         public:
             /**
-             * Registers a window class with the Windows API.
+             * Registers a window class with the Windows API, or adds a reference if it already is.
              * @param windowClass The WindowClass object to register.
              * @throws std::runtime_error If the registration fails.
              */
             static void Register(const WindowClass& windowClass);
 
             /**
-             * Unregisters a window class from the Windows API.
+             * Releases a reference taken by Register and unregisters the class from the Windows API
+             * once the last one is gone.
              * @param windowClass The WindowClass object to unregister.
              * @throws std::runtime_error If the unregistration fails.
              */
@@ -0,0 +1,455 @@
+#include "AnimationSystem.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <stdexcept>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define WINCORE_ANIMATION_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WINCORE_ANIMATION_SSE2 1
+#endif
+
+namespace WinCore::UI
+{
+    namespace
+    {
+        constexpr double RebaseAfterSeconds = 60.0;
+
+        /**
+         * One float at a time, used for the tail of a bucket and on targets without SIMD.
+         */
+        struct ScalarBatch
+        {
+            static constexpr size_t Width = 1;
+            float Value;
+
+            static ScalarBatch Load(const float* source) noexcept { return {*source}; }
+            static ScalarBatch Set(float value) noexcept { return {value}; }
+            void Store(float* destination) const noexcept { *destination = Value; }
+
+            friend ScalarBatch operator+(ScalarBatch lhs, ScalarBatch rhs) noexcept { return {lhs.Value + rhs.Value}; }
+            friend ScalarBatch operator-(ScalarBatch lhs, ScalarBatch rhs) noexcept { return {lhs.Value - rhs.Value}; }
+            friend ScalarBatch operator*(ScalarBatch lhs, ScalarBatch rhs) noexcept { return {lhs.Value * rhs.Value}; }
+            static ScalarBatch Clamp01(ScalarBatch value) noexcept { return {std::clamp(value.Value, 0.0f, 1.0f)}; }
+            static ScalarBatch SelectLess(ScalarBatch value, float threshold, ScalarBatch ifLess, ScalarBatch otherwise) noexcept
+            {
+                return value.Value < threshold ? ifLess : otherwise;
+            }
+        };
+
+#if defined(WINCORE_ANIMATION_AVX)
+        struct WideBatch
+        {
+            static constexpr size_t Width = 8;
+            __m256 Value;
+
+            static WideBatch Load(const float* source) noexcept { return {_mm256_loadu_ps(source)}; }
+            static WideBatch Set(float value) noexcept { return {_mm256_set1_ps(value)}; }
+            void Store(float* destination) const noexcept { _mm256_storeu_ps(destination, Value); }
+
+            friend WideBatch operator+(WideBatch lhs, WideBatch rhs) noexcept { return {_mm256_add_ps(lhs.Value, rhs.Value)}; }
+            friend WideBatch operator-(WideBatch lhs, WideBatch rhs) noexcept { return {_mm256_sub_ps(lhs.Value, rhs.Value)}; }
+            friend WideBatch operator*(WideBatch lhs, WideBatch rhs) noexcept { return {_mm256_mul_ps(lhs.Value, rhs.Value)}; }
+            static WideBatch Clamp01(WideBatch value) noexcept
+            {
+                return {_mm256_min_ps(_mm256_max_ps(value.Value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f))};
+            }
+            static WideBatch SelectLess(WideBatch value, float threshold, WideBatch ifLess, WideBatch otherwise) noexcept
+            {
+                const __m256 mask = _mm256_cmp_ps(value.Value, _mm256_set1_ps(threshold), _CMP_LT_OQ);
+                return {_mm256_blendv_ps(otherwise.Value, ifLess.Value, mask)};
+            }
+        };
+#elif defined(WINCORE_ANIMATION_SSE2)
+        struct WideBatch
+        {
+            static constexpr size_t Width = 4;
+            __m128 Value;
+
+            static WideBatch Load(const float* source) noexcept { return {_mm_loadu_ps(source)}; }
+            static WideBatch Set(float value) noexcept { return {_mm_set1_ps(value)}; }
+            void Store(float* destination) const noexcept { _mm_storeu_ps(destination, Value); }
+
+            friend WideBatch operator+(WideBatch lhs, WideBatch rhs) noexcept { return {_mm_add_ps(lhs.Value, rhs.Value)}; }
+            friend WideBatch operator-(WideBatch lhs, WideBatch rhs) noexcept { return {_mm_sub_ps(lhs.Value, rhs.Value)}; }
+            friend WideBatch operator*(WideBatch lhs, WideBatch rhs) noexcept { return {_mm_mul_ps(lhs.Value, rhs.Value)}; }
+            static WideBatch Clamp01(WideBatch value) noexcept
+            {
+                return {_mm_min_ps(_mm_max_ps(value.Value, _mm_setzero_ps()), _mm_set1_ps(1.0f))};
+            }
+            static WideBatch SelectLess(WideBatch value, float threshold, WideBatch ifLess, WideBatch otherwise) noexcept
+            {
+                const __m128 mask = _mm_cmplt_ps(value.Value, _mm_set1_ps(threshold));
+                return {_mm_or_ps(_mm_and_ps(mask, ifLess.Value), _mm_andnot_ps(mask, otherwise.Value))};
+            }
+        };
+#else
+        using WideBatch = ScalarBatch;
+#endif
+
+        template<Easing E, typename Batch>
+        Batch Ease(Batch t) noexcept
+        {
+            const Batch one = Batch::Set(1.0f);
+            if constexpr (E == Easing::Linear)
+            {
+                return t;
+            }
+            else if constexpr (E == Easing::EaseInQuad)
+            {
+                return t * t;
+            }
+            else if constexpr (E == Easing::EaseOutQuad)
+            {
+                return t * (Batch::Set(2.0f) - t);
+            }
+            else if constexpr (E == Easing::EaseOutCubic)
+            {
+                const Batch u = t - one;
+                return u * u * u + one;
+            }
+            else if constexpr (E == Easing::EaseInOutCubic)
+            {
+                const Batch four = Batch::Set(4.0f);
+                const Batch u = t - one;
+                return Batch::SelectLess(t, 0.5f, four * t * t * t, four * u * u * u + one);
+            }
+            else
+            {
+                return t * t * (Batch::Set(3.0f) - Batch::Set(2.0f) * t);
+            }
+        }
+
+        /**
+         * Evaluates lanes [begin, end) of a bucket, end - begin must be a multiple of Batch::Width.
+         */
+        template<Easing E, typename Batch, typename Bucket>
+        void EvaluateLanes(Bucket& bucket, size_t begin, size_t end, float now) noexcept
+        {
+            const Batch time = Batch::Set(now);
+            const Batch one = Batch::Set(1.0f);
+            float values[Batch::Width];
+            for (size_t index = begin; index < end; index += Batch::Width)
+            {
+                const Batch elapsed = time - Batch::Load(bucket.Start.data() + index);
+                const Batch progress = Batch::Clamp01(elapsed * Batch::Load(bucket.InverseDuration.data() + index));
+                progress.Store(bucket.Progress.data() + index);
+
+                // Written as from * (1 - e) + to * e so the last frame lands exactly on the final value.
+                const Batch eased = Ease<E>(progress);
+                const Batch value = Batch::Load(bucket.From.data() + index) * (one - eased) + Batch::Load(bucket.To.data() + index) * eased;
+                value.Store(values);
+
+                for (size_t lane = 0; lane < Batch::Width; ++lane)
+                    *bucket.Target[index + lane] = values[lane];
+            }
+        }
+
+        template<Easing E, typename Bucket>
+        void EvaluateBucket(Bucket& bucket, float now) noexcept
+        {
+            const size_t size = bucket.GetSize();
+            const size_t wideEnd = size - size % WideBatch::Width;
+            EvaluateLanes<E, WideBatch>(bucket, 0, wideEnd, now);
+            EvaluateLanes<E, ScalarBatch>(bucket, wideEnd, size, now);
+        }
+    }
+
+    AnimationHandle AnimationSystem::Animate(WidgetId widget, float* target, float to, Clock start, Clock duration,
+                                             Easing easing, std::function<void()> onComplete)
+    {
+        return Animate(widget, target, std::span<const float>(&to, 1), start, duration, easing, std::move(onComplete));
+    }
+
+    AnimationHandle AnimationSystem::Animate(WidgetId widget, float* target, std::span<const float> to, Clock start, Clock duration,
+                                             Easing easing, std::function<void()> onComplete)
+    {
+        if (!target || to.empty())
+            throw std::invalid_argument("An animation needs a target and at least one value.");
+        if (easing >= Easing::Count)
+            throw std::invalid_argument("Unknown easing curve.");
+
+        // Tick only rebases while lanes run, so an idle system restarts its time base here.
+        if (lanes_.empty())
+            timeBase_ = start;
+
+        const AnimationHandle handle = nextHandle_++;
+        const uint8_t bucketIndex = static_cast<uint8_t>(easing);
+        LaneBucket& bucket = buckets_[bucketIndex];
+
+        // A zero duration completes on the next tick.
+        const double seconds = std::chrono::duration<double>(duration).count();
+        const float inverseDuration = seconds > 0.0 ? static_cast<float>(1.0 / seconds) : 1e30f;
+        const float localStart = ToLocalSeconds(start);
+
+        for (size_t lane = 0; lane < to.size(); ++lane)
+        {
+            float* laneTarget = target + lane;
+            RemoveLane(laneTarget);
+
+            lanes_[laneTarget] = LaneLocation{bucketIndex, static_cast<uint32_t>(bucket.GetSize())};
+            bucket.Start.push_back(localStart);
+            bucket.InverseDuration.push_back(inverseDuration);
+            bucket.From.push_back(*laneTarget);
+            bucket.To.push_back(to[lane]);
+            bucket.Target.push_back(laneTarget);
+            bucket.Widget.push_back(widget);
+            bucket.Owner.push_back(handle);
+            bucket.Progress.push_back(0.0f);
+        }
+
+        const uint32_t laneCount = static_cast<uint32_t>(to.size());
+        handles_.emplace(handle, HandleState{target, laneCount, laneCount, widget, std::move(onComplete)});
+        widgetHandles_[widget].push_back(handle);
+        return handle;
+    }
+
+    void AnimationSystem::Cancel(AnimationHandle handle)
+    {
+        const auto iterator = handles_.find(handle);
+        if (iterator == handles_.end())
+            return;
+
+        const HandleState state = std::move(iterator->second);
+        handles_.erase(iterator);
+        ForgetHandle(handle, state.Widget);
+        ++cancelled_;
+
+        for (uint32_t lane = 0; lane < state.LaneCount; ++lane)
+        {
+            // Lanes replaced by a newer animation belong to that one now.
+            const auto location = lanes_.find(state.Target + lane);
+            if (location == lanes_.end())
+                continue;
+
+            LaneBucket& bucket = buckets_[location->second.Bucket];
+            if (bucket.Owner[location->second.Index] == handle)
+                RemoveLaneAt(bucket, location->second.Bucket, location->second.Index);
+        }
+    }
+
+    void AnimationSystem::CancelWidget(WidgetId widget)
+    {
+        const auto iterator = widgetHandles_.find(widget);
+        if (iterator == widgetHandles_.end())
+            return;
+
+        // Cancel edits the list, so it works on a copy.
+        const std::vector<AnimationHandle> owned = iterator->second;
+        for (AnimationHandle handle : owned)
+            Cancel(handle);
+    }
+
+    size_t AnimationSystem::Tick(Clock now)
+    {
+        dirtyWidgets_.clear();
+        finished_.clear();
+        if (lanes_.empty())
+            return 0;
+
+        if (std::chrono::duration<double>(now - timeBase_).count() > RebaseAfterSeconds)
+            Rebase(now);
+
+        // A tick marks at most one widget per lane, keep the dirty set at most half full.
+        if (dirtySlots_.size() < lanes_.size() * 2)
+        {
+            const size_t capacity = std::bit_ceil(std::max<size_t>(64, lanes_.size() * 2));
+            dirtySlots_.assign(capacity, 0);
+            dirtySlotStamps_.assign(capacity, 0);
+            tickStamp_ = 0;
+        }
+        if (++tickStamp_ == 0)
+        {
+            std::fill(dirtySlotStamps_.begin(), dirtySlotStamps_.end(), 0);
+            tickStamp_ = 1;
+        }
+
+        const float localNow = ToLocalSeconds(now);
+        size_t evaluated = 0;
+        for (size_t bucketIndex = 0; bucketIndex < EasingCount; ++bucketIndex)
+        {
+            LaneBucket& bucket = buckets_[bucketIndex];
+            if (bucket.GetSize() == 0)
+                continue;
+
+            switch (static_cast<Easing>(bucketIndex))
+            {
+                case Easing::Linear: EvaluateBucket<Easing::Linear>(bucket, localNow); break;
+                case Easing::EaseInQuad: EvaluateBucket<Easing::EaseInQuad>(bucket, localNow); break;
+                case Easing::EaseOutQuad: EvaluateBucket<Easing::EaseOutQuad>(bucket, localNow); break;
+                case Easing::EaseOutCubic: EvaluateBucket<Easing::EaseOutCubic>(bucket, localNow); break;
+                case Easing::EaseInOutCubic: EvaluateBucket<Easing::EaseInOutCubic>(bucket, localNow); break;
+                default: EvaluateBucket<Easing::SmoothStep>(bucket, localNow); break;
+            }
+            evaluated += bucket.GetSize();
+
+            // Walk backwards so swap-removal only moves lanes that were already visited.
+            for (size_t index = bucket.GetSize(); index-- > 0;)
+            {
+                const float progress = bucket.Progress[index];
+                if (progress > 0.0f)
+                    MarkDirty(bucket.Widget[index]);
+                if (progress < 1.0f)
+                    continue;
+
+                HandleState& state = handles_.at(bucket.Owner[index]);
+                if (--state.RemainingLanes == 0)
+                    finished_.push_back(bucket.Owner[index]);
+                RemoveLaneAt(bucket, static_cast<uint8_t>(bucketIndex), static_cast<uint32_t>(index));
+            }
+        }
+
+        lanesEvaluated_ += evaluated;
+
+        // Completion callbacks may start new animations, so they run once the buckets are consistent.
+        // Every finished handle is forgotten first, a throwing callback cannot leave one behind.
+        std::vector<std::function<void()>> callbacks;
+        for (AnimationHandle handle : finished_)
+        {
+            const auto iterator = handles_.find(handle);
+            if (iterator == handles_.end())
+                continue;
+
+            std::function<void()> onComplete = std::move(iterator->second.OnComplete);
+            const WidgetId widget = iterator->second.Widget;
+            handles_.erase(iterator);
+            ForgetHandle(handle, widget);
+            ++completed_;
+            if (onComplete)
+                callbacks.push_back(std::move(onComplete));
+        }
+
+        std::exception_ptr failure;
+        for (std::function<void()>& callback : callbacks)
+        {
+            try
+            {
+                callback();
+            }
+            catch (...)
+            {
+                if (!failure)
+                    failure = std::current_exception();
+            }
+        }
+        if (failure)
+            std::rethrow_exception(failure);
+
+        return evaluated;
+    }
+
+    AnimationStatistics AnimationSystem::GetStatistics() const noexcept
+    {
+        return AnimationStatistics{lanes_.size(), lanesEvaluated_, completed_, cancelled_};
+    }
+
+    float AnimationSystem::ToLocalSeconds(Clock time) const noexcept
+    {
+        return static_cast<float>(std::chrono::duration<double>(time - timeBase_).count());
+    }
+
+    void AnimationSystem::Rebase(Clock now)
+    {
+        // Shifted in double so the start times only round once, to the new base.
+        const double shift = std::chrono::duration<double>(now - timeBase_).count();
+        for (LaneBucket& bucket : buckets_)
+        {
+            for (float& start : bucket.Start)
+                start = static_cast<float>(static_cast<double>(start) - shift);
+        }
+        timeBase_ = now;
+    }
+
+    void AnimationSystem::RemoveLane(const float* target)
+    {
+        const auto location = lanes_.find(target);
+        if (location == lanes_.end())
+            return;
+
+        LaneBucket& bucket = buckets_[location->second.Bucket];
+        const AnimationHandle owner = bucket.Owner[location->second.Index];
+        RemoveLaneAt(bucket, location->second.Bucket, location->second.Index);
+
+        // The replaced animation ends when it loses its last lane.
+        const auto state = handles_.find(owner);
+        if (state != handles_.end() && --state->second.RemainingLanes == 0)
+        {
+            const WidgetId widget = state->second.Widget;
+            handles_.erase(state);
+            ForgetHandle(owner, widget);
+            ++cancelled_;
+        }
+    }
+
+    void AnimationSystem::RemoveLaneAt(LaneBucket& bucket, uint8_t bucketIndex, uint32_t index)
+    {
+        lanes_.erase(bucket.Target[index]);
+
+        const size_t last = bucket.GetSize() - 1;
+        if (index != last)
+        {
+            bucket.Start[index] = bucket.Start[last];
+            bucket.InverseDuration[index] = bucket.InverseDuration[last];
+            bucket.From[index] = bucket.From[last];
+            bucket.To[index] = bucket.To[last];
+            bucket.Target[index] = bucket.Target[last];
+            bucket.Widget[index] = bucket.Widget[last];
+            bucket.Owner[index] = bucket.Owner[last];
+            bucket.Progress[index] = bucket.Progress[last];
+            lanes_[bucket.Target[index]] = LaneLocation{bucketIndex, index};
+        }
+
+        bucket.Start.pop_back();
+        bucket.InverseDuration.pop_back();
+        bucket.From.pop_back();
+        bucket.To.pop_back();
+        bucket.Target.pop_back();
+        bucket.Widget.pop_back();
+        bucket.Owner.pop_back();
+        bucket.Progress.pop_back();
+    }
+
+    void AnimationSystem::ForgetHandle(AnimationHandle handle, WidgetId widget)
+    {
+        const auto iterator = widgetHandles_.find(widget);
+        if (iterator == widgetHandles_.end())
+            return;
+
+        std::vector<AnimationHandle>& owned = iterator->second;
+        const auto position = std::find(owned.begin(), owned.end(), handle);
+        if (position != owned.end())
+        {
+            *position = owned.back();
+            owned.pop_back();
+        }
+        if (owned.empty())
+            widgetHandles_.erase(iterator);
+    }
+
+    void AnimationSystem::MarkDirty(WidgetId widget)
+    {
+        // Widget ids may be sparse, so the per-tick set is an open-addressing table. Slots not stamped
+        // with the current tick are empty, which clears the table without touching it.
+        const size_t mask = dirtySlots_.size() - 1;
+        uint32_t hash = widget;
+        hash ^= hash >> 16;
+        hash *= 0x45D9F3Bu;
+        hash ^= hash >> 16;
+
+        size_t slot = hash & mask;
+        while (dirtySlotStamps_[slot] == tickStamp_)
+        {
+            if (dirtySlots_[slot] == widget)
+                return;
+            slot = (slot + 1) & mask;
+        }
+
+        dirtySlotStamps_[slot] = tickStamp_;
+        dirtySlots_[slot] = widget;
+        dirtyWidgets_.push_back(widget);
+    }
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace WinCore::UI
+{
+    using WidgetId = uint32_t;
+    using AnimationHandle = uint32_t;
+
+    /**
+     * @enum Easing
+     * @brief The curve that maps the linear progress of an animation to its output.
+     */
+    enum class Easing : uint8_t
+    {
+        Linear = 0,         //< Constant speed.
+        EaseInQuad = 1,     //< Starts slow, accelerates.
+        EaseOutQuad = 2,    //< Starts fast, decelerates.
+        EaseOutCubic = 3,   //< Like EaseOutQuad with a stronger deceleration.
+        EaseInOutCubic = 4, //< Slow at both ends.
+        SmoothStep = 5,     //< Hermite curve, slow at both ends with a gentle middle.
+        Count = 6
+    };
+
+    /**
+     * @struct AnimationStatistics
+     * @brief Counters of an AnimationSystem.
+     */
+    struct AnimationStatistics
+    {
+        size_t ActiveLanes{0};          //< Float properties currently animated.
+        uint64_t LanesEvaluated{0};     //< Lanes evaluated by all ticks so far.
+        uint64_t Completed{0};          //< Animations that ran to their end.
+        uint64_t Cancelled{0};          //< Animations cancelled or replaced by a newer one.
+    };
+
+    /**
+     * @class AnimationSystem
+     * @brief Evaluates many property animations per frame from contiguous arrays.
+     *
+     * Every animated float (a lane) lives in the structure-of-arrays bucket of its easing
+     * curve, so one tick runs one tight loop per curve. Progress, easing and interpolation
+     * are computed with AVX or SSE2 when the build targets them, and results are written
+     * straight into the property storage the caller pointed at. The widgets touched by a
+     * tick are reported once through GetDirtyWidgets().
+     *
+     * A target may only be animated by one animation at a time, animating it again replaces
+     * the running animation and starts from the current value. Property storage must stay
+     * valid until its animation completes or is cancelled. Not thread-safe, use it on the UI
+     * thread, e.g. from FrameScheduler callbacks with the frame's time.
+     */
+    class AnimationSystem
+    {
+        public:
+            using Clock = std::chrono::nanoseconds;
+
+            AnimationSystem() = default;
+            ~AnimationSystem() = default;
+
+            AnimationSystem(const AnimationSystem&) = delete;
+            AnimationSystem& operator=(const AnimationSystem&) = delete;
+            AnimationSystem(AnimationSystem&&) = delete;
+            AnimationSystem& operator=(AnimationSystem&&) = delete;
+
+            /**
+             * Animates a float property, e.g. opacity, from its current value.
+             * @param widget The widget that owns the property, reported dirty while the animation runs.
+             * @param target The property storage.
+             * @param to The final value.
+             * @param start The time the animation starts, on the clock passed to Tick.
+             * @param duration The length of the animation.
+             * @param easing The easing curve.
+             * @param onComplete Invoked from Tick after the final value was written, not when cancelled.
+             * @return The handle of the animation.
+             * @throws std::invalid_argument If target is null or easing is unknown.
+             */
+            AnimationHandle Animate(WidgetId widget, float* target, float to, Clock start, Clock duration,
+                                    Easing easing = Easing::EaseOutCubic, std::function<void()> onComplete = {});
+
+            /**
+             * Animates consecutive float properties together, e.g. a position (2) or a colour (4).
+             * @param widget The widget that owns the properties.
+             * @param target The first property.
+             * @param to The final values, one per property.
+             * @param start The time the animation starts.
+             * @param duration The length of the animation.
+             * @param easing The easing curve.
+             * @param onComplete Invoked from Tick after the final values were written.
+             * @return The handle of the animation.
+             * @throws std::invalid_argument If target is null, to is empty or easing is unknown.
+             */
+            AnimationHandle Animate(WidgetId widget, float* target, std::span<const float> to, Clock start, Clock duration,
+                                    Easing easing = Easing::EaseOutCubic, std::function<void()> onComplete = {});
+
+            /**
+             * Stops an animation, leaving the properties at their current values.
+             * @param handle The animation, ignored if it already finished.
+             */
+            void Cancel(AnimationHandle handle);
+
+            /**
+             * Stops every animation of a widget, e.g. before it is destroyed.
+             * @param widget The widget.
+             */
+            void CancelWidget(WidgetId widget);
+
+            /**
+             * Checks whether an animation is still running.
+             */
+            [[nodiscard]] bool IsActive(AnimationHandle handle) const { return handles_.contains(handle); }
+
+            /**
+             * Evaluates every animation at a point in time and writes the results.
+             * @param now The current time, e.g. FrameContext::VsyncTime.
+             * @return The number of lanes evaluated.
+             * @throws Rethrows the first exception of a completion callback, once every callback has run.
+             */
+            size_t Tick(Clock now);
+
+            /**
+             * Returns the widgets whose properties the last Tick wrote, each listed once.
+             */
+            [[nodiscard]] std::span<const WidgetId> GetDirtyWidgets() const noexcept { return dirtyWidgets_; }
+
+            /**
+             * Returns the counters of the system.
+             */
+            [[nodiscard]] AnimationStatistics GetStatistics() const noexcept;
+
+        private:
+            static constexpr size_t EasingCount = static_cast<size_t>(Easing::Count);
+
+            /**
+             * The lanes of one easing curve as a structure of arrays.
+             */
+            struct LaneBucket
+            {
+                std::vector<float> Start{};             //< Start time in seconds relative to timeBase_.
+                std::vector<float> InverseDuration{};   //< 1 / duration in seconds.
+                std::vector<float> From{};
+                std::vector<float> To{};
+                std::vector<float*> Target{};
+                std::vector<WidgetId> Widget{};
+                std::vector<AnimationHandle> Owner{};
+                std::vector<float> Progress{};          //< Scratch, the linear progress computed by the last Tick.
+
+                [[nodiscard]] size_t GetSize() const noexcept { return Target.size(); }
+            };
+
+            struct LaneLocation
+            {
+                uint8_t Bucket{0};
+                uint32_t Index{0};
+            };
+
+            struct HandleState
+            {
+                float* Target{nullptr};
+                uint32_t LaneCount{0};                  //< Lanes created for the animation.
+                uint32_t RemainingLanes{0};             //< Lanes not yet completed, replaced or cancelled.
+                WidgetId Widget{0};
+                std::function<void()> OnComplete{};
+            };
+
+            [[nodiscard]] float ToLocalSeconds(Clock time) const noexcept;
+            void Rebase(Clock now);
+            void RemoveLane(const float* target);
+            void RemoveLaneAt(LaneBucket& bucket, uint8_t bucketIndex, uint32_t index);
+            void ForgetHandle(AnimationHandle handle, WidgetId widget);
+            void MarkDirty(WidgetId widget);
+
+            std::array<LaneBucket, EasingCount> buckets_{};
+            std::unordered_map<const float*, LaneLocation> lanes_{};    //< Where the lane of each target lives.
+            std::unordered_map<AnimationHandle, HandleState> handles_{};
+            std::unordered_map<WidgetId, std::vector<AnimationHandle>> widgetHandles_{};   //< The running animations of each widget.
+            std::vector<AnimationHandle> finished_{};                   //< Scratch, handles completed by the current Tick.
+            std::vector<WidgetId> dirtyWidgets_{};
+            std::vector<WidgetId> dirtySlots_{};                        //< Open-addressing set of the widgets marked by the current tick.
+            std::vector<uint32_t> dirtySlotStamps_{};                   //< Per slot, the tick that filled it.
+            uint32_t tickStamp_{0};
+            AnimationHandle nextHandle_{1};
+            Clock timeBase_{0};                                         //< Float times are relative to this to keep their precision.
+            uint64_t lanesEvaluated_{0};
+            uint64_t completed_{0};
+            uint64_t cancelled_{0};
+    };
+}
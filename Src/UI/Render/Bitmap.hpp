@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace WinCore::UI
+{
+    /**
+     * @struct Bitmap
+     * @brief A CPU-side image stored as tightly packed, premultiplied BGRA8 pixels.
+     */
+    struct Bitmap
+    {
+        uint32_t Width{0};              //< The width of the image in pixels.
+        uint32_t Height{0};             //< The height of the image in pixels.
+        std::vector<uint8_t> Pixels{};  //< Width * Height * 4 bytes, top-down rows, premultiplied B, G, R, A.
+
+        Bitmap() = default;
+
+        /**
+         * Creates a bitmap of the given size with every pixel set to transparent black.
+         * @param width The width in pixels.
+         * @param height The height in pixels.
+         */
+        Bitmap(uint32_t width, uint32_t height) : Width(width), Height(height), Pixels(static_cast<size_t>(width) * height * 4, 0) {}
+
+        /**
+         * Returns the number of bytes per row.
+         */
+        [[nodiscard]] size_t GetStride() const noexcept { return static_cast<size_t>(Width) * 4; }
+
+        /**
+         * Returns the number of bytes used by the pixels.
+         */
+        [[nodiscard]] size_t GetByteSize() const noexcept { return Pixels.size(); }
+
+        /**
+         * Returns a pointer to the first pixel of a row.
+         */
+        [[nodiscard]] uint8_t* GetRow(uint32_t y) noexcept { return Pixels.data() + y * GetStride(); }
+        [[nodiscard]] const uint8_t* GetRow(uint32_t y) const noexcept { return Pixels.data() + y * GetStride(); }
+    };
+}
@@ -0,0 +1,298 @@
+#include "ImageCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "Async.hpp"
+#include "DebugLogger.hpp"
+#include "ImageCodec.hpp"
+#include "ThreadPool.hpp"
+
+namespace WinCore::UI
+{
+    namespace
+    {
+        constexpr uint32_t DefaultDpi = 96;
+
+        std::vector<uint8_t> ReadWholeFile(const std::string& path)
+        {
+            std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+            if (!file)
+                throw std::runtime_error("Failed to open image: " + path);
+
+            std::vector<uint8_t> contents;
+            constexpr size_t ChunkSize = 64 * 1024;
+            size_t read = 0;
+            do
+            {
+                const size_t offset = contents.size();
+                contents.resize(offset + ChunkSize);
+                read = std::fread(contents.data() + offset, 1, ChunkSize, file.get());
+                contents.resize(offset + read);
+            } while (read == ChunkSize);
+
+            if (std::ferror(file.get()))
+                throw std::runtime_error("Failed to read image: " + path);
+            return contents;
+        }
+    }
+
+    ImageCache::ImageCache(size_t memoryBudget, Core::ThreadPool* pool, ResampleFilter filter)
+        : state_(std::make_shared<State>()), pool_(pool ? pool : &Core::ThreadPool::Shared())
+    {
+        state_->MemoryBudget = memoryBudget;
+        state_->Filter = filter;
+    }
+
+    ImageCache::~ImageCache() = default;
+
+    uint32_t ImageCache::ScaleForDpi(uint32_t logical, uint32_t dpi) noexcept
+    {
+        const uint64_t scaled = (static_cast<uint64_t>(logical) * dpi + DefaultDpi / 2) / DefaultDpi;
+        return static_cast<uint32_t>(std::max<uint64_t>(1, scaled));
+    }
+
+    ImageId ImageCache::AddImage(Bitmap bitmap)
+    {
+        if (bitmap.Width == 0 || bitmap.Height == 0)
+            throw std::invalid_argument("Cannot add an empty image to the cache.");
+
+        auto source = std::make_shared<const Bitmap>(std::move(bitmap));
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        const ImageId id = state_->NextId++;
+        state_->Sources.emplace(id, std::move(source));
+        return id;
+    }
+
+    void ImageCache::LoadImageAsync(std::string path, Core::UiDispatcher& ui, LoadCallback callback)
+    {
+        pool_->Submit([state = state_, path = std::move(path), ui = ui.GetReference(), callback = std::move(callback)]() mutable {
+            ImageId id = 0;
+            std::exception_ptr failure;
+            try
+            {
+                auto source = std::make_shared<const Bitmap>(ImageCodec::Decode(ReadWholeFile(path)));
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                id = state->NextId++;
+                state->Sources.emplace(id, std::move(source));
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+
+            if (!ui.Post([callback = std::move(callback), id, failure] { callback(id, failure); }))
+                WINCORE_LOG_WARNING("An image load callback was dropped, its UI thread has ended.");
+        }, Core::TaskPriority::Interactive);
+    }
+
+    void ImageCache::RemoveImage(ImageId id)
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        state_->Sources.erase(id);
+        for (auto iterator = state_->Variants.begin(); iterator != state_->Variants.end();)
+        {
+            if (iterator->first.Id == id)
+            {
+                state_->Statistics.VariantBytes -= iterator->second.Pixels->GetByteSize();
+                state_->UsageOrder.erase(iterator->second.Usage);
+                iterator = state_->Variants.erase(iterator);
+            }
+            else
+            {
+                ++iterator;
+            }
+        }
+        state_->Statistics.VariantCount = state_->Variants.size();
+    }
+
+    std::shared_ptr<const Bitmap> ImageCache::GetSource(ImageId id) const
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        const auto iterator = state_->Sources.find(id);
+        return iterator != state_->Sources.end() ? iterator->second : nullptr;
+    }
+
+    std::shared_ptr<const Bitmap> ImageCache::TryGetVariant(ImageId id, uint32_t width, uint32_t height)
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        return FindVariantLocked(*state_, VariantKey{id, width, height});
+    }
+
+    std::shared_ptr<const Bitmap> ImageCache::GetVariant(ImageId id, uint32_t width, uint32_t height)
+    {
+        ValidateRequest(width, height);
+
+        const VariantKey key{id, width, height};
+        std::shared_ptr<const Bitmap> source;
+        ResampleFilter filter{ResampleFilter::Lanczos3};
+        {
+            std::lock_guard<std::mutex> lock(state_->Mutex);
+            if (auto cached = FindVariantLocked(*state_, key))
+                return cached;
+
+            source = SelectResampleSourceLocked(*state_, key);
+            filter = state_->Filter;
+            ++state_->Statistics.Misses;
+        }
+
+        if (!source)
+            throw std::invalid_argument("Unknown image id.");
+
+        return StoreVariant(*state_, key, ImageResampler::Resample(*source, width, height, filter, pool_));
+    }
+
+    void ImageCache::RequestVariant(ImageId id, uint32_t width, uint32_t height, Core::UiDispatcher& ui, VariantCallback callback)
+    {
+        ValidateRequest(width, height);
+
+        const VariantKey key{id, width, height};
+        std::shared_ptr<const Bitmap> source;
+        std::shared_ptr<const Bitmap> cached;
+        ResampleFilter filter{ResampleFilter::Lanczos3};
+        {
+            std::lock_guard<std::mutex> lock(state_->Mutex);
+            cached = FindVariantLocked(*state_, key);
+            if (!cached)
+            {
+                ++state_->Statistics.Misses;
+                auto [pending, inserted] = state_->InFlight.try_emplace(key);
+                pending->second.push_back(PendingRequest{ui.GetReference(), std::move(callback)});
+                if (!inserted)
+                    return;
+
+                source = SelectResampleSourceLocked(*state_, key);
+                filter = state_->Filter;
+            }
+        }
+
+        // Invoked outside the lock so the callback may call back into the cache.
+        if (cached)
+        {
+            callback(std::move(cached), nullptr);
+            return;
+        }
+
+        pool_->Submit([state = state_, pool = pool_, key, source = std::move(source), filter] {
+            std::shared_ptr<const Bitmap> variant;
+            std::exception_ptr failure;
+            try
+            {
+                if (!source)
+                    throw std::invalid_argument("Unknown image id.");
+                variant = StoreVariant(*state, key, ImageResampler::Resample(*source, key.Width, key.Height, filter, pool));
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+
+            std::vector<PendingRequest> requests;
+            {
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                const auto pending = state->InFlight.find(key);
+                requests = std::move(pending->second);
+                state->InFlight.erase(pending);
+            }
+
+            for (PendingRequest& request : requests)
+            {
+                if (!request.Ui.Post([callback = std::move(request.Callback), variant, failure] { callback(variant, failure); }))
+                    WINCORE_LOG_WARNING("An image variant callback was dropped, its UI thread has ended.");
+            }
+        }, Core::TaskPriority::Interactive);
+    }
+
+    void ImageCache::SetMemoryBudget(size_t memoryBudget)
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        state_->MemoryBudget = memoryBudget;
+        EvictLocked(*state_);
+    }
+
+    void ImageCache::ClearVariants()
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        state_->Variants.clear();
+        state_->UsageOrder.clear();
+        state_->Statistics.VariantBytes = 0;
+        state_->Statistics.VariantCount = 0;
+    }
+
+    ImageCacheStatistics ImageCache::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(state_->Mutex);
+        return state_->Statistics;
+    }
+
+    std::shared_ptr<const Bitmap> ImageCache::FindVariantLocked(State& state, const VariantKey& key)
+    {
+        const auto iterator = state.Variants.find(key);
+        if (iterator == state.Variants.end())
+            return nullptr;
+
+        state.UsageOrder.splice(state.UsageOrder.begin(), state.UsageOrder, iterator->second.Usage);
+        ++state.Statistics.Hits;
+        return iterator->second.Pixels;
+    }
+
+    std::shared_ptr<const Bitmap> ImageCache::SelectResampleSourceLocked(const State& state, const VariantKey& key)
+    {
+        const auto source = state.Sources.find(key.Id);
+        if (source == state.Sources.end())
+            return nullptr;
+
+        std::shared_ptr<const Bitmap> best = source->second;
+        for (const auto& [candidateKey, candidate] : state.Variants)
+        {
+            if (candidateKey.Id != key.Id || candidateKey.Width < key.Width * 2ull || candidateKey.Height < key.Height * 2ull)
+                continue;
+
+            if (candidate.Pixels->GetByteSize() < best->GetByteSize())
+                best = candidate.Pixels;
+        }
+        return best;
+    }
+
+    std::shared_ptr<const Bitmap> ImageCache::StoreVariant(State& state, const VariantKey& key, Bitmap pixels)
+    {
+        auto variant = std::make_shared<const Bitmap>(std::move(pixels));
+
+        std::lock_guard<std::mutex> lock(state.Mutex);
+        ++state.Statistics.Resamples;
+        if (!state.Sources.contains(key.Id))
+            return variant;  // Removed while resampling, hand it out without caching.
+
+        const auto existing = state.Variants.find(key);
+        if (existing != state.Variants.end())
+            return existing->second.Pixels;
+
+        state.UsageOrder.push_front(key);
+        state.Variants.emplace(key, Variant{variant, state.UsageOrder.begin()});
+        state.Statistics.VariantBytes += variant->GetByteSize();
+        EvictLocked(state);
+        state.Statistics.VariantCount = state.Variants.size();
+        return variant;
+    }
+
+    void ImageCache::EvictLocked(State& state)
+    {
+        // The most recently used variant always stays so a single oversized request still gets cached.
+        while (state.Statistics.VariantBytes > state.MemoryBudget && state.UsageOrder.size() > 1)
+        {
+            const auto iterator = state.Variants.find(state.UsageOrder.back());
+            state.Statistics.VariantBytes -= iterator->second.Pixels->GetByteSize();
+            state.Variants.erase(iterator);
+            state.UsageOrder.pop_back();
+            ++state.Statistics.Evictions;
+        }
+        state.Statistics.VariantCount = state.Variants.size();
+    }
+
+    void ImageCache::ValidateRequest(uint32_t width, uint32_t height)
+    {
+        if (width == 0 || height == 0)
+            throw std::invalid_argument("The size of an image variant must not be zero.");
+    }
+}
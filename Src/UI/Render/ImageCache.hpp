@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Async.hpp"
+#include "Bitmap.hpp"
+#include "ImageResampler.hpp"
+
+namespace WinCore::UI
+{
+    using ImageId = uint64_t;
+
+    /**
+     * @struct ImageCacheStatistics
+     * @brief Counters describing how well the variant cache is doing.
+     */
+    struct ImageCacheStatistics
+    {
+        uint64_t Hits{0};               //< Lookups served from a cached variant.
+        uint64_t Misses{0};             //< Lookups that had to resample.
+        uint64_t Evictions{0};          //< Variants dropped to stay within the memory budget.
+        uint64_t Resamples{0};          //< Resamples performed, excluding deduplicated requests.
+        size_t VariantBytes{0};         //< Bytes held by cached variants.
+        size_t VariantCount{0};         //< Number of cached variants.
+    };
+
+    /**
+     * @class ImageCache
+     * @brief Holds decoded images and caches resampled variants of them per target size.
+     *
+     * Decoding and resampling run on a ThreadPool, results are delivered on the UI thread
+     * that asked for them. Variants are evicted least recently used first once their total
+     * size exceeds the memory budget. Sources are never evicted, only removed explicitly.
+     * To keep quality and cost in balance a variant is produced from the smallest cached
+     * variant that is at least twice its size, like a mip chain built on demand.
+     */
+    class ImageCache
+    {
+        public:
+            using VariantCallback = std::function<void(std::shared_ptr<const Bitmap>, std::exception_ptr)>;
+            using LoadCallback = std::function<void(ImageId, std::exception_ptr)>;
+
+            /**
+             * Creates a cache.
+             * @param memoryBudget The maximum number of bytes the cached variants may use.
+             * @param pool The pool that decodes and resamples, or nullptr for ThreadPool::Shared().
+             * @param filter The filter used to produce variants.
+             */
+            explicit ImageCache(size_t memoryBudget = 64 * 1024 * 1024, Core::ThreadPool* pool = nullptr,
+                                ResampleFilter filter = ResampleFilter::Lanczos3);
+            ~ImageCache();
+
+            ImageCache(const ImageCache&) = delete;
+            ImageCache& operator=(const ImageCache&) = delete;
+            ImageCache(ImageCache&&) = delete;
+            ImageCache& operator=(ImageCache&&) = delete;
+
+            /**
+             * Converts a logical size to a device size for a monitor DPI, see MonitorDPIScaling.
+             * @param logical The size in 96 DPI units.
+             * @param dpi The DPI of the monitor.
+             * @return The size in device pixels, at least 1.
+             */
+            [[nodiscard]] static uint32_t ScaleForDpi(uint32_t logical, uint32_t dpi) noexcept;
+
+            /**
+             * Registers an already decoded image.
+             * @param bitmap The premultiplied image.
+             * @return The id of the image.
+             * @throws std::invalid_argument If the image is empty.
+             */
+            ImageId AddImage(Bitmap bitmap);
+
+            /**
+             * Reads and decodes an image file on the pool.
+             * @param path The path of a BMP or PPM file.
+             * @param ui The dispatcher the callback runs on. The callback is dropped if it is destroyed first.
+             * @param callback Receives the id of the image, or the exception that made the load fail.
+             */
+            void LoadImageAsync(std::string path, Core::UiDispatcher& ui, LoadCallback callback);
+
+            /**
+             * Removes an image and all of its variants. Bitmaps still referenced by callers stay valid.
+             * @param id The image to remove.
+             */
+            void RemoveImage(ImageId id);
+
+            /**
+             * Returns the decoded source of an image.
+             * @param id The image.
+             * @return The source, or nullptr if the id is unknown.
+             */
+            [[nodiscard]] std::shared_ptr<const Bitmap> GetSource(ImageId id) const;
+
+            /**
+             * Returns a cached variant without resampling. Counts as a use for the LRU order.
+             * @param id The image.
+             * @param width The width in device pixels.
+             * @param height The height in device pixels.
+             * @return The variant, or nullptr if it is not cached.
+             */
+            [[nodiscard]] std::shared_ptr<const Bitmap> TryGetVariant(ImageId id, uint32_t width, uint32_t height);
+
+            /**
+             * Returns a variant, resampling it on the calling thread if it is not cached.
+             * @param id The image.
+             * @param width The width in device pixels.
+             * @param height The height in device pixels.
+             * @return The variant.
+             * @throws std::invalid_argument If the id is unknown or the size is zero.
+             */
+            std::shared_ptr<const Bitmap> GetVariant(ImageId id, uint32_t width, uint32_t height);
+
+            /**
+             * Requests a variant. A cached variant is delivered immediately on the calling thread,
+             * otherwise it is resampled on the pool and delivered through the dispatcher. Concurrent
+             * requests for the same variant share one resample.
+             * @param id The image.
+             * @param width The width in device pixels.
+             * @param height The height in device pixels.
+             * @param ui The dispatcher the callback runs on. The callback is dropped if it is destroyed first.
+             * @param callback Receives the variant, or the exception that made the resample fail.
+             */
+            void RequestVariant(ImageId id, uint32_t width, uint32_t height, Core::UiDispatcher& ui, VariantCallback callback);
+
+            /**
+             * Changes the memory budget, evicting variants if needed.
+             * @param memoryBudget The maximum number of bytes the cached variants may use.
+             */
+            void SetMemoryBudget(size_t memoryBudget);
+
+            /**
+             * Drops every cached variant. Sources are kept.
+             */
+            void ClearVariants();
+
+            /**
+             * Returns a snapshot of the cache counters.
+             */
+            [[nodiscard]] ImageCacheStatistics GetStatistics() const;
+
+        private:
+            struct VariantKey
+            {
+                ImageId Id{0};
+                uint32_t Width{0};
+                uint32_t Height{0};
+
+                bool operator==(const VariantKey&) const = default;
+            };
+
+            struct VariantKeyHash
+            {
+                size_t operator()(const VariantKey& key) const noexcept
+                {
+                    return std::hash<uint64_t>{}(key.Id * 0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(key.Width) << 32 | key.Height));
+                }
+            };
+
+            struct Variant
+            {
+                std::shared_ptr<const Bitmap> Pixels{};
+                std::list<VariantKey>::iterator Usage{};
+            };
+
+            struct PendingRequest
+            {
+                Core::UiDispatcherReference Ui{};       //< The dispatcher may be gone when the resample ends.
+                VariantCallback Callback{};
+            };
+
+            /**
+             * The state shared with jobs still running on the pool, so the cache may die first.
+             */
+            struct State
+            {
+                mutable std::mutex Mutex{};
+                ImageId NextId{1};
+                size_t MemoryBudget{0};
+                ResampleFilter Filter{ResampleFilter::Lanczos3};
+                std::unordered_map<ImageId, std::shared_ptr<const Bitmap>> Sources{};
+                std::unordered_map<VariantKey, Variant, VariantKeyHash> Variants{};
+                std::list<VariantKey> UsageOrder{};     //< Most recently used first.
+                std::unordered_map<VariantKey, std::vector<PendingRequest>, VariantKeyHash> InFlight{};
+                ImageCacheStatistics Statistics{};
+            };
+
+            static std::shared_ptr<const Bitmap> FindVariantLocked(State& state, const VariantKey& key);
+            static std::shared_ptr<const Bitmap> SelectResampleSourceLocked(const State& state, const VariantKey& key);
+            static std::shared_ptr<const Bitmap> StoreVariant(State& state, const VariantKey& key, Bitmap pixels);
+            static void EvictLocked(State& state);
+            static void ValidateRequest(uint32_t width, uint32_t height);
+
+            std::shared_ptr<State> state_;
+            Core::ThreadPool* pool_;
+    };
+}
@@ -0,0 +1,274 @@
+#include "ImageCodec.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace WinCore::UI
+{
+    namespace
+    {
+        constexpr uint32_t BmpFileHeaderSize = 14;
+        constexpr uint32_t BmpInfoHeaderSize = 40;
+        constexpr uint32_t BmpV4HeaderSize = 108;
+        constexpr uint32_t BmpCompressionRgb = 0;
+        constexpr uint32_t BmpCompressionBitfields = 3;
+
+        uint16_t ReadU16(const std::vector<uint8_t>& data, size_t offset)
+        {
+            if (offset + 2 > data.size())
+                throw std::runtime_error("Truncated image data.");
+            return static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+        }
+
+        uint32_t ReadU32(const std::vector<uint8_t>& data, size_t offset)
+        {
+            if (offset + 4 > data.size())
+                throw std::runtime_error("Truncated image data.");
+            return static_cast<uint32_t>(data[offset]) | (static_cast<uint32_t>(data[offset + 1]) << 8) |
+                   (static_cast<uint32_t>(data[offset + 2]) << 16) | (static_cast<uint32_t>(data[offset + 3]) << 24);
+        }
+
+        void WriteU16(std::vector<uint8_t>& data, uint16_t value)
+        {
+            data.push_back(static_cast<uint8_t>(value));
+            data.push_back(static_cast<uint8_t>(value >> 8));
+        }
+
+        void WriteU32(std::vector<uint8_t>& data, uint32_t value)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+                data.push_back(static_cast<uint8_t>(value >> shift));
+        }
+
+        uint8_t Premultiply(uint8_t color, uint8_t alpha)
+        {
+            const uint32_t product = static_cast<uint32_t>(color) * alpha + 128;
+            return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+        }
+
+        /**
+         * Extracts a channel with a BI_BITFIELDS mask and scales it to 8 bits.
+         */
+        uint8_t ExtractChannel(uint32_t pixel, uint32_t mask)
+        {
+            if (mask == 0)
+                return 0;
+
+            uint32_t shift = 0;
+            while (!((mask >> shift) & 1))
+                ++shift;
+
+            // Masks may be up to 32 bits wide, so the scaled value needs 64 bits.
+            const uint64_t maximum = mask >> shift;
+            const uint64_t value = (pixel & mask) >> shift;
+            return static_cast<uint8_t>((value * 255 + maximum / 2) / maximum);
+        }
+
+        /**
+         * Reads the next unsigned integer token of a PPM header, skipping whitespace and comments.
+         */
+        uint32_t ReadPpmNumber(const std::vector<uint8_t>& data, size_t& position)
+        {
+            while (position < data.size())
+            {
+                if (data[position] == '#')
+                {
+                    while (position < data.size() && data[position] != '\n')
+                        ++position;
+                }
+                else if (std::isspace(data[position]))
+                {
+                    ++position;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            if (position >= data.size() || !std::isdigit(data[position]))
+                throw std::runtime_error("Malformed PPM header.");
+
+            uint32_t value = 0;
+            while (position < data.size() && std::isdigit(data[position]))
+            {
+                value = value * 10 + static_cast<uint32_t>(data[position] - '0');
+                if (value > (1u << 24))
+                    throw std::runtime_error("PPM value out of range.");
+                ++position;
+            }
+            return value;
+        }
+    }
+
+    Bitmap ImageCodec::Decode(const std::vector<uint8_t>& data)
+    {
+        if (data.size() >= 2 && data[0] == 'B' && data[1] == 'M')
+            return DecodeBmp(data);
+        if (data.size() >= 2 && data[0] == 'P' && (data[1] == '6' || data[1] == '3'))
+            return DecodePpm(data);
+
+        throw std::runtime_error("Unsupported image format.");
+    }
+
+    Bitmap ImageCodec::DecodeBmp(const std::vector<uint8_t>& data)
+    {
+        if (data.size() < BmpFileHeaderSize + BmpInfoHeaderSize || data[0] != 'B' || data[1] != 'M')
+            throw std::runtime_error("Not a BMP image.");
+
+        const uint32_t pixelOffset = ReadU32(data, 10);
+        const uint32_t headerSize = ReadU32(data, BmpFileHeaderSize);
+        const int32_t width = static_cast<int32_t>(ReadU32(data, BmpFileHeaderSize + 4));
+        const int32_t rawHeight = static_cast<int32_t>(ReadU32(data, BmpFileHeaderSize + 8));
+        const uint16_t bitsPerPixel = ReadU16(data, BmpFileHeaderSize + 14);
+        const uint32_t compression = ReadU32(data, BmpFileHeaderSize + 16);
+
+        if (headerSize < BmpInfoHeaderSize || width <= 0 || rawHeight == 0 || rawHeight == INT32_MIN)
+            throw std::runtime_error("Unsupported BMP header.");
+        if (!(bitsPerPixel == 24 && compression == BmpCompressionRgb) &&
+            !(bitsPerPixel == 32 && (compression == BmpCompressionRgb || compression == BmpCompressionBitfields)))
+            throw std::runtime_error("Only uncompressed 24-bit and 32-bit BMP images are supported.");
+
+        uint32_t redMask = 0x00FF0000;
+        uint32_t greenMask = 0x0000FF00;
+        uint32_t blueMask = 0x000000FF;
+        uint32_t alphaMask = 0;
+        if (bitsPerPixel == 32 && compression == BmpCompressionBitfields)
+        {
+            redMask = ReadU32(data, BmpFileHeaderSize + 40);
+            greenMask = ReadU32(data, BmpFileHeaderSize + 44);
+            blueMask = ReadU32(data, BmpFileHeaderSize + 48);
+            if (headerSize >= BmpV4HeaderSize)
+                alphaMask = ReadU32(data, BmpFileHeaderSize + 52);
+        }
+
+        const bool bottomUp = rawHeight > 0;
+        const uint32_t height = static_cast<uint32_t>(bottomUp ? rawHeight : -rawHeight);
+        const size_t bytesPerPixel = bitsPerPixel / 8;
+        const size_t rowSize = (static_cast<size_t>(width) * bytesPerPixel + 3) & ~size_t{3};
+        if (pixelOffset > data.size() || rowSize * height > data.size() - pixelOffset)
+            throw std::runtime_error("Truncated BMP pixel data.");
+
+        Bitmap bitmap(static_cast<uint32_t>(width), height);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* source = data.data() + pixelOffset + rowSize * (bottomUp ? height - 1 - y : y);
+            uint8_t* destination = bitmap.GetRow(y);
+            for (int32_t x = 0; x < width; ++x, source += bytesPerPixel, destination += 4)
+            {
+                uint8_t blue = source[0];
+                uint8_t green = source[1];
+                uint8_t red = source[2];
+                uint8_t alpha = 255;
+                if (bitsPerPixel == 32)
+                {
+                    uint32_t pixel = 0;
+                    std::memcpy(&pixel, source, sizeof(pixel));
+                    blue = ExtractChannel(pixel, blueMask);
+                    green = ExtractChannel(pixel, greenMask);
+                    red = ExtractChannel(pixel, redMask);
+                    alpha = alphaMask ? ExtractChannel(pixel, alphaMask) : 255;
+                }
+
+                destination[0] = Premultiply(blue, alpha);
+                destination[1] = Premultiply(green, alpha);
+                destination[2] = Premultiply(red, alpha);
+                destination[3] = alpha;
+            }
+        }
+
+        return bitmap;
+    }
+
+    Bitmap ImageCodec::DecodePpm(const std::vector<uint8_t>& data)
+    {
+        if (data.size() < 2 || data[0] != 'P' || (data[1] != '6' && data[1] != '3'))
+            throw std::runtime_error("Not a PPM image.");
+
+        const bool binary = data[1] == '6';
+        size_t position = 2;
+        const uint32_t width = ReadPpmNumber(data, position);
+        const uint32_t height = ReadPpmNumber(data, position);
+        const uint32_t maximum = ReadPpmNumber(data, position);
+        if (width == 0 || height == 0 || maximum == 0 || maximum > 255)
+            throw std::runtime_error("Unsupported PPM header.");
+
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+        if (binary)
+        {
+            ++position;
+            if (position > data.size() || pixelCount * 3 > data.size() - position)
+                throw std::runtime_error("Truncated PPM pixel data.");
+        }
+        else if (pixelCount * 6 > data.size() - position)
+        {
+            // Every ASCII sample takes at least a separator and a digit.
+            throw std::runtime_error("Truncated PPM pixel data.");
+        }
+
+        Bitmap bitmap(width, height);
+        uint8_t* destination = bitmap.Pixels.data();
+        for (size_t index = 0; index < pixelCount; ++index, destination += 4)
+        {
+            uint32_t rgb[3];
+            for (uint32_t& channel : rgb)
+                channel = binary ? data[position++] : ReadPpmNumber(data, position);
+
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                if (rgb[channel] > maximum)
+                    throw std::runtime_error("PPM sample out of range.");
+                destination[2 - channel] = static_cast<uint8_t>((rgb[channel] * 255 + maximum / 2) / maximum);
+            }
+            destination[3] = 255;
+        }
+
+        return bitmap;
+    }
+
+    std::vector<uint8_t> ImageCodec::EncodeBmp(const Bitmap& bitmap)
+    {
+        const uint32_t pixelBytes = static_cast<uint32_t>(bitmap.GetByteSize());
+        const uint32_t pixelOffset = BmpFileHeaderSize + BmpV4HeaderSize;
+
+        std::vector<uint8_t> data;
+        data.reserve(pixelOffset + pixelBytes);
+        data.push_back('B');
+        data.push_back('M');
+        WriteU32(data, pixelOffset + pixelBytes);
+        WriteU32(data, 0);
+        WriteU32(data, pixelOffset);
+
+        WriteU32(data, BmpV4HeaderSize);
+        WriteU32(data, bitmap.Width);
+        WriteU32(data, static_cast<uint32_t>(-static_cast<int32_t>(bitmap.Height)));
+        WriteU16(data, 1);
+        WriteU16(data, 32);
+        WriteU32(data, BmpCompressionBitfields);
+        WriteU32(data, pixelBytes);
+        WriteU32(data, 2835);
+        WriteU32(data, 2835);
+        WriteU32(data, 0);
+        WriteU32(data, 0);
+        WriteU32(data, 0x00FF0000);
+        WriteU32(data, 0x0000FF00);
+        WriteU32(data, 0x000000FF);
+        WriteU32(data, 0xFF000000);
+        WriteU32(data, 0x73524742);  // LCS_sRGB
+        data.resize(pixelOffset, 0);
+
+        for (size_t index = 0; index < bitmap.Pixels.size(); index += 4)
+        {
+            const uint8_t alpha = bitmap.Pixels[index + 3];
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                const uint32_t color = bitmap.Pixels[index + channel];
+                data.push_back(alpha ? static_cast<uint8_t>(std::min<uint32_t>(255, (color * 255 + alpha / 2) / alpha)) : 0);
+            }
+            data.push_back(alpha);
+        }
+
+        return data;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Bitmap.hpp"
+
+namespace WinCore::UI
+{
+    /**
+     * @class ImageCodec
+     * @brief Decodes and encodes the built-in image formats (BMP and binary/ASCII PPM).
+     *
+     * Decoded images are converted to premultiplied BGRA8.
+     */
+    class ImageCodec
+    {
+        private:
+            ImageCodec() = default;
+            ~ImageCodec() = default;
+
+            ImageCodec(const ImageCodec&) = delete;
+            ImageCodec& operator=(const ImageCodec&) = delete;
+            ImageCodec(ImageCodec&&) = delete;
+            ImageCodec& operator=(ImageCodec&&) = delete;
+
+        public:
+            /**
+             * Decodes an image, detecting the format from its signature.
+             * @param data The encoded file contents.
+             * @return The decoded, premultiplied image.
+             * @throws std::runtime_error If the format is unknown or the data is malformed.
+             */
+            static Bitmap Decode(const std::vector<uint8_t>& data);
+
+            /**
+             * Decodes an uncompressed 24-bit or 32-bit BMP image.
+             * @param data The encoded file contents.
+             * @return The decoded, premultiplied image.
+             * @throws std::runtime_error If the data is not a supported BMP image.
+             */
+            static Bitmap DecodeBmp(const std::vector<uint8_t>& data);
+
+            /**
+             * Decodes a P3 or P6 PPM image with a maximum value of up to 255.
+             * @param data The encoded file contents.
+             * @return The decoded, opaque image.
+             * @throws std::runtime_error If the data is not a supported PPM image.
+             */
+            static Bitmap DecodePpm(const std::vector<uint8_t>& data);
+
+            /**
+             * Encodes an image as a top-down 32-bit BMP with straight alpha.
+             * @param bitmap The premultiplied image to encode.
+             * @return The encoded file contents.
+             */
+            static std::vector<uint8_t> EncodeBmp(const Bitmap& bitmap);
+    };
+}
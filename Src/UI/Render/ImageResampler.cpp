@@ -0,0 +1,311 @@
+#include "ImageResampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WINCORE_RESAMPLER_SSE2 1
+#endif
+
+namespace WinCore::UI
+{
+    namespace
+    {
+        constexpr float Pi = 3.14159265358979323846f;
+        constexpr size_t RowsPerChunk = 16;
+
+        struct FilterKernel
+        {
+            float Radius;
+            float (*Evaluate)(float);
+        };
+
+        float EvaluateBox(float x)
+        {
+            return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+        }
+
+        float EvaluateBilinear(float x)
+        {
+            x = std::fabs(x);
+            return x < 1.0f ? 1.0f - x : 0.0f;
+        }
+
+        float Sinc(float x)
+        {
+            if (std::fabs(x) < 1e-6f)
+                return 1.0f;
+            x *= Pi;
+            return std::sin(x) / x;
+        }
+
+        float EvaluateLanczos3(float x)
+        {
+            return std::fabs(x) < 3.0f ? Sinc(x) * Sinc(x / 3.0f) : 0.0f;
+        }
+
+        FilterKernel GetKernel(ResampleFilter filter)
+        {
+            switch (filter)
+            {
+                case ResampleFilter::Box: return FilterKernel{0.5f, &EvaluateBox};
+                case ResampleFilter::Bilinear: return FilterKernel{1.0f, &EvaluateBilinear};
+                case ResampleFilter::Lanczos3: return FilterKernel{3.0f, &EvaluateLanczos3};
+            }
+            return FilterKernel{1.0f, &EvaluateBilinear};
+        }
+
+        /**
+         * The source taps and normalized weights of every output pixel along one axis.
+         * Weights are padded to TapCount per output so the inner loops have a fixed stride.
+         */
+        struct Contributions
+        {
+            std::vector<uint32_t> Start{};
+            std::vector<uint32_t> Count{};
+            std::vector<float> Weights{};
+            uint32_t TapCount{0};
+        };
+
+        Contributions ComputeContributions(uint32_t sourceSize, uint32_t targetSize, const FilterKernel& kernel)
+        {
+            const float scale = static_cast<float>(sourceSize) / static_cast<float>(targetSize);
+            const float filterScale = std::max(1.0f, scale);
+            const float support = kernel.Radius * filterScale;
+
+            Contributions contributions{};
+            contributions.TapCount = static_cast<uint32_t>(std::ceil(support * 2.0f)) + 2;
+            contributions.Start.resize(targetSize);
+            contributions.Count.resize(targetSize);
+            contributions.Weights.assign(static_cast<size_t>(targetSize) * contributions.TapCount, 0.0f);
+
+            for (uint32_t index = 0; index < targetSize; ++index)
+            {
+                const float center = (static_cast<float>(index) + 0.5f) * scale;
+                int64_t left = static_cast<int64_t>(std::floor(center - support));
+                int64_t right = static_cast<int64_t>(std::ceil(center + support));
+                left = std::max<int64_t>(left, 0);
+                right = std::min<int64_t>(right, sourceSize);
+
+                float* weights = contributions.Weights.data() + static_cast<size_t>(index) * contributions.TapCount;
+                float total = 0.0f;
+                uint32_t count = 0;
+                uint32_t first = 0;
+                for (int64_t tap = left; tap < right && count < contributions.TapCount; ++tap)
+                {
+                    const float weight = kernel.Evaluate((static_cast<float>(tap) + 0.5f - center) / filterScale);
+                    if (count == 0 && weight == 0.0f)
+                        continue;
+                    if (count == 0)
+                        first = static_cast<uint32_t>(tap);
+
+                    weights[count++] = weight;
+                    total += weight;
+                }
+
+                while (count > 0 && weights[count - 1] == 0.0f)
+                    --count;
+
+                if (count == 0 || total == 0.0f)
+                {
+                    // Degenerate footprint: fall back to the nearest source pixel.
+                    first = std::min(static_cast<uint32_t>(center), sourceSize - 1);
+                    weights[0] = 1.0f;
+                    count = 1;
+                    total = 1.0f;
+                }
+
+                for (uint32_t tap = 0; tap < count; ++tap)
+                    weights[tap] /= total;
+
+                contributions.Start[index] = first;
+                contributions.Count[index] = count;
+            }
+
+            return contributions;
+        }
+
+        /**
+         * Filters source rows [firstRow, lastRow) horizontally into the float intermediate.
+         */
+        template<bool UseSimd>
+        void FilterRowsHorizontally(const Bitmap& source, const Contributions& columns, uint32_t targetWidth,
+                                    std::vector<float>& intermediate, size_t firstRow, size_t lastRow)
+        {
+            const size_t rowFloats = static_cast<size_t>(targetWidth) * 4;
+            for (size_t y = firstRow; y < lastRow; ++y)
+            {
+                const uint8_t* sourceRow = source.GetRow(static_cast<uint32_t>(y));
+                float* output = intermediate.data() + y * rowFloats;
+                for (uint32_t x = 0; x < targetWidth; ++x, output += 4)
+                {
+                    const uint8_t* pixel = sourceRow + static_cast<size_t>(columns.Start[x]) * 4;
+                    const float* weights = columns.Weights.data() + static_cast<size_t>(x) * columns.TapCount;
+                    const uint32_t count = columns.Count[x];
+#ifdef WINCORE_RESAMPLER_SSE2
+                    if constexpr (UseSimd)
+                    {
+                        const __m128i zero = _mm_setzero_si128();
+                        __m128 accumulator = _mm_setzero_ps();
+                        for (uint32_t tap = 0; tap < count; ++tap, pixel += 4)
+                        {
+                            int32_t packed = 0;
+                            std::memcpy(&packed, pixel, sizeof(packed));
+                            __m128i widened = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+                            widened = _mm_unpacklo_epi16(widened, zero);
+                            accumulator = _mm_add_ps(accumulator, _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(weights[tap])));
+                        }
+                        _mm_storeu_ps(output, accumulator);
+                        continue;
+                    }
+#endif
+                    float accumulator[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                    for (uint32_t tap = 0; tap < count; ++tap, pixel += 4)
+                    {
+                        for (int channel = 0; channel < 4; ++channel)
+                            accumulator[channel] += weights[tap] * static_cast<float>(pixel[channel]);
+                    }
+                    std::memcpy(output, accumulator, sizeof(accumulator));
+                }
+            }
+        }
+
+        /**
+         * Converts one pixel of accumulated floats to BGRA8, keeping colours within alpha.
+         */
+        void StorePixelScalar(const float* values, uint8_t* destination)
+        {
+            const float alpha = std::clamp(values[3], 0.0f, 255.0f);
+            for (int channel = 0; channel < 3; ++channel)
+                destination[channel] = static_cast<uint8_t>(std::clamp(values[channel], 0.0f, alpha) + 0.5f);
+            destination[3] = static_cast<uint8_t>(alpha + 0.5f);
+        }
+
+        /**
+         * Filters the intermediate vertically into target rows [firstRow, lastRow).
+         */
+        template<bool UseSimd>
+        void FilterRowsVertically(const std::vector<float>& intermediate, const Contributions& rows, Bitmap& target,
+                                  size_t firstRow, size_t lastRow)
+        {
+            const size_t rowFloats = static_cast<size_t>(target.Width) * 4;
+            std::vector<float> accumulator(rowFloats);
+            for (size_t y = firstRow; y < lastRow; ++y)
+            {
+                std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+                const float* weights = rows.Weights.data() + y * rows.TapCount;
+                for (uint32_t tap = 0; tap < rows.Count[y]; ++tap)
+                {
+                    const float* sourceRow = intermediate.data() + (static_cast<size_t>(rows.Start[y]) + tap) * rowFloats;
+                    const float weight = weights[tap];
+                    size_t x = 0;
+#if defined(__AVX2__)
+                    if constexpr (UseSimd)
+                    {
+                        const __m256 weight8 = _mm256_set1_ps(weight);
+                        for (; x + 8 <= rowFloats; x += 8)
+                        {
+                            const __m256 sum = _mm256_add_ps(_mm256_loadu_ps(accumulator.data() + x),
+                                                             _mm256_mul_ps(_mm256_loadu_ps(sourceRow + x), weight8));
+                            _mm256_storeu_ps(accumulator.data() + x, sum);
+                        }
+                    }
+#endif
+#ifdef WINCORE_RESAMPLER_SSE2
+                    if constexpr (UseSimd)
+                    {
+                        const __m128 weight4 = _mm_set1_ps(weight);
+                        for (; x + 4 <= rowFloats; x += 4)
+                        {
+                            const __m128 sum = _mm_add_ps(_mm_loadu_ps(accumulator.data() + x), _mm_mul_ps(_mm_loadu_ps(sourceRow + x), weight4));
+                            _mm_storeu_ps(accumulator.data() + x, sum);
+                        }
+                    }
+#endif
+                    for (; x < rowFloats; ++x)
+                        accumulator[x] += sourceRow[x] * weight;
+                }
+
+                uint8_t* destination = target.GetRow(static_cast<uint32_t>(y));
+                size_t x = 0;
+#ifdef WINCORE_RESAMPLER_SSE2
+                if constexpr (UseSimd)
+                {
+                    const __m128 zero = _mm_setzero_ps();
+                    const __m128 maximum = _mm_set1_ps(255.0f);
+                    const __m128 half = _mm_set1_ps(0.5f);
+                    for (; x + 4 <= rowFloats; x += 4)
+                    {
+                        __m128 pixel = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(accumulator.data() + x), zero), maximum);
+                        pixel = _mm_min_ps(pixel, _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3)));
+                        // Round half up like StorePixelScalar, _mm_cvtps_epi32 would round half to even.
+                        __m128i packed = _mm_cvttps_epi32(_mm_add_ps(pixel, half));
+                        packed = _mm_packs_epi32(packed, packed);
+                        packed = _mm_packus_epi16(packed, packed);
+                        const int32_t bytes = _mm_cvtsi128_si32(packed);
+                        std::memcpy(destination + x, &bytes, sizeof(bytes));
+                    }
+                }
+#endif
+                for (; x < rowFloats; x += 4)
+                    StorePixelScalar(accumulator.data() + x, destination + x);
+            }
+        }
+
+        void RunRows(Core::ThreadPool* pool, size_t rowCount, const std::function<void(size_t, size_t)>& body)
+        {
+            if (pool)
+                pool->ParallelFor(0, rowCount, RowsPerChunk, body, Core::TaskPriority::Interactive);
+            else
+                body(0, rowCount);
+        }
+
+        template<bool UseSimd>
+        Bitmap ResampleWith(const Bitmap& source, uint32_t width, uint32_t height, ResampleFilter filter, Core::ThreadPool* pool)
+        {
+            if (source.Width == 0 || source.Height == 0 || source.Pixels.size() < source.GetStride() * source.Height)
+                throw std::invalid_argument("Cannot resample an empty image.");
+            if (width == 0 || height == 0)
+                throw std::invalid_argument("The target size of a resample must not be zero.");
+
+            if (width == source.Width && height == source.Height)
+                return source;
+
+            const FilterKernel kernel = GetKernel(filter);
+            const Contributions columns = ComputeContributions(source.Width, width, kernel);
+            const Contributions rows = ComputeContributions(source.Height, height, kernel);
+
+            std::vector<float> intermediate(static_cast<size_t>(width) * 4 * source.Height);
+            RunRows(pool, source.Height, [&](size_t first, size_t last) {
+                FilterRowsHorizontally<UseSimd>(source, columns, width, intermediate, first, last);
+            });
+
+            Bitmap target(width, height);
+            RunRows(pool, height, [&](size_t first, size_t last) {
+                FilterRowsVertically<UseSimd>(intermediate, rows, target, first, last);
+            });
+
+            return target;
+        }
+    }
+
+    Bitmap ImageResampler::Resample(const Bitmap& source, uint32_t width, uint32_t height, ResampleFilter filter, Core::ThreadPool* pool)
+    {
+        return ResampleWith<true>(source, width, height, filter, pool);
+    }
+
+    Bitmap ImageResampler::ResampleScalar(const Bitmap& source, uint32_t width, uint32_t height, ResampleFilter filter, Core::ThreadPool* pool)
+    {
+        return ResampleWith<false>(source, width, height, filter, pool);
+    }
+}
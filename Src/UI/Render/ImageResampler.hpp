@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Bitmap.hpp"
+
+namespace WinCore::Core
+{
+    class ThreadPool;
+}
+
+namespace WinCore::UI
+{
+    /**
+     * @enum ResampleFilter
+     * @brief The reconstruction filter used when resizing an image.
+     */
+    enum class ResampleFilter : uint8_t
+    {
+        Box = 0,            //< Area average, fastest, fine for integer downscales.
+        Bilinear = 1,       //< Triangle filter, smooth with little ringing.
+        Lanczos3 = 2        //< Windowed sinc with three lobes, sharpest result.
+    };
+
+    /**
+     * @class ImageResampler
+     * @brief Resizes premultiplied BGRA8 images with separable filters.
+     *
+     * The image is filtered horizontally into a float intermediate and then vertically
+     * back to BGRA8. Both passes use SSE2, with a scalar fallback elsewhere. The vertical
+     * pass also has an AVX2 path, which is off by default: it is only compiled in when the
+     * build targets AVX2, e.g. with the WINCORE_ENABLE_AVX2 CMake option, and there is no
+     * runtime dispatch, so such a build requires an AVX2 capable CPU.
+     */
+    class ImageResampler
+    {
+        private:
+            ImageResampler() = default;
+            ~ImageResampler() = default;
+
+            ImageResampler(const ImageResampler&) = delete;
+            ImageResampler& operator=(const ImageResampler&) = delete;
+            ImageResampler(ImageResampler&&) = delete;
+            ImageResampler& operator=(ImageResampler&&) = delete;
+
+        public:
+            /**
+             * Resizes an image.
+             * @param source The premultiplied image to resize.
+             * @param width The width of the result in pixels.
+             * @param height The height of the result in pixels.
+             * @param filter The reconstruction filter.
+             * @param pool The pool to split the rows over, or nullptr to run on the calling thread.
+             * @return The resized, premultiplied image.
+             * @throws std::invalid_argument If the source is empty or the target size is zero.
+             */
+            static Bitmap Resample(const Bitmap& source, uint32_t width, uint32_t height,
+                                   ResampleFilter filter = ResampleFilter::Lanczos3, Core::ThreadPool* pool = nullptr);
+
+            /**
+             * Resizes an image with the portable scalar code, e.g. to check or time the SIMD paths against it.
+             * Produces the same pixels as Resample.
+             * @see Resample
+             */
+            static Bitmap ResampleScalar(const Bitmap& source, uint32_t width, uint32_t height,
+                                         ResampleFilter filter = ResampleFilter::Lanczos3, Core::ThreadPool* pool = nullptr);
+    };
+}
@@ -0,0 +1,248 @@
+#include "LayerCache.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace WinCore::UI
+{
+    namespace
+    {
+        constexpr uint32_t HistoryLength = 32;
+    }
+
+    LayerCache::LayerCache(size_t memoryBudget, LayerPolicy policy) : memoryBudget_(memoryBudget), policy_(policy)
+    {
+    }
+
+    bool LayerCache::Draw(Painter& painter, LayerKey key, const PixelRect& bounds, float opacity, const PaintCallback& paint)
+    {
+        if (bounds.IsEmpty())
+            return false;
+
+        // Node-based map, the reference survives entries added by nested draws.
+        Entry& entry = entries_[key];
+        const bool changed = entry.Dirty || entry.Width != bounds.Width || entry.Height != bounds.Height;
+        entry.History = (entry.History << 1) | (changed ? 1u : 0u);
+        entry.Draws = std::min(entry.Draws + 1, HistoryLength + 1);
+        entry.Dirty = false;
+        entry.Width = bounds.Width;
+        entry.Height = bounds.Height;
+        entry.Parent = paintStack_.empty() ? NoParent : paintStack_.back();
+
+        if (!ShouldCache(entry))
+        {
+            if (entry.Layer)
+            {
+                ReleaseLayer(entry);
+                ++statistics_.Demotions;
+            }
+
+            PaintDirect(painter, key, bounds, opacity, paint);
+            ++statistics_.DirectPaints;
+            return false;
+        }
+
+        if (entry.Layer && !changed)
+        {
+            Touch(entry, key);
+            painter.DrawBitmap(*entry.Layer, bounds.X, bounds.Y, opacity);
+            ++statistics_.Hits;
+            return true;
+        }
+
+        if (entry.Layer && (entry.Layer->Width != static_cast<uint32_t>(bounds.Width) || entry.Layer->Height != static_cast<uint32_t>(bounds.Height)))
+            ReleaseLayer(entry);
+
+        if (!entry.Layer)
+        {
+            // Room is made before painting, a layer evicted right after it was painted would need a second paint.
+            const size_t layerBytes = static_cast<size_t>(bounds.Width) * static_cast<size_t>(bounds.Height) * 4;
+            Evict(layerBytes);
+            if (statistics_.LayerBytes + layerBytes > memoryBudget_)
+            {
+                PaintDirect(painter, key, bounds, opacity, paint);
+                ++statistics_.DirectPaints;
+                return false;
+            }
+
+            entry.Layer = std::make_unique<Bitmap>(static_cast<uint32_t>(bounds.Width), static_cast<uint32_t>(bounds.Height));
+            usageOrder_.push_front(key);
+            entry.Usage = usageOrder_.begin();
+            statistics_.LayerBytes += entry.Layer->GetByteSize();
+            ++statistics_.LayerCount;
+            ++statistics_.Promotions;
+        }
+        else
+        {
+            std::fill(entry.Layer->Pixels.begin(), entry.Layer->Pixels.end(), uint8_t{0});
+            Touch(entry, key);
+        }
+
+        {
+            Painter layerPainter(*entry.Layer);
+            PaintAs(key, layerPainter, paint);
+        }
+        ++statistics_.Misses;
+        painter.DrawBitmap(*entry.Layer, bounds.X, bounds.Y, opacity);
+
+        // Nested draws may have added layers while this one was painted.
+        Evict();
+        return false;
+    }
+
+    void LayerCache::Invalidate(LayerKey key)
+    {
+        // Parent links come from past paints and may be stale, the step limit guards against cycles.
+        auto iterator = entries_.find(key);
+        for (size_t steps = 0; iterator != entries_.end() && steps < entries_.size(); ++steps)
+        {
+            iterator->second.Dirty = true;
+            iterator = entries_.find(iterator->second.Parent);
+        }
+    }
+
+    void LayerCache::SetPromotion(LayerKey key, LayerPromotion promotion)
+    {
+        Entry& entry = entries_[key];
+        entry.Promotion = promotion;
+        if (promotion == LayerPromotion::Never && entry.Layer)
+            ReleaseLayer(entry);
+    }
+
+    void LayerCache::Remove(LayerKey key)
+    {
+        const auto iterator = entries_.find(key);
+        if (iterator == entries_.end())
+            return;
+
+        Invalidate(iterator->second.Parent);
+        if (iterator->second.Layer)
+            ReleaseLayer(iterator->second);
+        entries_.erase(iterator);
+    }
+
+    bool LayerCache::IsCached(LayerKey key) const
+    {
+        const auto iterator = entries_.find(key);
+        return iterator != entries_.end() && iterator->second.Layer != nullptr;
+    }
+
+    void LayerCache::SetMemoryBudget(size_t memoryBudget)
+    {
+        memoryBudget_ = memoryBudget;
+        Evict();
+    }
+
+    void LayerCache::Clear()
+    {
+        for (auto& [key, entry] : entries_)
+        {
+            if (entry.Layer && !IsBeingPainted(key))
+                ReleaseLayer(entry);
+        }
+    }
+
+    bool LayerCache::ShouldCache(const Entry& entry) const noexcept
+    {
+        const size_t bytes = static_cast<size_t>(entry.Width) * static_cast<size_t>(entry.Height) * 4;
+        if (entry.Promotion == LayerPromotion::Never || bytes > memoryBudget_)
+            return false;
+        if (entry.Promotion == LayerPromotion::Always)
+            return true;
+
+        if (static_cast<uint64_t>(entry.Width) * static_cast<uint64_t>(entry.Height) < policy_.MinArea)
+            return false;
+
+        // The first draw always counts as a change, it is not held against the subtree. Draws only goes past
+        // HistoryLength once that draw has been shifted out.
+        const uint32_t recent = entry.Draws <= HistoryLength ? entry.History & ((1u << (entry.Draws - 1)) - 1) : entry.History;
+        const uint32_t repaints = static_cast<uint32_t>(std::popcount(recent));
+        if (entry.Layer)
+            return repaints <= policy_.MaxRepaints;
+        return entry.Draws >= policy_.MinDraws && repaints <= policy_.MaxRepaints;
+    }
+
+    bool LayerCache::IsBeingPainted(LayerKey key) const noexcept
+    {
+        return std::find(paintStack_.begin(), paintStack_.end(), key) != paintStack_.end();
+    }
+
+    void LayerCache::Touch(Entry& entry, LayerKey key)
+    {
+        usageOrder_.erase(entry.Usage);
+        usageOrder_.push_front(key);
+        entry.Usage = usageOrder_.begin();
+    }
+
+    void LayerCache::ReleaseLayer(Entry& entry)
+    {
+        statistics_.LayerBytes -= entry.Layer->GetByteSize();
+        --statistics_.LayerCount;
+        usageOrder_.erase(entry.Usage);
+        entry.Layer.reset();
+    }
+
+    void LayerCache::Evict(size_t reserve)
+    {
+        // Layers whose paint callbacks are still running are skipped, something is painting into them.
+        auto iterator = usageOrder_.end();
+        while (statistics_.LayerBytes + reserve > memoryBudget_ && iterator != usageOrder_.begin())
+        {
+            --iterator;
+            const LayerKey key = *iterator;
+            if (IsBeingPainted(key))
+                continue;
+
+            Entry& entry = entries_.at(key);
+            iterator = std::next(iterator);
+            ReleaseLayer(entry);
+            ++statistics_.Evictions;
+        }
+    }
+
+    void LayerCache::PaintAs(LayerKey key, Painter& painter, const PaintCallback& paint)
+    {
+        paintStack_.push_back(key);
+        try
+        {
+            paint(painter);
+        }
+        catch (...)
+        {
+            paintStack_.pop_back();
+            throw;
+        }
+        paintStack_.pop_back();
+    }
+
+    void LayerCache::PaintDirect(Painter& painter, LayerKey key, const PixelRect& bounds, float opacity, const PaintCallback& paint)
+    {
+        // Subtrees painted from here become children of key even without a layer, so invalidating them marks
+        // key as changed and the repaint history keeps it from being promoted while its children animate.
+        if (opacity >= 1.0f)
+        {
+            painter.Save();
+            painter.Translate(bounds.X, bounds.Y);
+            painter.ClipRect(PixelRect{0, 0, bounds.Width, bounds.Height});
+            try
+            {
+                PaintAs(key, painter, paint);
+            }
+            catch (...)
+            {
+                painter.Restore();
+                throw;
+            }
+            painter.Restore();
+            return;
+        }
+
+        // Translucent subtrees need a transient layer, blending each primitive would let overlaps show through.
+        Bitmap transient(static_cast<uint32_t>(bounds.Width), static_cast<uint32_t>(bounds.Height));
+        {
+            Painter transientPainter(transient);
+            PaintAs(key, transientPainter, paint);
+        }
+        painter.DrawBitmap(transient, bounds.X, bounds.Y, opacity);
+    }
+}
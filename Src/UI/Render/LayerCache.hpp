@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Bitmap.hpp"
+#include "Painter.hpp"
+
+namespace WinCore::UI
+{
+    using LayerKey = uint64_t;
+
+    /**
+     * @enum LayerPromotion
+     * @brief Whether a subtree is painted into a cached layer.
+     */
+    enum class LayerPromotion : uint8_t
+    {
+        Auto = 0,   //< Cached once it repaints rarely, see LayerPolicy.
+        Always = 1, //< Always cached, as long as it fits the memory budget.
+        Never = 2   //< Always painted directly.
+    };
+
+    /**
+     * @struct LayerPolicy
+     * @brief The repaint-frequency heuristic used for LayerPromotion::Auto.
+     */
+    struct LayerPolicy
+    {
+        uint32_t MinDraws{8};           //< Draws observed before a subtree may be promoted.
+        uint32_t MaxRepaints{2};        //< Content changes tolerated within the last 32 draws, more demote the layer.
+        uint64_t MinArea{64 * 64};      //< Smaller subtrees are cheaper to repaint than to composite.
+    };
+
+    /**
+     * @struct LayerCacheStatistics
+     * @brief Counters describing how well the layer cache is doing.
+     */
+    struct LayerCacheStatistics
+    {
+        uint64_t Hits{0};               //< Draws composited from an up-to-date layer.
+        uint64_t Misses{0};             //< Draws that painted the subtree into its layer first.
+        uint64_t DirectPaints{0};       //< Draws of subtrees without a layer.
+        uint64_t Promotions{0};         //< Layers created.
+        uint64_t Demotions{0};          //< Layers dropped because their subtree repainted too often.
+        uint64_t Evictions{0};          //< Layers dropped to stay within the memory budget.
+        size_t LayerBytes{0};           //< Bytes held by layers.
+        size_t LayerCount{0};           //< Number of layers.
+    };
+
+    /**
+     * @class LayerCache
+     * @brief Caches the rendering of widget subtrees in off-screen bitmaps.
+     *
+     * A widget paints a subtree through Draw(). If the subtree has an up-to-date layer, the
+     * layer is composited with the requested translation and opacity and the paint callback
+     * is skipped. Otherwise the callback paints into the layer, or straight into the target
+     * when the subtree is not promoted. Subtrees drawn from inside a paint callback become
+     * children of the layer being painted, so invalidating a child also invalidates every
+     * cached ancestor. Layers are evicted least recently used first once their total size
+     * exceeds the memory budget. Not thread-safe, use it on the thread that paints.
+     */
+    class LayerCache
+    {
+        public:
+            using PaintCallback = std::function<void(Painter&)>;
+
+            /**
+             * Creates a cache.
+             * @param memoryBudget The maximum number of bytes the layers may use.
+             * @param policy The heuristic used for LayerPromotion::Auto.
+             */
+            explicit LayerCache(size_t memoryBudget = 32 * 1024 * 1024, LayerPolicy policy = {});
+            ~LayerCache() = default;
+
+            LayerCache(const LayerCache&) = delete;
+            LayerCache& operator=(const LayerCache&) = delete;
+            LayerCache(LayerCache&&) = delete;
+            LayerCache& operator=(LayerCache&&) = delete;
+
+            /**
+             * Draws a subtree, from its layer when possible.
+             * @param painter The painter of the target.
+             * @param key A stable key of the subtree, e.g. the id of its root widget.
+             * @param bounds The rectangle the subtree occupies, in the painter's local coordinates.
+             * @param opacity The opacity the subtree is composited with.
+             * @param paint Paints the subtree with its origin at the top left of bounds.
+             * @return True if the subtree was composited from its layer without painting.
+             */
+            bool Draw(Painter& painter, LayerKey key, const PixelRect& bounds, float opacity, const PaintCallback& paint);
+
+            /**
+             * Marks the content of a subtree and of every cached ancestor as changed.
+             * @param key The subtree, ignored if it was never drawn.
+             */
+            void Invalidate(LayerKey key);
+
+            /**
+             * Chooses how a subtree is cached. Dropping to Never releases its layer.
+             * @param key The subtree.
+             * @param promotion The promotion mode.
+             */
+            void SetPromotion(LayerKey key, LayerPromotion promotion);
+
+            /**
+             * Forgets a subtree and releases its layer, e.g. when its widget is destroyed.
+             * Must not be called from the subtree's own paint callback.
+             * @param key The subtree.
+             */
+            void Remove(LayerKey key);
+
+            /**
+             * Checks whether a subtree currently has a layer.
+             */
+            [[nodiscard]] bool IsCached(LayerKey key) const;
+
+            /**
+             * Changes the memory budget, evicting layers if needed.
+             * @param memoryBudget The maximum number of bytes the layers may use.
+             */
+            void SetMemoryBudget(size_t memoryBudget);
+
+            /**
+             * Releases every layer. The repaint history of the subtrees is kept.
+             */
+            void Clear();
+
+            /**
+             * Returns the counters of the cache.
+             */
+            [[nodiscard]] const LayerCacheStatistics& GetStatistics() const noexcept { return statistics_; }
+
+        private:
+            static constexpr LayerKey NoParent = ~LayerKey{0};
+
+            struct Entry
+            {
+                std::unique_ptr<Bitmap> Layer{};
+                std::list<LayerKey>::iterator Usage{};  //< Valid while Layer is set.
+                LayerKey Parent{NoParent};              //< The layer the subtree was last painted into.
+                LayerPromotion Promotion{LayerPromotion::Auto};
+                uint32_t History{0};                    //< One bit per recent draw, set when the content had changed.
+                uint32_t Draws{0};                      //< Saturates at 33, one past the history length.
+                int32_t Width{0};
+                int32_t Height{0};
+                bool Dirty{true};
+            };
+
+            [[nodiscard]] bool ShouldCache(const Entry& entry) const noexcept;
+            [[nodiscard]] bool IsBeingPainted(LayerKey key) const noexcept;
+            void Touch(Entry& entry, LayerKey key);
+            void ReleaseLayer(Entry& entry);
+            void Evict(size_t reserve = 0);
+            void PaintAs(LayerKey key, Painter& painter, const PaintCallback& paint);
+            void PaintDirect(Painter& painter, LayerKey key, const PixelRect& bounds, float opacity, const PaintCallback& paint);
+
+            size_t memoryBudget_;
+            LayerPolicy policy_;
+            std::unordered_map<LayerKey, Entry> entries_{};
+            std::list<LayerKey> usageOrder_{};          //< Cached subtrees, most recently used first.
+            std::vector<LayerKey> paintStack_{};        //< The layers whose paint callbacks are running.
+            LayerCacheStatistics statistics_{};
+    };
+}
@@ -0,0 +1,170 @@
+#include "Painter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WINCORE_PAINTER_SSE2 1
+#endif
+
+namespace WinCore::UI
+{
+    namespace
+    {
+        constexpr uint32_t FullOpacity = 256;
+
+        uint32_t DivideBy255(uint32_t value) noexcept
+        {
+            value += 128;
+            return (value + (value >> 8)) >> 8;
+        }
+
+        /**
+         * Blends count premultiplied pixels over dst, scaling the source by opacity / 256 first.
+         * The SSE2 and scalar paths produce identical results.
+         */
+        void BlendRow(uint8_t* dst, const uint8_t* src, size_t count, uint32_t opacity) noexcept
+        {
+            size_t index = 0;
+#if defined(WINCORE_PAINTER_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i opacityFactor = _mm_set1_epi16(static_cast<short>(opacity));
+            const __m128i max = _mm_set1_epi16(255);
+            const __m128i half = _mm_set1_epi16(128);
+
+            const auto blendHalf = [&](__m128i source, __m128i destination)
+            {
+                if (opacity != FullOpacity)
+                    source = _mm_srli_epi16(_mm_mullo_epi16(source, opacityFactor), 8);
+
+                const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xFF), 0xFF);
+                __m128i scaled = _mm_add_epi16(_mm_mullo_epi16(destination, _mm_sub_epi16(max, alpha)), half);
+                scaled = _mm_srli_epi16(_mm_add_epi16(scaled, _mm_srli_epi16(scaled, 8)), 8);
+                return _mm_add_epi16(source, scaled);
+            };
+
+            for (; index + 4 <= count; index += 4)
+            {
+                const __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index * 4));
+                const __m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + index * 4));
+                const __m128i low = blendHalf(_mm_unpacklo_epi8(source, zero), _mm_unpacklo_epi8(destination, zero));
+                const __m128i high = blendHalf(_mm_unpackhi_epi8(source, zero), _mm_unpackhi_epi8(destination, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index * 4), _mm_packus_epi16(low, high));
+            }
+#endif
+            for (; index < count; ++index)
+            {
+                const uint8_t* source = src + index * 4;
+                uint8_t* destination = dst + index * 4;
+
+                uint32_t scaled[4];
+                for (size_t channel = 0; channel < 4; ++channel)
+                    scaled[channel] = opacity == FullOpacity ? source[channel] : (source[channel] * opacity) >> 8;
+
+                const uint32_t inverse = 255 - scaled[3];
+                for (size_t channel = 0; channel < 4; ++channel)
+                    destination[channel] = static_cast<uint8_t>(std::min<uint32_t>(255, scaled[channel] + DivideBy255(destination[channel] * inverse)));
+            }
+        }
+
+        void FillRow(uint8_t* dst, Color color, size_t count) noexcept
+        {
+            for (size_t index = 0; index < count; ++index)
+                std::memcpy(dst + index * 4, &color, 4);
+        }
+    }
+
+    PixelRect PixelRect::Intersect(const PixelRect& other) const noexcept
+    {
+        const int32_t left = std::max(X, other.X);
+        const int32_t top = std::max(Y, other.Y);
+        const int32_t right = std::min(X + Width, other.X + other.Width);
+        const int32_t bottom = std::min(Y + Height, other.Y + other.Height);
+        if (right <= left || bottom <= top)
+            return PixelRect{left, top, 0, 0};
+        return PixelRect{left, top, right - left, bottom - top};
+    }
+
+    Painter::Painter(Bitmap& target) : target_(target)
+    {
+        state_.Clip = PixelRect{0, 0, static_cast<int32_t>(target.Width), static_cast<int32_t>(target.Height)};
+    }
+
+    void Painter::Save()
+    {
+        saved_.push_back(state_);
+    }
+
+    void Painter::Restore()
+    {
+        if (saved_.empty())
+            return;
+
+        state_ = saved_.back();
+        saved_.pop_back();
+    }
+
+    void Painter::Translate(int32_t dx, int32_t dy) noexcept
+    {
+        state_.OffsetX += dx;
+        state_.OffsetY += dy;
+    }
+
+    void Painter::ClipRect(const PixelRect& rect) noexcept
+    {
+        state_.Clip = state_.Clip.Intersect(PixelRect{rect.X + state_.OffsetX, rect.Y + state_.OffsetY, rect.Width, rect.Height});
+    }
+
+    void Painter::Clear(Color color)
+    {
+        const PixelRect& clip = state_.Clip;
+        if (clip.IsEmpty())
+            return;
+
+        for (int32_t y = clip.Y; y < clip.Y + clip.Height; ++y)
+            FillRow(target_.GetRow(static_cast<uint32_t>(y)) + static_cast<size_t>(clip.X) * 4, color, static_cast<size_t>(clip.Width));
+    }
+
+    void Painter::FillRect(const PixelRect& rect, Color color)
+    {
+        const PixelRect area = state_.Clip.Intersect(PixelRect{rect.X + state_.OffsetX, rect.Y + state_.OffsetY, rect.Width, rect.Height});
+        if (area.IsEmpty() || color.A == 0)
+            return;
+
+        const size_t width = static_cast<size_t>(area.Width);
+        if (color.A == 255)
+        {
+            for (int32_t y = area.Y; y < area.Y + area.Height; ++y)
+                FillRow(target_.GetRow(static_cast<uint32_t>(y)) + static_cast<size_t>(area.X) * 4, color, width);
+            return;
+        }
+
+        std::vector<uint8_t> row(width * 4);
+        FillRow(row.data(), color, width);
+        for (int32_t y = area.Y; y < area.Y + area.Height; ++y)
+            BlendRow(target_.GetRow(static_cast<uint32_t>(y)) + static_cast<size_t>(area.X) * 4, row.data(), width, FullOpacity);
+    }
+
+    void Painter::DrawBitmap(const Bitmap& bitmap, int32_t x, int32_t y, float opacity)
+    {
+        const uint32_t factor = static_cast<uint32_t>(std::lround(std::clamp(opacity, 0.0f, 1.0f) * FullOpacity));
+        if (factor == 0 || bitmap.Width == 0 || bitmap.Height == 0)
+            return;
+
+        const int32_t left = x + state_.OffsetX;
+        const int32_t top = y + state_.OffsetY;
+        const PixelRect area = state_.Clip.Intersect(PixelRect{left, top, static_cast<int32_t>(bitmap.Width), static_cast<int32_t>(bitmap.Height)});
+        if (area.IsEmpty())
+            return;
+
+        const size_t sourceX = static_cast<size_t>(area.X - left);
+        for (int32_t row = 0; row < area.Height; ++row)
+        {
+            const uint8_t* source = bitmap.GetRow(static_cast<uint32_t>(area.Y - top + row)) + sourceX * 4;
+            uint8_t* destination = target_.GetRow(static_cast<uint32_t>(area.Y + row)) + static_cast<size_t>(area.X) * 4;
+            BlendRow(destination, source, static_cast<size_t>(area.Width), factor);
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Bitmap.hpp"
+
+namespace WinCore::UI
+{
+    /**
+     * @struct Color
+     * @brief A premultiplied BGRA8 colour, laid out like a Bitmap pixel.
+     */
+    struct Color
+    {
+        uint8_t B{0};
+        uint8_t G{0};
+        uint8_t R{0};
+        uint8_t A{0};
+
+        /**
+         * Creates a colour from straight (not premultiplied) components.
+         */
+        [[nodiscard]] static constexpr Color FromRgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) noexcept
+        {
+            return Color{static_cast<uint8_t>((b * a + 127) / 255), static_cast<uint8_t>((g * a + 127) / 255),
+                         static_cast<uint8_t>((r * a + 127) / 255), a};
+        }
+
+        bool operator==(const Color&) const = default;
+    };
+
+    /**
+     * @struct PixelRect
+     * @brief An axis-aligned rectangle in pixels.
+     */
+    struct PixelRect
+    {
+        int32_t X{0};
+        int32_t Y{0};
+        int32_t Width{0};
+        int32_t Height{0};
+
+        [[nodiscard]] bool IsEmpty() const noexcept { return Width <= 0 || Height <= 0; }
+
+        /**
+         * Returns the overlap of two rectangles, empty if they do not overlap.
+         */
+        [[nodiscard]] PixelRect Intersect(const PixelRect& other) const noexcept;
+
+        bool operator==(const PixelRect&) const = default;
+    };
+
+    /**
+     * @class Painter
+     * @brief The software drawing backend, paints into a Bitmap with source-over blending.
+     *
+     * Coordinates are device pixels relative to the current translation and drawing is
+     * limited to the current clip. Save() and Restore() bracket changes to both, so a widget
+     * can paint its children in local coordinates. Blending of whole bitmaps uses SSE2 when
+     * the build targets it.
+     */
+    class Painter
+    {
+        public:
+            /**
+             * Creates a painter for a bitmap, clipped to its bounds.
+             * @param target The bitmap to paint into, must outlive the painter.
+             */
+            explicit Painter(Bitmap& target);
+            ~Painter() = default;
+
+            Painter(const Painter&) = delete;
+            Painter& operator=(const Painter&) = delete;
+            Painter(Painter&&) = delete;
+            Painter& operator=(Painter&&) = delete;
+
+            /**
+             * Pushes the current translation and clip.
+             */
+            void Save();
+
+            /**
+             * Pops the translation and clip pushed by the matching Save(). Ignored without one.
+             */
+            void Restore();
+
+            /**
+             * Moves the origin of subsequent drawing.
+             * @param dx The horizontal offset in pixels.
+             * @param dy The vertical offset in pixels.
+             */
+            void Translate(int32_t dx, int32_t dy) noexcept;
+
+            /**
+             * Narrows the clip to a rectangle in local coordinates.
+             * @param rect The rectangle.
+             */
+            void ClipRect(const PixelRect& rect) noexcept;
+
+            /**
+             * Replaces every pixel inside the clip with a colour, without blending.
+             * @param color The colour.
+             */
+            void Clear(Color color);
+
+            /**
+             * Blends a solid rectangle over the target.
+             * @param rect The rectangle in local coordinates.
+             * @param color The colour.
+             */
+            void FillRect(const PixelRect& rect, Color color);
+
+            /**
+             * Blends a bitmap over the target.
+             * @param bitmap The premultiplied source.
+             * @param x The left edge in local coordinates.
+             * @param y The top edge in local coordinates.
+             * @param opacity A multiplier applied to the whole bitmap, clamped to [0, 1].
+             */
+            void DrawBitmap(const Bitmap& bitmap, int32_t x, int32_t y, float opacity = 1.0f);
+
+            /**
+             * Returns the bitmap painted into.
+             */
+            [[nodiscard]] Bitmap& GetTarget() noexcept { return target_; }
+
+            /**
+             * Returns the current clip in target pixels.
+             */
+            [[nodiscard]] const PixelRect& GetDeviceClip() const noexcept { return state_.Clip; }
+
+            /**
+             * Returns the current translation.
+             */
+            [[nodiscard]] int32_t GetOffsetX() const noexcept { return state_.OffsetX; }
+            [[nodiscard]] int32_t GetOffsetY() const noexcept { return state_.OffsetY; }
+
+        private:
+            struct State
+            {
+                int32_t OffsetX{0};
+                int32_t OffsetY{0};
+                PixelRect Clip{};   //< In target pixels.
+            };
+
+            Bitmap& target_;
+            State state_{};
+            std::vector<State> saved_{};
+    };
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <Windows.h>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
 namespace WinCore::Utils
@@ -26,15 +28,23 @@ namespace WinCore::Utils
              */
             static std::string ToUTF8(const std::wstring& wideString)
             {
-                if (wideString.empty())
-                    return std::string();
-
-                int size_needed = WideCharToMultiByte(CP_UTF8, 0, wideString.c_str(), static_cast<int>(wideString.size()), nullptr, 0, nullptr, nullptr);
-                if (size_needed <= 0)
-                    throw std::runtime_error("Failed to convert wide string to UTF-8.");
+                std::string utf8String;
+                ConvertToUTF8(wideString, utf8String);
+                return utf8String;
+            }
 
-                std::string utf8String(size_needed, '\0');
-                WideCharToMultiByte(CP_UTF8, 0, wideString.c_str(), static_cast<int>(wideString.size()), &utf8String[0], size_needed, nullptr, nullptr);
+            /**
+             * Converts a wide Unicode string to a UTF-8 encoded string allocated from a memory resource,
+             * e.g. FrameArena::For(MemorySubsystem::Text) for strings that only live during a frame.
+             * @param wideString The wide string to be converted.
+             * @param resource The memory resource the result is allocated from.
+             * @return A UTF-8 encoded string that represents the input wide string.
+             * @throws std::runtime_error If the conversion fails.
+             */
+            static std::pmr::string ToUTF8(std::wstring_view wideString, std::pmr::memory_resource* resource)
+            {
+                std::pmr::string utf8String(resource);
+                ConvertToUTF8(wideString, utf8String);
                 return utf8String;
             }
 
@@ -45,17 +55,53 @@ namespace WinCore::Utils
              * @throws std::runtime_error If the conversion fails.
              */
             static std::wstring ToWString(const std::string& utf8String)
+            {
+                std::wstring wideString;
+                ConvertToWString(utf8String, wideString);
+                return wideString;
+            }
+
+            /**
+             * Converts a UTF-8 encoded string to a wide Unicode string allocated from a memory resource.
+             * @param utf8String The UTF-8 encoded string to be converted.
+             * @param resource The memory resource the result is allocated from.
+             * @return A wide Unicode string that represents the input UTF-8 encoded string.
+             * @throws std::runtime_error If the conversion fails.
+             */
+            static std::pmr::wstring ToWString(std::string_view utf8String, std::pmr::memory_resource* resource)
+            {
+                std::pmr::wstring wideString(resource);
+                ConvertToWString(utf8String, wideString);
+                return wideString;
+            }
+
+        private:
+            template<typename StringT>
+            static void ConvertToUTF8(std::wstring_view wideString, StringT& utf8String)
+            {
+                if (wideString.empty())
+                    return;
+
+                int size_needed = WideCharToMultiByte(CP_UTF8, 0, wideString.data(), static_cast<int>(wideString.size()), nullptr, 0, nullptr, nullptr);
+                if (size_needed <= 0)
+                    throw std::runtime_error("Failed to convert wide string to UTF-8.");
+
+                utf8String.resize(size_needed);
+                WideCharToMultiByte(CP_UTF8, 0, wideString.data(), static_cast<int>(wideString.size()), &utf8String[0], size_needed, nullptr, nullptr);
+            }
+
+            template<typename StringT>
+            static void ConvertToWString(std::string_view utf8String, StringT& wideString)
             {
                 if (utf8String.empty())
-                    return std::wstring();
+                    return;
 
-                int size_needed = MultiByteToWideChar(CP_UTF8, 0, utf8String.c_str(), static_cast<int>(utf8String.size()), nullptr, 0);
+                int size_needed = MultiByteToWideChar(CP_UTF8, 0, utf8String.data(), static_cast<int>(utf8String.size()), nullptr, 0);
                 if (size_needed <= 0)
                     throw std::runtime_error("Failed to convert UTF-8 string to wide string.");
 
-                std::wstring wideString(size_needed, L'\0');
-                MultiByteToWideChar(CP_UTF8, 0, utf8String.c_str(), static_cast<int>(utf8String.size()), &wideString[0], size_needed);
-                return wideString;
+                wideString.resize(size_needed);
+                MultiByteToWideChar(CP_UTF8, 0, utf8String.data(), static_cast<int>(utf8String.size()), &wideString[0], size_needed);
             }
     };
 } 
\ No newline at end of file
@@ -0,0 +1,788 @@
+#include "DebugLogger.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include "Convertor.hpp"
+#endif
+
+namespace WinCore::Utils
+{
+    namespace
+    {
+        constexpr char BinaryLogMagic[8] = {'W', 'C', 'B', 'L', 'O', 'G', '0', '1'};
+        constexpr uint8_t BinaryLogSiteRecord = 1;
+        constexpr uint8_t BinaryLogEntryRecord = 2;
+
+        struct SiteInfo
+        {
+            LogLevel Level{LogLevel::Info};
+            std::string File{};
+            uint32_t Line{0};
+            std::string Format{};
+        };
+
+        struct LoggerState
+        {
+            DebugLoggerSettings Settings{};
+            std::atomic<bool> Running{false};
+            std::atomic<uint32_t> Generation{0};
+            std::atomic<uint32_t> NextThreadIndex{0};
+            std::atomic<uint64_t> Dropped{0};
+            std::atomic<bool> WakePending{false};
+            std::atomic<int64_t> StartTicks{0};     //< steady_clock ticks at Start, read by logging threads through Now().
+            uint64_t StartEpochNanoseconds{0};
+
+            std::mutex BuffersMutex{};
+            std::vector<std::shared_ptr<Detail::LogRingBuffer>> Buffers{};
+
+            std::mutex SitesMutex{};
+            std::vector<SiteInfo> Sites{};
+
+            std::mutex DrainMutex{};
+            std::vector<bool> SitesWritten{};
+            std::vector<uint8_t> Scratch{};
+            std::string Batch{};
+            FILE* TextFile{nullptr};
+            FILE* BinaryFile{nullptr};
+
+            std::mutex WakeMutex{};
+            std::condition_variable WakeCondition{};
+            std::condition_variable FlushCondition{};
+            uint64_t FlushRequested{0};
+            uint64_t FlushCompleted{0};
+            bool StopRequested{false};
+            std::thread Worker{};
+        };
+
+        LoggerState& GetState()
+        {
+            static LoggerState state{};
+            return state;
+        }
+
+        /**
+         * Owns the calling thread's buffer and retires it when the thread exits.
+         */
+        struct ThreadBufferHolder
+        {
+            std::shared_ptr<Detail::LogRingBuffer> Buffer{};
+            uint32_t Generation{0};
+
+            ~ThreadBufferHolder()
+            {
+                if (Buffer)
+                    Buffer->Retire();
+            }
+        };
+
+        thread_local ThreadBufferHolder t_threadBuffer{};
+
+        size_t RoundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 1024;
+            while (result < value)
+                result <<= 1;
+            return result;
+        }
+
+        const char* GetLevelName(LogLevel level)
+        {
+            switch (level)
+            {
+                case LogLevel::Trace: return "TRACE";
+                case LogLevel::Debug: return "DEBUG";
+                case LogLevel::Info: return "INFO ";
+                case LogLevel::Warning: return "WARN ";
+                case LogLevel::Error: return "ERROR";
+                case LogLevel::Fatal: return "FATAL";
+            }
+            return "?????";
+        }
+
+        void AppendCodePoint(std::string& out, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                out.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        /**
+         * Reads the encoded arguments of a record one at a time.
+         */
+        class ArgReader
+        {
+            public:
+                ArgReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+                bool AppendNext(std::string& out)
+                {
+                    if (position_ >= size_)
+                        return false;
+
+                    const auto type = static_cast<Detail::LogArgType>(data_[position_++]);
+                    switch (type)
+                    {
+                        case Detail::LogArgType::Bool:
+                            out += Take<uint8_t>() ? "true" : "false";
+                            return true;
+                        case Detail::LogArgType::Char:
+                            out.push_back(static_cast<char>(Take<uint8_t>()));
+                            return true;
+                        case Detail::LogArgType::Int64:
+                            out += std::to_string(Take<int64_t>());
+                            return true;
+                        case Detail::LogArgType::UInt64:
+                            out += std::to_string(Take<uint64_t>());
+                            return true;
+                        case Detail::LogArgType::Double:
+                        {
+                            char text[32];
+                            std::snprintf(text, sizeof(text), "%g", Take<double>());
+                            out += text;
+                            return true;
+                        }
+                        case Detail::LogArgType::Pointer:
+                        {
+                            char text[32];
+                            std::snprintf(text, sizeof(text), "0x%016llx", static_cast<unsigned long long>(Take<uint64_t>()));
+                            out += text;
+                            return true;
+                        }
+                        case Detail::LogArgType::String:
+                        {
+                            const uint32_t length = Take<uint32_t>();
+                            Require(length);
+                            out.append(reinterpret_cast<const char*>(data_ + position_), length);
+                            position_ += length;
+                            return true;
+                        }
+                        case Detail::LogArgType::WString:
+                        {
+                            const uint32_t length = Take<uint32_t>();
+                            for (uint32_t i = 0; i < length; ++i)
+                            {
+                                uint32_t unit = Take<uint32_t>();
+                                if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < length)
+                                {
+                                    const uint32_t low = Take<uint32_t>();
+                                    unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                                    ++i;
+                                }
+                                AppendCodePoint(out, unit);
+                            }
+                            return true;
+                        }
+                    }
+
+                    throw std::runtime_error("Malformed log record argument.");
+                }
+
+            private:
+                void Require(size_t size) const
+                {
+                    if (size_ - position_ < size)
+                        throw std::runtime_error("Truncated log record argument.");
+                }
+
+                template<typename T>
+                T Take()
+                {
+                    Require(sizeof(T));
+                    T value{};
+                    std::memcpy(&value, data_ + position_, sizeof(T));
+                    position_ += sizeof(T);
+                    return value;
+                }
+
+                const uint8_t* data_;       //< The encoded arguments.
+                size_t size_;               //< The size of the encoded arguments.
+                size_t position_{0};        //< The read position.
+        };
+
+        /**
+         * Formats a single record as a line of text and appends it to the output.
+         */
+        void FormatRecord(std::string& out, const SiteInfo& site, uint32_t threadIndex, uint64_t timestamp, const uint8_t* args, size_t argsSize)
+        {
+            const char* file = site.File.c_str();
+            for (const char* cursor = file; *cursor; ++cursor)
+            {
+                if (*cursor == '/' || *cursor == '\\')
+                    file = cursor + 1;
+            }
+
+            char prefix[160];
+            std::snprintf(prefix, sizeof(prefix), "[%12.6f] [%s] [T%u] %s(%u): ",
+                          static_cast<double>(timestamp) / 1e9, GetLevelName(site.Level), threadIndex, file, site.Line);
+            out += prefix;
+
+            ArgReader reader(args, argsSize);
+            const std::string& format = site.Format;
+            for (size_t i = 0; i < format.size(); ++i)
+            {
+                const char current = format[i];
+                const char next = (i + 1 < format.size()) ? format[i + 1] : '\0';
+                if (current == '{' && next == '{')
+                {
+                    out.push_back('{');
+                    ++i;
+                }
+                else if (current == '}' && next == '}')
+                {
+                    out.push_back('}');
+                    ++i;
+                }
+                else if (current == '{' && next == '}')
+                {
+                    if (!reader.AppendNext(out))
+                        out += "{}";
+                    ++i;
+                }
+                else
+                {
+                    out.push_back(current);
+                }
+            }
+            out.push_back('\n');
+        }
+
+        void WriteBinary(FILE* file, const void* data, size_t size)
+        {
+            std::fwrite(data, 1, size, file);
+        }
+
+        void WriteBinarySite(FILE* file, uint32_t id, const SiteInfo& site)
+        {
+            const uint8_t kind = BinaryLogSiteRecord;
+            const uint8_t level = static_cast<uint8_t>(site.Level);
+            const uint32_t fileLength = static_cast<uint32_t>(site.File.size());
+            const uint32_t formatLength = static_cast<uint32_t>(site.Format.size());
+            WriteBinary(file, &kind, sizeof(kind));
+            WriteBinary(file, &id, sizeof(id));
+            WriteBinary(file, &level, sizeof(level));
+            WriteBinary(file, &site.Line, sizeof(site.Line));
+            WriteBinary(file, &fileLength, sizeof(fileLength));
+            WriteBinary(file, site.File.data(), fileLength);
+            WriteBinary(file, &formatLength, sizeof(formatLength));
+            WriteBinary(file, site.Format.data(), formatLength);
+        }
+
+        /**
+         * Writes the accumulated text batch to every text output.
+         */
+        void WriteBatch(LoggerState& state)
+        {
+            if (state.Batch.empty())
+                return;
+
+            const LogOutput outputs = state.Settings.Outputs;
+            if (HasLogOutput(outputs, LogOutput::Console))
+                std::fwrite(state.Batch.data(), 1, state.Batch.size(), stderr);
+            if (state.TextFile)
+                std::fwrite(state.Batch.data(), 1, state.Batch.size(), state.TextFile);
+#ifdef _WIN32
+            if (HasLogOutput(outputs, LogOutput::DebugOutput))
+                OutputDebugStringW(Convertor::ToWString(state.Batch).c_str());
+#endif
+            state.Batch.clear();
+        }
+
+        /**
+         * Drains every registered buffer. The caller must hold DrainMutex.
+         * @return True if at least one record was written.
+         */
+        bool DrainBuffers(LoggerState& state)
+        {
+            std::vector<std::shared_ptr<Detail::LogRingBuffer>> buffers;
+            {
+                std::lock_guard<std::mutex> lock(state.BuffersMutex);
+                buffers = state.Buffers;
+            }
+
+            // A record is registered before it is committed, so reading the heads before the sites
+            // guarantees that every record up to them has its site in the snapshot.
+            std::vector<uint64_t> heads;
+            heads.reserve(buffers.size());
+            for (const auto& buffer : buffers)
+                heads.push_back(buffer->GetHead());
+
+            std::vector<SiteInfo> sites;
+            {
+                std::lock_guard<std::mutex> lock(state.SitesMutex);
+                sites = state.Sites;
+            }
+            state.SitesWritten.resize(sites.size(), false);
+
+            const bool formatText = HasLogOutput(state.Settings.Outputs, LogOutput::Console) ||
+                                    HasLogOutput(state.Settings.Outputs, LogOutput::DebugOutput) ||
+                                    state.TextFile != nullptr;
+
+            bool wroteAny = false;
+            bool anyRetiredEmpty = false;
+            for (size_t index = 0; index < buffers.size(); ++index)
+            {
+                const auto& buffer = buffers[index];
+                const uint64_t head = heads[index];
+                uint64_t position = buffer->GetTail();
+                while (position < head)
+                {
+                    Detail::LogRecordHeader header{};
+                    buffer->Read(position, &header, sizeof(header));
+                    state.Scratch.resize(header.Size);
+                    buffer->Read(position, state.Scratch.data(), header.Size);
+                    position += header.Size;
+
+                    if (header.SiteId > sites.size())
+                    {
+                        // Cannot happen with the heads read first, but never drop a record that was emitted.
+                        std::lock_guard<std::mutex> lock(state.SitesMutex);
+                        sites = state.Sites;
+                        state.SitesWritten.resize(sites.size(), false);
+                    }
+
+                    if (header.SiteId == 0 || header.SiteId > sites.size())
+                        continue;
+
+                    const SiteInfo& site = sites[header.SiteId - 1];
+                    if (formatText)
+                    {
+                        FormatRecord(state.Batch, site, buffer->GetThreadIndex(), header.Timestamp,
+                                     state.Scratch.data() + sizeof(header), header.Size - sizeof(header));
+                    }
+
+                    if (state.BinaryFile)
+                    {
+                        if (!state.SitesWritten[header.SiteId - 1])
+                        {
+                            WriteBinarySite(state.BinaryFile, header.SiteId, site);
+                            state.SitesWritten[header.SiteId - 1] = true;
+                        }
+
+                        const uint8_t kind = BinaryLogEntryRecord;
+                        const uint32_t threadIndex = buffer->GetThreadIndex();
+                        WriteBinary(state.BinaryFile, &kind, sizeof(kind));
+                        WriteBinary(state.BinaryFile, &threadIndex, sizeof(threadIndex));
+                        WriteBinary(state.BinaryFile, state.Scratch.data(), header.Size);
+                    }
+                    wroteAny = true;
+                }
+                buffer->Consume(position);
+
+                if (buffer->IsRetired() && buffer->GetHead() == position)
+                    anyRetiredEmpty = true;
+            }
+
+            WriteBatch(state);
+            if (wroteAny)
+            {
+                if (state.TextFile)
+                    std::fflush(state.TextFile);
+                if (state.BinaryFile)
+                    std::fflush(state.BinaryFile);
+                if (HasLogOutput(state.Settings.Outputs, LogOutput::Console))
+                    std::fflush(stderr);
+            }
+
+            if (anyRetiredEmpty)
+            {
+                std::lock_guard<std::mutex> lock(state.BuffersMutex);
+                std::erase_if(state.Buffers, [](const auto& buffer) {
+                    return buffer->IsRetired() && buffer->GetHead() == buffer->GetTail();
+                });
+            }
+
+            return wroteAny;
+        }
+
+        void WorkerLoop(LoggerState& state)
+        {
+            std::unique_lock<std::mutex> wakeLock(state.WakeMutex);
+            while (true)
+            {
+                const uint64_t flushTarget = state.FlushRequested;
+                const bool stopping = state.StopRequested;
+                state.WakePending.store(false, std::memory_order_relaxed);
+                wakeLock.unlock();
+
+                {
+                    std::lock_guard<std::mutex> drainLock(state.DrainMutex);
+                    DrainBuffers(state);
+                }
+
+                wakeLock.lock();
+                state.FlushCompleted = flushTarget;
+                state.FlushCondition.notify_all();
+                if (stopping)
+                    break;
+
+                state.WakeCondition.wait_for(wakeLock, state.Settings.FlushInterval, [&state, flushTarget] {
+                    return state.StopRequested || state.FlushRequested != flushTarget ||
+                           state.WakePending.load(std::memory_order_relaxed);
+                });
+            }
+        }
+
+        void WakeWorker(LoggerState& state)
+        {
+            if (!state.WakePending.exchange(true, std::memory_order_relaxed))
+                state.WakeCondition.notify_one();
+        }
+
+        std::terminate_handler s_previousTerminateHandler{nullptr};
+
+        void TerminateHandler()
+        {
+            DebugLogger::EmergencyFlush();
+            if (s_previousTerminateHandler)
+                s_previousTerminateHandler();
+            std::abort();
+        }
+
+#ifdef _WIN32
+        LPTOP_LEVEL_EXCEPTION_FILTER s_previousExceptionFilter{nullptr};
+
+        LONG WINAPI UnhandledExceptionHandler(EXCEPTION_POINTERS* exceptionInfo)
+        {
+            DebugLogger::EmergencyFlush();
+            if (s_previousExceptionFilter)
+                return s_previousExceptionFilter(exceptionInfo);
+            return EXCEPTION_CONTINUE_SEARCH;
+        }
+#endif
+
+        void InstallCrashHandlers()
+        {
+            static std::once_flag installed;
+            std::call_once(installed, [] {
+                s_previousTerminateHandler = std::set_terminate(TerminateHandler);
+#ifdef _WIN32
+                s_previousExceptionFilter = SetUnhandledExceptionFilter(UnhandledExceptionHandler);
+#endif
+                std::atexit([] { DebugLogger::Stop(); });
+            });
+        }
+    }
+
+    std::atomic<uint8_t> DebugLogger::s_minimumLevel{static_cast<uint8_t>(LogLevel::Fatal) + 1};
+
+    namespace Detail
+    {
+        LogRingBuffer::LogRingBuffer(size_t capacity, uint32_t threadIndex)
+        {
+            capacity_ = RoundUpToPowerOfTwo(capacity);
+            mask_ = capacity_ - 1;
+            threadIndex_ = threadIndex;
+            storage_ = std::make_unique<uint8_t[]>(capacity_);
+        }
+    }
+
+    void DebugLogger::Start(const DebugLoggerSettings& settings)
+    {
+        LoggerState& state = GetState();
+        if (state.Running.load(std::memory_order_acquire))
+            throw std::runtime_error("DebugLogger is already running.");
+
+        state.Settings = settings;
+        state.TextFile = nullptr;
+        state.BinaryFile = nullptr;
+        state.StartTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        state.StartEpochNanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+        if (HasLogOutput(settings.Outputs, LogOutput::TextFile))
+        {
+            state.TextFile = std::fopen(settings.TextFilePath.c_str(), "ab");
+            if (!state.TextFile)
+                throw std::runtime_error("Failed to open the text log file.");
+        }
+
+        if (HasLogOutput(settings.Outputs, LogOutput::BinaryFile))
+        {
+            state.BinaryFile = std::fopen(settings.BinaryFilePath.c_str(), "wb");
+            if (!state.BinaryFile)
+            {
+                if (state.TextFile)
+                    std::fclose(state.TextFile);
+                state.TextFile = nullptr;
+                throw std::runtime_error("Failed to open the binary log file.");
+            }
+
+            WriteBinary(state.BinaryFile, BinaryLogMagic, sizeof(BinaryLogMagic));
+            WriteBinary(state.BinaryFile, &state.StartEpochNanoseconds, sizeof(state.StartEpochNanoseconds));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.DrainMutex);
+            state.SitesWritten.clear();
+        }
+        {
+            std::lock_guard<std::mutex> lock(state.BuffersMutex);
+            state.Buffers.clear();
+        }
+        {
+            std::lock_guard<std::mutex> lock(state.WakeMutex);
+            state.StopRequested = false;
+            state.FlushRequested = 0;
+            state.FlushCompleted = 0;
+        }
+
+        state.Dropped.store(0, std::memory_order_relaxed);
+        state.Generation.fetch_add(1, std::memory_order_acq_rel);
+        state.Running.store(true, std::memory_order_release);
+        state.Worker = std::thread(WorkerLoop, std::ref(state));
+
+        if (settings.InstallCrashHandlers)
+            InstallCrashHandlers();
+
+        s_minimumLevel.store(static_cast<uint8_t>(settings.MinimumLevel), std::memory_order_relaxed);
+    }
+
+    void DebugLogger::Stop()
+    {
+        LoggerState& state = GetState();
+        if (!state.Running.exchange(false, std::memory_order_acq_rel))
+            return;
+
+        s_minimumLevel.store(static_cast<uint8_t>(LogLevel::Fatal) + 1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(state.WakeMutex);
+            state.StopRequested = true;
+        }
+        state.WakeCondition.notify_one();
+        if (state.Worker.joinable())
+            state.Worker.join();
+
+        std::lock_guard<std::mutex> lock(state.DrainMutex);
+        DrainBuffers(state);
+        if (state.TextFile)
+            std::fclose(state.TextFile);
+        if (state.BinaryFile)
+            std::fclose(state.BinaryFile);
+        state.TextFile = nullptr;
+        state.BinaryFile = nullptr;
+    }
+
+    void DebugLogger::Flush()
+    {
+        LoggerState& state = GetState();
+        if (!state.Running.load(std::memory_order_acquire))
+            return;
+
+        std::unique_lock<std::mutex> lock(state.WakeMutex);
+        const uint64_t target = ++state.FlushRequested;
+        state.WakeCondition.notify_one();
+        state.FlushCondition.wait(lock, [&state, target] {
+            return state.FlushCompleted >= target || state.StopRequested;
+        });
+    }
+
+    void DebugLogger::EmergencyFlush() noexcept
+    {
+        LoggerState& state = GetState();
+        if (!state.Running.load(std::memory_order_acquire))
+            return;
+
+        // The background thread may hold the drain lock; give it a moment to finish.
+        std::unique_lock<std::mutex> lock(state.DrainMutex, std::defer_lock);
+        for (int attempt = 0; attempt < 100 && !lock.try_lock(); ++attempt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if (!lock.owns_lock())
+            return;
+
+        try
+        {
+            DrainBuffers(state);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    bool DebugLogger::IsRunning() noexcept
+    {
+        return GetState().Running.load(std::memory_order_acquire);
+    }
+
+    uint64_t DebugLogger::GetDroppedCount() noexcept
+    {
+        return GetState().Dropped.load(std::memory_order_relaxed);
+    }
+
+    uint32_t DebugLogger::RegisterSite(const LogSite& site, const char* format)
+    {
+        LoggerState& state = GetState();
+        std::lock_guard<std::mutex> lock(state.SitesMutex);
+
+        uint32_t id = site.Id.load(std::memory_order_acquire);
+        if (id != 0)
+            return id;
+
+        site.Format = format;
+        state.Sites.push_back(SiteInfo{site.Level, site.File ? site.File : "", site.Line, format ? format : ""});
+        id = static_cast<uint32_t>(state.Sites.size());
+        site.Id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    Detail::LogRingBuffer* DebugLogger::AcquireThreadBuffer(size_t size)
+    {
+        LoggerState& state = GetState();
+        if (!state.Running.load(std::memory_order_acquire))
+            return nullptr;
+
+        const uint32_t generation = state.Generation.load(std::memory_order_acquire);
+        if (!t_threadBuffer.Buffer || t_threadBuffer.Generation != generation)
+        {
+            if (t_threadBuffer.Buffer)
+                t_threadBuffer.Buffer->Retire();
+
+            t_threadBuffer.Buffer = std::make_shared<Detail::LogRingBuffer>(state.Settings.ThreadBufferSize,
+                                                                           state.NextThreadIndex.fetch_add(1, std::memory_order_relaxed));
+            t_threadBuffer.Generation = generation;
+
+            std::lock_guard<std::mutex> lock(state.BuffersMutex);
+            state.Buffers.push_back(t_threadBuffer.Buffer);
+        }
+
+        Detail::LogRingBuffer* buffer = t_threadBuffer.Buffer.get();
+        if (size > buffer->GetCapacity())
+        {
+            state.Dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        if (buffer->TryReserve(size))
+        {
+            // Wake the background thread early once the buffer is more than half full.
+            if (buffer->GetHead() - buffer->GetTail() > buffer->GetCapacity() / 2)
+                WakeWorker(state);
+            return buffer;
+        }
+
+        WakeWorker(state);
+        if (state.Settings.OverflowPolicy == LogOverflowPolicy::Drop)
+        {
+            state.Dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        while (!buffer->TryReserve(size))
+        {
+            if (!state.Running.load(std::memory_order_acquire))
+                return nullptr;
+
+            WakeWorker(state);
+            std::this_thread::yield();
+        }
+        return buffer;
+    }
+
+    uint64_t DebugLogger::Now() noexcept
+    {
+        const std::chrono::steady_clock::duration start(GetState().StartTicks.load(std::memory_order_relaxed));
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch() - start).count());
+    }
+
+    void DebugLogger::DecodeBinaryLog(const std::string& binaryPath, const std::string& textPath)
+    {
+        std::unique_ptr<FILE, int (*)(FILE*)> input(std::fopen(binaryPath.c_str(), "rb"), &std::fclose);
+        if (!input)
+            throw std::runtime_error("Failed to open the binary log file.");
+
+        auto readExact = [&input](void* destination, size_t size) {
+            return std::fread(destination, 1, size, input.get()) == size;
+        };
+
+        char magic[sizeof(BinaryLogMagic)]{};
+        uint64_t startEpochNanoseconds = 0;
+        if (!readExact(magic, sizeof(magic)) || std::memcmp(magic, BinaryLogMagic, sizeof(magic)) != 0 ||
+            !readExact(&startEpochNanoseconds, sizeof(startEpochNanoseconds)))
+            throw std::runtime_error("The file is not a WinCore binary log.");
+
+        std::unique_ptr<FILE, int (*)(FILE*)> output(std::fopen(textPath.c_str(), "wb"), &std::fclose);
+        if (!output)
+            throw std::runtime_error("Failed to open the decoded log file.");
+
+        std::vector<SiteInfo> sites;
+        std::vector<uint8_t> record;
+        std::string text;
+        uint8_t kind = 0;
+        while (readExact(&kind, sizeof(kind)))
+        {
+            if (kind == BinaryLogSiteRecord)
+            {
+                uint32_t id = 0;
+                uint8_t level = 0;
+                SiteInfo site{};
+                uint32_t length = 0;
+                if (!readExact(&id, sizeof(id)) || !readExact(&level, sizeof(level)) || !readExact(&site.Line, sizeof(site.Line)) ||
+                    !readExact(&length, sizeof(length)))
+                    throw std::runtime_error("Truncated site record in binary log.");
+
+                site.Level = static_cast<LogLevel>(level);
+                site.File.resize(length);
+                if (!readExact(site.File.data(), length) || !readExact(&length, sizeof(length)))
+                    throw std::runtime_error("Truncated site record in binary log.");
+
+                site.Format.resize(length);
+                if (!readExact(site.Format.data(), length) || id == 0)
+                    throw std::runtime_error("Truncated site record in binary log.");
+
+                if (sites.size() < id)
+                    sites.resize(id);
+                sites[id - 1] = std::move(site);
+            }
+            else if (kind == BinaryLogEntryRecord)
+            {
+                uint32_t threadIndex = 0;
+                Detail::LogRecordHeader header{};
+                if (!readExact(&threadIndex, sizeof(threadIndex)) || !readExact(&header, sizeof(header)) || header.Size < sizeof(header))
+                    throw std::runtime_error("Truncated entry record in binary log.");
+
+                record.resize(header.Size - sizeof(header));
+                if (!readExact(record.data(), record.size()))
+                    throw std::runtime_error("Truncated entry record in binary log.");
+
+                if (header.SiteId == 0 || header.SiteId > sites.size())
+                    throw std::runtime_error("Binary log entry references an unknown site.");
+
+                FormatRecord(text, sites[header.SiteId - 1], threadIndex, header.Timestamp, record.data(), record.size());
+                std::fwrite(text.data(), 1, text.size(), output.get());
+                text.clear();
+            }
+            else
+            {
+                throw std::runtime_error("Unknown record in binary log.");
+            }
+        }
+    }
+}
@@ -0,0 +1,481 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace WinCore::Utils
+{
+    enum class LogLevel : uint8_t
+    {
+        Trace = 0,      //< Very detailed diagnostic information.
+        Debug = 1,      //< Diagnostic information useful while developing.
+        Info = 2,       //< General information about the application flow.
+        Warning = 3,    //< Something unexpected happened but the application can continue.
+        Error = 4,      //< An operation failed.
+        Fatal = 5       //< The application cannot continue.
+    };
+
+    enum class LogOverflowPolicy : uint8_t
+    {
+        Drop = 0,       //< Records that do not fit into the thread buffer are discarded and counted.
+        Block = 1       //< The calling thread waits until the background thread has made room.
+    };
+
+    enum class LogOutput : uint32_t
+    {
+        None = 0,               //< No output is produced.
+        Console = 1 << 0,       //< Formatted records are written to stderr.
+        DebugOutput = 1 << 1,   //< Formatted records are sent to the debugger (OutputDebugString).
+        TextFile = 1 << 2,      //< Formatted records are appended to DebugLoggerSettings::TextFilePath.
+        BinaryFile = 1 << 3     //< Raw records are appended to DebugLoggerSettings::BinaryFilePath.
+    };
+
+    inline LogOutput operator|(LogOutput lhs, LogOutput rhs)
+    {
+        return static_cast<LogOutput>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+    }
+
+    inline bool HasLogOutput(LogOutput mask, LogOutput flag)
+    {
+        return (static_cast<uint32_t>(mask) & static_cast<uint32_t>(flag)) != 0;
+    }
+
+    /**
+     * @struct LogSite
+     * @brief Static description of a single logging call site.
+     *
+     * A LogSite is created once per call site by the WINCORE_LOG macros. Only its id
+     * travels through the ring buffers, the level, location and format string are
+     * looked up by the background thread when the record is formatted.
+     */
+    struct LogSite
+    {
+        LogLevel Level{LogLevel::Info};                 //< The severity of the records emitted by this site.
+        const char* File{nullptr};                      //< The source file of the call site.
+        uint32_t Line{0};                               //< The source line of the call site.
+        mutable const char* Format{nullptr};            //< The format string, captured on first use.
+        mutable std::atomic<uint32_t> Id{0};            //< The registered id of the site, 0 while unregistered.
+    };
+
+    /**
+     * @struct DebugLoggerSettings
+     * @brief Configuration used when starting the DebugLogger.
+     */
+    struct DebugLoggerSettings
+    {
+        LogLevel MinimumLevel{LogLevel::Debug};                         //< Records below this level are rejected at the call site.
+        LogOutput Outputs{LogOutput::Console | LogOutput::DebugOutput}; //< The outputs the background thread writes to.
+        std::string TextFilePath{};                                     //< The path of the text log, used with LogOutput::TextFile.
+        std::string BinaryFilePath{};                                   //< The path of the binary log, used with LogOutput::BinaryFile.
+        size_t ThreadBufferSize{256 * 1024};                            //< The ring buffer size per producing thread in bytes (rounded up to a power of two).
+        LogOverflowPolicy OverflowPolicy{LogOverflowPolicy::Drop};      //< What happens when a thread buffer is full.
+        std::chrono::milliseconds FlushInterval{10};                    //< The maximum time records wait before they are written.
+        bool InstallCrashHandlers{true};                                //< Flushes pending records on std::terminate and unhandled exceptions.
+    };
+
+    namespace Detail
+    {
+        enum class LogArgType : uint8_t
+        {
+            Bool = 1,
+            Char = 2,
+            Int64 = 3,
+            UInt64 = 4,
+            Double = 5,
+            String = 6,
+            WString = 7,
+            Pointer = 8
+        };
+
+        /**
+         * @class LogRingBuffer
+         * @brief A single-producer single-consumer byte ring used by one logging thread.
+         *
+         * The owning thread reserves space, writes a record and publishes it with Commit.
+         * The background thread reads published records and releases them with Consume.
+         */
+        class LogRingBuffer
+        {
+            public:
+                explicit LogRingBuffer(size_t capacity, uint32_t threadIndex);
+                ~LogRingBuffer() = default;
+
+                LogRingBuffer(const LogRingBuffer&) = delete;
+                LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+                LogRingBuffer(LogRingBuffer&&) = delete;
+                LogRingBuffer& operator=(LogRingBuffer&&) = delete;
+
+                /**
+                 * Tries to reserve space for a record of the given size.
+                 * @param size The size of the record in bytes.
+                 * @return True if the space is available, false if the buffer is full.
+                 */
+                bool TryReserve(size_t size) noexcept
+                {
+                    const uint64_t head = head_.load(std::memory_order_relaxed);
+                    if (capacity_ - (head - cachedTail_) >= size)
+                        return true;
+
+                    cachedTail_ = tail_.load(std::memory_order_acquire);
+                    return capacity_ - (head - cachedTail_) >= size;
+                }
+
+                /**
+                 * Copies bytes into the reserved region at the given offset from the current head.
+                 * @param offset The offset from the head of the buffer.
+                 * @param data The bytes to copy.
+                 * @param size The number of bytes to copy.
+                 */
+                void Write(size_t offset, const void* data, size_t size) noexcept
+                {
+                    const size_t start = static_cast<size_t>((head_.load(std::memory_order_relaxed) + offset) & mask_);
+                    const size_t first = (size < capacity_ - start) ? size : capacity_ - start;
+                    std::memcpy(storage_.get() + start, data, first);
+                    std::memcpy(storage_.get(), static_cast<const uint8_t*>(data) + first, size - first);
+                }
+
+                /**
+                 * Publishes a previously reserved and written record to the consumer.
+                 * @param size The size of the record in bytes.
+                 */
+                void Commit(size_t size) noexcept
+                {
+                    head_.store(head_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+                }
+
+                /**
+                 * Copies bytes from the published region into the destination.
+                 * @param position The absolute read position.
+                 * @param destination The buffer receiving the bytes.
+                 * @param size The number of bytes to copy.
+                 */
+                void Read(uint64_t position, void* destination, size_t size) const noexcept
+                {
+                    const size_t start = static_cast<size_t>(position & mask_);
+                    const size_t first = (size < capacity_ - start) ? size : capacity_ - start;
+                    std::memcpy(destination, storage_.get() + start, first);
+                    std::memcpy(static_cast<uint8_t*>(destination) + first, storage_.get(), size - first);
+                }
+
+                [[nodiscard]] uint64_t GetHead() const noexcept { return head_.load(std::memory_order_acquire); }
+                [[nodiscard]] uint64_t GetTail() const noexcept { return tail_.load(std::memory_order_relaxed); }
+                [[nodiscard]] size_t GetCapacity() const noexcept { return capacity_; }
+                [[nodiscard]] uint32_t GetThreadIndex() const noexcept { return threadIndex_; }
+
+                /**
+                 * Releases consumed bytes back to the producer.
+                 * @param position The new absolute read position.
+                 */
+                void Consume(uint64_t position) noexcept { tail_.store(position, std::memory_order_release); }
+
+                /**
+                 * Marks the buffer as abandoned by its thread. The consumer frees it once drained.
+                 */
+                void Retire() noexcept { retired_.store(true, std::memory_order_release); }
+                [[nodiscard]] bool IsRetired() const noexcept { return retired_.load(std::memory_order_acquire); }
+
+            private:
+                alignas(64) std::atomic<uint64_t> head_{0};     //< The producer write position.
+                uint64_t cachedTail_{0};                        //< The producer's last observed consumer position.
+                alignas(64) std::atomic<uint64_t> tail_{0};     //< The consumer read position.
+                alignas(64) std::atomic<bool> retired_{false};  //< Set when the owning thread has exited.
+                size_t capacity_;                               //< The capacity in bytes, a power of two.
+                size_t mask_;                                   //< capacity_ - 1.
+                uint32_t threadIndex_;                          //< The sequential index of the owning thread.
+                std::unique_ptr<uint8_t[]> storage_;            //< The ring storage.
+        };
+
+        /**
+         * @struct LogRecordHeader
+         * @brief The fixed part of every record stored in a ring buffer.
+         */
+        struct LogRecordHeader
+        {
+            uint32_t Size;          //< The total size of the record including this header.
+            uint32_t SiteId;        //< The id of the LogSite that produced the record.
+            uint64_t Timestamp;     //< Nanoseconds since the logger was started.
+        };
+
+        template<typename T>
+        using LogDecay = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        template<typename T>
+        constexpr bool IsLogNarrowString = std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*> ||
+                                           std::is_same_v<LogDecay<T>, std::string> || std::is_same_v<LogDecay<T>, std::string_view>;
+
+        template<typename T>
+        constexpr bool IsLogWideString = std::is_same_v<std::decay_t<T>, const wchar_t*> || std::is_same_v<std::decay_t<T>, wchar_t*> ||
+                                         std::is_same_v<LogDecay<T>, std::wstring> || std::is_same_v<LogDecay<T>, std::wstring_view>;
+
+        /**
+         * Views a narrow string argument. Only pointers can be null, arrays such as literals are viewed as they are.
+         */
+        template<typename T>
+        std::string_view ToLogStringView(const T& value)
+        {
+            if constexpr (std::is_array_v<LogDecay<T>>)
+                return std::string_view(value);
+            else if constexpr (std::is_pointer_v<LogDecay<T>>)
+                return value ? std::string_view(value) : std::string_view("(null)");
+            else
+                return std::string_view(value);
+        }
+
+        template<typename T>
+        std::wstring_view ToLogWStringView(const T& value)
+        {
+            if constexpr (std::is_array_v<LogDecay<T>>)
+                return std::wstring_view(value);
+            else if constexpr (std::is_pointer_v<LogDecay<T>>)
+                return value ? std::wstring_view(value) : std::wstring_view(L"(null)");
+            else
+                return std::wstring_view(value);
+        }
+
+        /**
+         * Returns the number of bytes an argument occupies in a record.
+         */
+        template<typename T>
+        size_t LogArgSize(const T& value)
+        {
+            if constexpr (IsLogNarrowString<T>)
+                return 1 + sizeof(uint32_t) + ToLogStringView(value).size();
+            else if constexpr (IsLogWideString<T>)
+                return 1 + sizeof(uint32_t) + ToLogWStringView(value).size() * sizeof(uint32_t);
+            else if constexpr (std::is_same_v<LogDecay<T>, bool> || std::is_same_v<LogDecay<T>, char>)
+                return 2;
+            else
+                return 1 + sizeof(uint64_t);
+        }
+
+        /**
+         * Writes an argument into the reserved region of a ring buffer.
+         * @return The offset following the written argument.
+         */
+        template<typename T>
+        size_t WriteLogArg(LogRingBuffer& buffer, size_t offset, const T& value)
+        {
+            auto writeTag = [&](LogArgType type) {
+                const uint8_t tag = static_cast<uint8_t>(type);
+                buffer.Write(offset, &tag, 1);
+                offset += 1;
+            };
+            auto writeWord = [&](const void* word) {
+                buffer.Write(offset, word, sizeof(uint64_t));
+                offset += sizeof(uint64_t);
+            };
+
+            if constexpr (IsLogNarrowString<T>)
+            {
+                const std::string_view text = ToLogStringView(value);
+                const uint32_t length = static_cast<uint32_t>(text.size());
+                writeTag(LogArgType::String);
+                buffer.Write(offset, &length, sizeof(length));
+                buffer.Write(offset + sizeof(length), text.data(), text.size());
+                offset += sizeof(length) + text.size();
+            }
+            else if constexpr (IsLogWideString<T>)
+            {
+                const std::wstring_view text = ToLogWStringView(value);
+                const uint32_t length = static_cast<uint32_t>(text.size());
+                writeTag(LogArgType::WString);
+                buffer.Write(offset, &length, sizeof(length));
+                offset += sizeof(length);
+                for (wchar_t unit : text)
+                {
+                    const uint32_t wide = static_cast<uint32_t>(unit);
+                    buffer.Write(offset, &wide, sizeof(wide));
+                    offset += sizeof(wide);
+                }
+            }
+            else if constexpr (std::is_same_v<LogDecay<T>, bool> || std::is_same_v<LogDecay<T>, char>)
+            {
+                writeTag(std::is_same_v<LogDecay<T>, bool> ? LogArgType::Bool : LogArgType::Char);
+                const uint8_t byte = static_cast<uint8_t>(value);
+                buffer.Write(offset, &byte, 1);
+                offset += 1;
+            }
+            else if constexpr (std::is_enum_v<LogDecay<T>>)
+            {
+                return WriteLogArg(buffer, offset, static_cast<std::underlying_type_t<LogDecay<T>>>(value));
+            }
+            else if constexpr (std::is_floating_point_v<LogDecay<T>>)
+            {
+                const double number = static_cast<double>(value);
+                writeTag(LogArgType::Double);
+                writeWord(&number);
+            }
+            else if constexpr (std::is_integral_v<LogDecay<T>> && std::is_signed_v<LogDecay<T>>)
+            {
+                const int64_t number = static_cast<int64_t>(value);
+                writeTag(LogArgType::Int64);
+                writeWord(&number);
+            }
+            else if constexpr (std::is_integral_v<LogDecay<T>>)
+            {
+                const uint64_t number = static_cast<uint64_t>(value);
+                writeTag(LogArgType::UInt64);
+                writeWord(&number);
+            }
+            else if constexpr (std::is_pointer_v<std::decay_t<T>>)
+            {
+                const uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+                writeTag(LogArgType::Pointer);
+                writeWord(&address);
+            }
+            else
+            {
+                static_assert(std::is_pointer_v<std::decay_t<T>>, "Unsupported DebugLogger argument type.");
+            }
+
+            return offset;
+        }
+    }
+
+    /**
+     * @class DebugLogger
+     * @brief Asynchronous logger with deferred formatting.
+     *
+     * Call sites copy the raw arguments and the id of their static LogSite into a
+     * per-thread lock-free ring buffer. A background thread formats the records and
+     * writes them in batches, so logging never blocks the calling thread on I/O.
+     */
+    class DebugLogger
+    {
+        private:
+            DebugLogger() = default;
+            ~DebugLogger() = default;
+
+            DebugLogger(const DebugLogger&) = delete;
+            DebugLogger& operator=(const DebugLogger&) = delete;
+            DebugLogger(DebugLogger&&) = delete;
+            DebugLogger& operator=(DebugLogger&&) = delete;
+
+        public:
+            /**
+             * Starts the background thread and opens the configured outputs.
+             * @param settings The configuration of the logger.
+             * @throws std::runtime_error If the logger is already running or an output file cannot be opened.
+             */
+            static void Start(const DebugLoggerSettings& settings = DebugLoggerSettings{});
+
+            /**
+             * Writes all pending records, closes the outputs and stops the background thread.
+             */
+            static void Stop();
+
+            /**
+             * Blocks until every record committed before the call has been written.
+             */
+            static void Flush();
+
+            /**
+             * Synchronously drains every thread buffer on the calling thread.
+             * Intended for crash paths where the background thread may no longer run.
+             */
+            static void EmergencyFlush() noexcept;
+
+            /**
+             * Checks whether the logger is running.
+             * @return True if Start has been called and Stop has not.
+             */
+            [[nodiscard]] static bool IsRunning() noexcept;
+
+            /**
+             * Checks whether records of the given level are accepted.
+             * @param level The level to check.
+             * @return True if the logger is running and the level passes the minimum level.
+             */
+            [[nodiscard]] static bool IsEnabled(LogLevel level) noexcept
+            {
+                return static_cast<uint8_t>(level) >= s_minimumLevel.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Returns the number of records discarded because a thread buffer was full.
+             * @return The number of dropped records since the logger was started.
+             */
+            [[nodiscard]] static uint64_t GetDroppedCount() noexcept;
+
+            /**
+             * Records a log entry. Formatting happens later on the background thread.
+             * @param site The static call site, created by the WINCORE_LOG macros.
+             * @param format The format string, "{}" is replaced by the next argument.
+             * @param args The arguments referenced by the format string.
+             */
+            template<typename... Args>
+            static void Log(const LogSite& site, const char* format, const Args&... args)
+            {
+                uint32_t siteId = site.Id.load(std::memory_order_acquire);
+                if (siteId == 0)
+                    siteId = RegisterSite(site, format);
+
+                const size_t size = sizeof(Detail::LogRecordHeader) + (size_t{0} + ... + Detail::LogArgSize(args));
+                Detail::LogRingBuffer* buffer = AcquireThreadBuffer(size);
+                if (!buffer)
+                    return;
+
+                Detail::LogRecordHeader header{static_cast<uint32_t>(size), siteId, Now()};
+                buffer->Write(0, &header, sizeof(header));
+
+                [[maybe_unused]] size_t offset = sizeof(header);
+                ((offset = Detail::WriteLogArg(*buffer, offset, args)), ...);
+                buffer->Commit(size);
+            }
+
+            /**
+             * Converts a binary log written with LogOutput::BinaryFile into readable text.
+             * @param binaryPath The path of the binary log.
+             * @param textPath The path of the text file to write.
+             * @throws std::runtime_error If a file cannot be opened or the binary log is malformed.
+             */
+            static void DecodeBinaryLog(const std::string& binaryPath, const std::string& textPath);
+
+        private:
+            /**
+             * Assigns an id to a call site on its first use.
+             */
+            static uint32_t RegisterSite(const LogSite& site, const char* format);
+
+            /**
+             * Returns the calling thread's buffer with room for a record of the given size.
+             * Applies the overflow policy and returns nullptr if the record has to be dropped.
+             */
+            static Detail::LogRingBuffer* AcquireThreadBuffer(size_t size);
+
+            /**
+             * Returns the current timestamp in nanoseconds since the logger was started.
+             */
+            static uint64_t Now() noexcept;
+
+            static std::atomic<uint8_t> s_minimumLevel;     //< The minimum accepted level, above Fatal while stopped.
+    };
+}
+
+/**
+ * Logs a record from the current call site.
+ * Usage: WINCORE_LOG(WinCore::Utils::LogLevel::Info, "Window {} resized to {}x{}", id, width, height);
+ */
+#define WINCORE_LOG(level, ...)                                                                         \
+    do                                                                                                  \
+    {                                                                                                   \
+        if (::WinCore::Utils::DebugLogger::IsEnabled(level))                                            \
+        {                                                                                               \
+            static const ::WinCore::Utils::LogSite wincoreLogSite{level, __FILE__, __LINE__};           \
+            ::WinCore::Utils::DebugLogger::Log(wincoreLogSite, __VA_ARGS__);                            \
+        }                                                                                               \
+    } while (false)
+
+#define WINCORE_LOG_TRACE(...) WINCORE_LOG(::WinCore::Utils::LogLevel::Trace, __VA_ARGS__)
+#define WINCORE_LOG_DEBUG(...) WINCORE_LOG(::WinCore::Utils::LogLevel::Debug, __VA_ARGS__)
+#define WINCORE_LOG_INFO(...) WINCORE_LOG(::WinCore::Utils::LogLevel::Info, __VA_ARGS__)
+#define WINCORE_LOG_WARNING(...) WINCORE_LOG(::WinCore::Utils::LogLevel::Warning, __VA_ARGS__)
+#define WINCORE_LOG_ERROR(...) WINCORE_LOG(::WinCore::Utils::LogLevel::Error, __VA_ARGS__)
+#define WINCORE_LOG_FATAL(...) WINCORE_LOG(::WinCore::Utils::LogLevel::Fatal, __VA_ARGS__)
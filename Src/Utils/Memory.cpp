@@ -0,0 +1,648 @@
+#include "Memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <vector>
+
+namespace WinCore::Utils
+{
+    namespace
+    {
+        constexpr size_t SubsystemCount = static_cast<size_t>(MemorySubsystem::Count);
+        constexpr size_t SlabSize = 64 * 1024;
+        constexpr size_t SlabAlignment = 64;
+        constexpr uint32_t CacheBatchSize = 32;
+        constexpr uint32_t CacheCapacity = CacheBatchSize * 2;
+
+        struct CounterSlot
+        {
+            std::atomic<uint64_t> Allocations{0};
+            std::atomic<uint64_t> Deallocations{0};
+            std::atomic<uint64_t> BytesAllocated{0};
+            std::atomic<uint64_t> UpstreamAllocations{0};
+        };
+
+        using CounterSlots = std::array<CounterSlot, SubsystemCount>;
+
+        /**
+         * Adds to a counter only its own thread writes. A plain load and store, other threads merely read it.
+         */
+        void Bump(std::atomic<uint64_t>& counter, uint64_t value) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        /**
+         * Every thread's counters, plus those of the threads that have ended.
+         */
+        struct CounterRegistry
+        {
+            std::mutex Mutex{};
+            std::vector<const CounterSlots*> Threads{};
+            CounterSlots Retired{};                 //< Also takes the records of exiting threads, with atomic adds.
+            std::array<MemoryCounters, SubsystemCount> Baseline{};     //< The totals at the last Reset().
+        };
+
+        CounterRegistry& GetCounterRegistry()
+        {
+            // Leaked, threads may record and exit after static destruction began.
+            static CounterRegistry* registry = new CounterRegistry();
+            return *registry;
+        }
+
+        class ThreadCounters;
+
+        thread_local CounterSlots* t_threadCounters = nullptr;    //< Constant-initialized, reading it needs no guard.
+        thread_local bool t_threadCountersDestroyed = false;
+
+        /**
+         * The counters of one thread. Writing them needs no read-modify-write on a cache line
+         * shared with other threads, GetCounters adds all threads up.
+         */
+        class ThreadCounters
+        {
+            public:
+                ThreadCounters()
+                {
+                    CounterRegistry& registry = GetCounterRegistry();
+                    std::lock_guard<std::mutex> lock(registry.Mutex);
+                    registry.Threads.push_back(&slots_);
+                }
+
+                ~ThreadCounters()
+                {
+                    CounterRegistry& registry = GetCounterRegistry();
+                    std::lock_guard<std::mutex> lock(registry.Mutex);
+                    for (size_t index = 0; index < SubsystemCount; ++index)
+                    {
+                        registry.Retired[index].Allocations.fetch_add(slots_[index].Allocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        registry.Retired[index].Deallocations.fetch_add(slots_[index].Deallocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        registry.Retired[index].BytesAllocated.fetch_add(slots_[index].BytesAllocated.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        registry.Retired[index].UpstreamAllocations.fetch_add(slots_[index].UpstreamAllocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    }
+                    std::erase(registry.Threads, &slots_);
+                    t_threadCounters = nullptr;
+                    t_threadCountersDestroyed = true;
+                }
+
+                ThreadCounters(const ThreadCounters&) = delete;
+                ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+                /**
+                 * Returns the counters of a subsystem on the calling thread, or nullptr while the thread is exiting.
+                 */
+                static CounterSlot* Get(MemorySubsystem subsystem) noexcept
+                {
+                    if (CounterSlots* slots = t_threadCounters)
+                        return &(*slots)[static_cast<size_t>(subsystem)];
+                    if (t_threadCountersDestroyed)
+                        return nullptr;
+
+                    thread_local ThreadCounters t_counters{};
+                    t_threadCounters = &t_counters.slots_;
+                    return &t_counters.slots_[static_cast<size_t>(subsystem)];
+                }
+
+            private:
+                CounterSlots slots_{};
+        };
+
+        MemoryCounters Load(const CounterSlot& slot) noexcept
+        {
+            return MemoryCounters{
+                slot.Allocations.load(std::memory_order_relaxed),
+                slot.Deallocations.load(std::memory_order_relaxed),
+                slot.BytesAllocated.load(std::memory_order_relaxed),
+                slot.UpstreamAllocations.load(std::memory_order_relaxed),
+            };
+        }
+
+        void Add(MemoryCounters& total, const MemoryCounters& counters) noexcept
+        {
+            total.Allocations += counters.Allocations;
+            total.Deallocations += counters.Deallocations;
+            total.BytesAllocated += counters.BytesAllocated;
+            total.UpstreamAllocations += counters.UpstreamAllocations;
+        }
+
+        /**
+         * Adds up every thread, the caller holds the registry mutex.
+         */
+        MemoryCounters SumLocked(const CounterRegistry& registry, size_t index) noexcept
+        {
+            MemoryCounters total = Load(registry.Retired[index]);
+            for (const CounterSlots* slots : registry.Threads)
+                Add(total, Load((*slots)[index]));
+            return total;
+        }
+
+        size_t AlignUp(size_t value, size_t alignment) noexcept
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        /**
+         * ObjectPool::GetSizeClass, kept here so the allocation paths inline it.
+         */
+        size_t SizeClassOf(size_t bytes, size_t alignment) noexcept
+        {
+            const size_t size = std::max({bytes, alignment, ObjectPool::MinimumBlockSize});
+            if (size > ObjectPool::MaximumBlockSize || alignment > SlabAlignment)
+                return ObjectPool::SizeClassCount;
+
+            return static_cast<size_t>(std::bit_width(size - 1)) - std::bit_width(ObjectPool::MinimumBlockSize - 1);
+        }
+    }
+
+    void MemoryStatistics::RecordAllocation(MemorySubsystem subsystem, size_t bytes, bool upstream) noexcept
+    {
+        if (CounterSlot* slot = ThreadCounters::Get(subsystem))
+        {
+            Bump(slot->Allocations, 1);
+            Bump(slot->BytesAllocated, bytes);
+            if (upstream)
+                Bump(slot->UpstreamAllocations, 1);
+            return;
+        }
+
+        CounterSlot& retired = GetCounterRegistry().Retired[static_cast<size_t>(subsystem)];
+        retired.Allocations.fetch_add(1, std::memory_order_relaxed);
+        retired.BytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+        if (upstream)
+            retired.UpstreamAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void MemoryStatistics::RecordDeallocation(MemorySubsystem subsystem) noexcept
+    {
+        if (CounterSlot* slot = ThreadCounters::Get(subsystem))
+            Bump(slot->Deallocations, 1);
+        else
+            GetCounterRegistry().Retired[static_cast<size_t>(subsystem)].Deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MemoryCounters MemoryStatistics::GetCounters(MemorySubsystem subsystem) noexcept
+    {
+        const size_t index = static_cast<size_t>(subsystem);
+        CounterRegistry& registry = GetCounterRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        const MemoryCounters total = SumLocked(registry, index);
+        const MemoryCounters& baseline = registry.Baseline[index];
+        return MemoryCounters{
+            total.Allocations - baseline.Allocations,
+            total.Deallocations - baseline.Deallocations,
+            total.BytesAllocated - baseline.BytesAllocated,
+            total.UpstreamAllocations - baseline.UpstreamAllocations,
+        };
+    }
+
+    MemoryCounters MemoryStatistics::GetTotal() noexcept
+    {
+        MemoryCounters total{};
+        for (size_t index = 0; index < SubsystemCount; ++index)
+            Add(total, GetCounters(static_cast<MemorySubsystem>(index)));
+        return total;
+    }
+
+    void MemoryStatistics::Reset() noexcept
+    {
+        // Other threads own their counters, so Reset remembers the totals instead of clearing them.
+        CounterRegistry& registry = GetCounterRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        for (size_t index = 0; index < SubsystemCount; ++index)
+            registry.Baseline[index] = SumLocked(registry, index);
+    }
+
+    const char* MemoryStatistics::GetName(MemorySubsystem subsystem) noexcept
+    {
+        switch (subsystem)
+        {
+            case MemorySubsystem::General: return "General";
+            case MemorySubsystem::Events: return "Events";
+            case MemorySubsystem::Layout: return "Layout";
+            case MemorySubsystem::Drawing: return "Drawing";
+            case MemorySubsystem::Text: return "Text";
+            case MemorySubsystem::Widgets: return "Widgets";
+            case MemorySubsystem::Tasks: return "Tasks";
+            default: return "Unknown";
+        }
+    }
+
+    FrameArena::FrameArena(size_t initialSize, MemorySubsystem subsystem, std::pmr::memory_resource* upstream)
+        : upstream_(upstream), subsystem_(subsystem)
+    {
+        for (size_t index = 0; index < SubsystemCount; ++index)
+        {
+            subsystems_[index].Arena = this;
+            subsystems_[index].Subsystem = static_cast<MemorySubsystem>(index);
+        }
+        AddChunk(std::max<size_t>(initialSize, 1024));
+    }
+
+    FrameArena::~FrameArena()
+    {
+        ReleaseChunks();
+    }
+
+    FrameArena& FrameArena::ForCurrentThread()
+    {
+        thread_local FrameArena t_arena{};
+        return t_arena;
+    }
+
+    std::pmr::memory_resource& FrameArena::For(MemorySubsystem subsystem) noexcept
+    {
+        return subsystems_[static_cast<size_t>(subsystem)];
+    }
+
+    void FrameArena::Reset()
+    {
+        const size_t used = GetBytesUsed();
+        highWaterMark_ = std::max(highWaterMark_, used);
+
+        if (chunks_.size() > 1)
+        {
+            // The frame spilled over, replace the chunks by one that fits the whole frame.
+            const size_t capacity = GetCapacity();
+            ReleaseChunks();
+            AddChunk(capacity);
+        }
+
+        begin_ = chunks_.back().Memory;
+        cursor_ = begin_;
+        end_ = begin_ + chunks_.back().Size;
+        retiredBytes_ = 0;
+    }
+
+    size_t FrameArena::GetCapacity() const noexcept
+    {
+        size_t capacity = 0;
+        for (const Chunk& chunk : chunks_)
+            capacity += chunk.Size;
+        return capacity;
+    }
+
+    void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+    {
+        return Allocate(bytes, alignment, subsystem_);
+    }
+
+    void* FrameArena::Allocate(size_t bytes, size_t alignment, MemorySubsystem subsystem)
+    {
+        bool upstream = false;
+        std::byte* aligned = reinterpret_cast<std::byte*>(AlignUp(reinterpret_cast<uintptr_t>(cursor_), alignment));
+        if (aligned + bytes > end_ || aligned < cursor_)
+        {
+            AddChunk(std::max(bytes + alignment, chunks_.back().Size * 2));
+            aligned = reinterpret_cast<std::byte*>(AlignUp(reinterpret_cast<uintptr_t>(cursor_), alignment));
+            upstream = true;
+        }
+
+        cursor_ = aligned + bytes;
+        MemoryStatistics::RecordAllocation(subsystem, bytes, upstream);
+        return aligned;
+    }
+
+    void FrameArena::do_deallocate(void*, size_t, size_t)
+    {
+        // Released in bulk by Reset().
+    }
+
+    void FrameArena::AddChunk(size_t minimumSize)
+    {
+        const size_t size = AlignUp(minimumSize, SlabAlignment);
+        auto* memory = static_cast<std::byte*>(upstream_->allocate(size, SlabAlignment));
+        chunks_.push_back(Chunk{memory, size});
+
+        if (begin_)
+            retiredBytes_ += static_cast<size_t>(cursor_ - begin_);
+        begin_ = memory;
+        cursor_ = memory;
+        end_ = memory + size;
+    }
+
+    void FrameArena::ReleaseChunks() noexcept
+    {
+        for (const Chunk& chunk : chunks_)
+            upstream_->deallocate(chunk.Memory, chunk.Size, SlabAlignment);
+
+        chunks_.clear();
+        begin_ = cursor_ = end_ = nullptr;
+        retiredBytes_ = 0;
+    }
+
+    namespace Detail
+    {
+        struct FreeBlock
+        {
+            FreeBlock* Next{nullptr};
+        };
+
+        /**
+         * The shared part of an ObjectPool. Kept alive by the pool and by every thread cache
+         * that holds blocks of it, so slabs are only released once nobody can touch them.
+         */
+        struct PoolDepot
+        {
+            struct alignas(64) SizeClass
+            {
+                std::mutex Mutex{};
+                FreeBlock* Head{nullptr};
+            };
+
+            explicit PoolDepot(std::pmr::memory_resource* upstream) : Upstream(upstream) {}
+
+            ~PoolDepot()
+            {
+                for (void* slab : Slabs)
+                    Upstream->deallocate(slab, SlabSize, SlabAlignment);
+            }
+
+            /**
+             * Takes up to count blocks of a size class, carving a new slab when the class is empty.
+             * @return The head of a chain of at least one block.
+             */
+            FreeBlock* Take(size_t classIndex, uint32_t count, uint32_t& taken, bool& upstream)
+            {
+                SizeClass& sizeClass = Classes[classIndex];
+                std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+                if (!sizeClass.Head)
+                {
+                    sizeClass.Head = CarveSlab(classIndex);
+                    upstream = true;
+                }
+
+                FreeBlock* head = sizeClass.Head;
+                FreeBlock* tail = head;
+                taken = 1;
+                while (taken < count && tail->Next)
+                {
+                    tail = tail->Next;
+                    ++taken;
+                }
+
+                sizeClass.Head = tail->Next;
+                tail->Next = nullptr;
+                return head;
+            }
+
+            /**
+             * Returns a chain of blocks to a size class.
+             */
+            void Give(size_t classIndex, FreeBlock* head, FreeBlock* tail) noexcept
+            {
+                SizeClass& sizeClass = Classes[classIndex];
+                std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+                tail->Next = sizeClass.Head;
+                sizeClass.Head = head;
+            }
+
+            FreeBlock* CarveSlab(size_t classIndex)
+            {
+                auto* slab = static_cast<std::byte*>(Upstream->allocate(SlabSize, SlabAlignment));
+                {
+                    std::lock_guard<std::mutex> lock(SlabMutex);
+                    Slabs.push_back(slab);
+                }
+                ReservedBytes.fetch_add(SlabSize, std::memory_order_relaxed);
+
+                const size_t blockSize = ObjectPool::MinimumBlockSize << classIndex;
+                FreeBlock* head = nullptr;
+                for (size_t offset = SlabSize; offset >= blockSize; offset -= blockSize)
+                {
+                    auto* block = reinterpret_cast<FreeBlock*>(slab + offset - blockSize);
+                    block->Next = head;
+                    head = block;
+                }
+                return head;
+            }
+
+            std::pmr::memory_resource* Upstream;
+            std::array<SizeClass, ObjectPool::SizeClassCount> Classes{};
+            std::mutex SlabMutex{};
+            std::vector<void*> Slabs{};
+            std::atomic<size_t> ReservedBytes{0};
+            std::atomic<bool> Retired{false};   //< Set when the owning ObjectPool is destroyed.
+        };
+    }
+
+    namespace
+    {
+        class ThreadCache;
+
+        thread_local ThreadCache* t_threadCache = nullptr;        //< Constant-initialized, reading it needs no guard.
+        thread_local bool t_threadCacheDestroyed = false;
+
+        /**
+         * The free blocks one thread keeps per pool and size class.
+         */
+        class ThreadCache
+        {
+            public:
+                struct ClassCache
+                {
+                    Detail::FreeBlock* Head{nullptr};
+                    uint32_t Count{0};
+                };
+
+                struct Entry
+                {
+                    std::shared_ptr<Detail::PoolDepot> Depot{};
+                    CounterSlot* Counters{nullptr};     //< The pool's subsystem counters of this thread.
+                    std::array<ClassCache, ObjectPool::SizeClassCount> Classes{};
+                };
+
+                ThreadCache() = default;
+
+                ~ThreadCache()
+                {
+                    for (Entry& entry : entries_)
+                        Flush(entry);
+                    t_threadCache = nullptr;
+                    t_threadCacheDestroyed = true;
+                }
+
+                ThreadCache(const ThreadCache&) = delete;
+                ThreadCache& operator=(const ThreadCache&) = delete;
+
+                /**
+                 * Returns the cache of the calling thread, or nullptr while the thread is exiting.
+                 */
+                static ThreadCache* Get() noexcept
+                {
+                    if (ThreadCache* cache = t_threadCache)
+                        return cache;
+                    // Entries point into the thread's counters, created first they are destroyed after the cache.
+                    if (t_threadCacheDestroyed || !ThreadCounters::Get(MemorySubsystem::General))
+                        return nullptr;
+
+                    thread_local ThreadCache t_cache{};
+                    t_threadCache = &t_cache;
+                    return &t_cache;
+                }
+
+                Entry& Find(const std::shared_ptr<Detail::PoolDepot>& depot, MemorySubsystem subsystem)
+                {
+                    if (lastEntry_ < entries_.size() && entries_[lastEntry_].Depot.get() == depot.get())
+                        return entries_[lastEntry_];
+                    return Search(depot, subsystem);
+                }
+
+                static void Flush(Entry& entry) noexcept
+                {
+                    for (size_t classIndex = 0; classIndex < entry.Classes.size(); ++classIndex)
+                    {
+                        ClassCache& cache = entry.Classes[classIndex];
+                        if (!cache.Head)
+                            continue;
+
+                        Detail::FreeBlock* tail = cache.Head;
+                        while (tail->Next)
+                            tail = tail->Next;
+                        entry.Depot->Give(classIndex, cache.Head, tail);
+                        cache = ClassCache{};
+                    }
+                }
+
+            private:
+                /**
+                 * Looks a pool up when it is not the one used last, adding an entry on its first use.
+                 */
+                Entry& Search(const std::shared_ptr<Detail::PoolDepot>& depot, MemorySubsystem subsystem)
+                {
+                    for (size_t index = 0; index < entries_.size();)
+                    {
+                        if (entries_[index].Depot == depot)
+                        {
+                            lastEntry_ = index;
+                            return entries_[index];
+                        }
+
+                        // Drop caches of destroyed pools so their slabs can be released.
+                        if (entries_[index].Depot->Retired.load(std::memory_order_relaxed))
+                        {
+                            entries_[index] = std::move(entries_.back());
+                            entries_.pop_back();
+                            continue;
+                        }
+                        ++index;
+                    }
+
+                    entries_.push_back(Entry{depot, ThreadCounters::Get(subsystem), {}});
+                    lastEntry_ = entries_.size() - 1;
+                    return entries_.back();
+                }
+
+                std::vector<Entry> entries_{};
+                size_t lastEntry_{0};
+        };
+    }
+
+    ObjectPool::ObjectPool(MemorySubsystem subsystem, std::pmr::memory_resource* upstream)
+        : depot_(std::make_shared<Detail::PoolDepot>(upstream)), upstream_(upstream), subsystem_(subsystem)
+    {
+    }
+
+    ObjectPool::~ObjectPool()
+    {
+        depot_->Retired.store(true, std::memory_order_relaxed);
+    }
+
+    ObjectPool& ObjectPool::Shared(MemorySubsystem subsystem)
+    {
+        static std::array<ObjectPool*, SubsystemCount> pools = [] {
+            std::array<ObjectPool*, SubsystemCount> created{};
+            for (size_t index = 0; index < SubsystemCount; ++index)
+                created[index] = new ObjectPool(static_cast<MemorySubsystem>(index));
+            return created;
+        }();
+        return *pools[static_cast<size_t>(subsystem)];
+    }
+
+    size_t ObjectPool::GetReservedBytes() const noexcept
+    {
+        return depot_->ReservedBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t ObjectPool::GetSizeClass(size_t bytes, size_t alignment) noexcept
+    {
+        return SizeClassOf(bytes, alignment);
+    }
+
+    void* ObjectPool::do_allocate(size_t bytes, size_t alignment)
+    {
+        const size_t classIndex = SizeClassOf(bytes, alignment);
+        if (classIndex == SizeClassCount)
+        {
+            MemoryStatistics::RecordAllocation(subsystem_, bytes, true);
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        ThreadCache* cache = ThreadCache::Get();
+        if (!cache)
+        {
+            bool upstream = false;
+            uint32_t taken = 0;
+            Detail::FreeBlock* block = depot_->Take(classIndex, 1, taken, upstream);
+            MemoryStatistics::RecordAllocation(subsystem_, bytes, upstream);
+            return block;
+        }
+
+        ThreadCache::Entry& entry = cache->Find(depot_, subsystem_);
+        ThreadCache::ClassCache& classCache = entry.Classes[classIndex];
+        if (!classCache.Head)
+        {
+            bool upstream = false;
+            classCache.Head = depot_->Take(classIndex, CacheBatchSize, classCache.Count, upstream);
+            if (upstream)
+                Bump(entry.Counters->UpstreamAllocations, 1);
+        }
+
+        Detail::FreeBlock* block = classCache.Head;
+        classCache.Head = block->Next;
+        --classCache.Count;
+        Bump(entry.Counters->Allocations, 1);
+        Bump(entry.Counters->BytesAllocated, bytes);
+        return block;
+    }
+
+    void ObjectPool::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+    {
+        const size_t classIndex = SizeClassOf(bytes, alignment);
+        if (classIndex == SizeClassCount)
+        {
+            MemoryStatistics::RecordDeallocation(subsystem_);
+            upstream_->deallocate(pointer, bytes, alignment);
+            return;
+        }
+
+        auto* block = static_cast<Detail::FreeBlock*>(pointer);
+        ThreadCache* cache = ThreadCache::Get();
+        if (!cache)
+        {
+            MemoryStatistics::RecordDeallocation(subsystem_);
+            depot_->Give(classIndex, block, block);
+            return;
+        }
+
+        ThreadCache::Entry& entry = cache->Find(depot_, subsystem_);
+        Bump(entry.Counters->Deallocations, 1);
+        ThreadCache::ClassCache& classCache = entry.Classes[classIndex];
+        block->Next = classCache.Head;
+        classCache.Head = block;
+        if (++classCache.Count < CacheCapacity)
+            return;
+
+        // Hand half of the cache back so blocks freed on this thread can be reused elsewhere.
+        Detail::FreeBlock* tail = classCache.Head;
+        for (uint32_t index = 1; index < CacheBatchSize; ++index)
+            tail = tail->Next;
+
+        Detail::FreeBlock* returned = classCache.Head;
+        classCache.Head = tail->Next;
+        classCache.Count -= CacheBatchSize;
+        depot_->Give(classIndex, returned, tail);
+    }
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace WinCore::Utils
+{
+    namespace Detail
+    {
+        struct PoolDepot;
+    }
+
+    /**
+     * @enum MemorySubsystem
+     * @brief The part of the UI pipeline an allocation is charged to.
+     */
+    enum class MemorySubsystem : uint8_t
+    {
+        General = 0,    //< Anything not covered below.
+        Events = 1,     //< Input and window event objects.
+        Layout = 2,     //< Layout scratch data.
+        Drawing = 3,    //< Draw commands and render data.
+        Text = 4,       //< Temporary and converted strings.
+        Widgets = 5,    //< Long-lived UI elements.
+        Tasks = 6,      //< Background jobs and their continuations.
+        Count = 7
+    };
+
+    /**
+     * @struct MemoryCounters
+     * @brief A snapshot of the allocation counters of one subsystem.
+     */
+    struct MemoryCounters
+    {
+        uint64_t Allocations{0};        //< Number of allocations served.
+        uint64_t Deallocations{0};      //< Number of deallocations, arena memory is released on reset without counting.
+        uint64_t BytesAllocated{0};     //< Total bytes handed out.
+        uint64_t UpstreamAllocations{0};//< Allocations that reached the upstream resource (the system heap by default).
+    };
+
+    /**
+     * @class MemoryStatistics
+     * @brief Process-wide allocation counters per MemorySubsystem.
+     *
+     * Every thread updates its own counters, so recording never writes to memory shared with
+     * other threads. GetCounters adds the threads up. Compare two snapshots to get the
+     * allocations made in between, e.g. per frame.
+     */
+    class MemoryStatistics
+    {
+        private:
+            MemoryStatistics() = default;
+            ~MemoryStatistics() = default;
+
+            MemoryStatistics(const MemoryStatistics&) = delete;
+            MemoryStatistics& operator=(const MemoryStatistics&) = delete;
+            MemoryStatistics(MemoryStatistics&&) = delete;
+            MemoryStatistics& operator=(MemoryStatistics&&) = delete;
+
+        public:
+            /**
+             * Records an allocation.
+             * @param subsystem The subsystem charged.
+             * @param bytes The size of the allocation.
+             * @param upstream Whether the allocation reached the upstream resource.
+             */
+            static void RecordAllocation(MemorySubsystem subsystem, size_t bytes, bool upstream) noexcept;
+
+            /**
+             * Records a deallocation.
+             * @param subsystem The subsystem charged.
+             */
+            static void RecordDeallocation(MemorySubsystem subsystem) noexcept;
+
+            /**
+             * Returns the counters of a subsystem.
+             */
+            [[nodiscard]] static MemoryCounters GetCounters(MemorySubsystem subsystem) noexcept;
+
+            /**
+             * Returns the counters of all subsystems added together.
+             */
+            [[nodiscard]] static MemoryCounters GetTotal() noexcept;
+
+            /**
+             * Sets every counter back to zero, as seen by GetCounters and GetTotal.
+             */
+            static void Reset() noexcept;
+
+            /**
+             * Returns a readable name for a subsystem.
+             */
+            [[nodiscard]] static const char* GetName(MemorySubsystem subsystem) noexcept;
+    };
+
+    /**
+     * @class FrameArena
+     * @brief Bump-pointer memory resource whose memory is released all at once by Reset().
+     *
+     * Meant for data that dies at the end of a frame: layout scratch, draw command lists,
+     * temporary strings. deallocate() is a no-op. After a frame that needed more than one
+     * chunk, Reset() replaces the chunks by a single one large enough for the whole frame,
+     * so steady-state frames touch the upstream resource zero times. Allocations are charged
+     * to the subsystem given at construction, use For() to charge another one. Not
+     * thread-safe, use one arena per thread (see ForCurrentThread).
+     */
+    class FrameArena final : public std::pmr::memory_resource
+    {
+        public:
+            /**
+             * Creates an arena.
+             * @param initialSize The size of the first chunk in bytes.
+             * @param subsystem The subsystem allocations are charged to.
+             * @param upstream The resource chunks are taken from.
+             */
+            explicit FrameArena(size_t initialSize = 256 * 1024, MemorySubsystem subsystem = MemorySubsystem::General,
+                                std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+            ~FrameArena() override;
+
+            FrameArena(const FrameArena&) = delete;
+            FrameArena& operator=(const FrameArena&) = delete;
+            FrameArena(FrameArena&&) = delete;
+            FrameArena& operator=(FrameArena&&) = delete;
+
+            /**
+             * Returns the arena of the calling thread, created on first use.
+             */
+            [[nodiscard]] static FrameArena& ForCurrentThread();
+
+            /**
+             * Returns a resource allocating from this arena that charges another subsystem, e.g.
+             * For(MemorySubsystem::Layout) for layout scratch. It lives as long as the arena.
+             * @param subsystem The subsystem charged.
+             */
+            [[nodiscard]] std::pmr::memory_resource& For(MemorySubsystem subsystem) noexcept;
+
+            /**
+             * Releases everything allocated since the last reset. Pointers into the arena become invalid.
+             */
+            void Reset();
+
+            /**
+             * Returns the number of bytes handed out since the last reset, including alignment padding.
+             */
+            [[nodiscard]] size_t GetBytesUsed() const noexcept { return retiredBytes_ + (cursor_ - begin_); }
+
+            /**
+             * Returns the largest GetBytesUsed() seen at a reset.
+             */
+            [[nodiscard]] size_t GetHighWaterMark() const noexcept { return highWaterMark_; }
+
+            /**
+             * Returns the total size of the chunks the arena holds.
+             */
+            [[nodiscard]] size_t GetCapacity() const noexcept;
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        private:
+            struct Chunk
+            {
+                std::byte* Memory{nullptr};
+                size_t Size{0};
+            };
+
+            /**
+             * Forwards to the arena, charging its own subsystem.
+             */
+            class SubsystemResource final : public std::pmr::memory_resource
+            {
+                public:
+                    FrameArena* Arena{nullptr};
+                    MemorySubsystem Subsystem{MemorySubsystem::General};
+
+                protected:
+                    void* do_allocate(size_t bytes, size_t alignment) override { return Arena->Allocate(bytes, alignment, Subsystem); }
+                    void do_deallocate(void*, size_t, size_t) override {}
+                    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+            };
+
+            void* Allocate(size_t bytes, size_t alignment, MemorySubsystem subsystem);
+            void AddChunk(size_t minimumSize);
+            void ReleaseChunks() noexcept;
+
+            std::pmr::memory_resource* upstream_;
+            MemorySubsystem subsystem_;
+            std::vector<Chunk> chunks_{};
+            std::byte* begin_{nullptr};
+            std::byte* cursor_{nullptr};
+            std::byte* end_{nullptr};
+            size_t retiredBytes_{0};    //< Bytes used in chunks before the current one.
+            size_t highWaterMark_{0};
+            std::array<SubsystemResource, static_cast<size_t>(MemorySubsystem::Count)> subsystems_{};
+    };
+
+    /**
+     * @class ObjectPool
+     * @brief Thread-safe memory resource with power-of-two size classes from 16 to 2048 bytes.
+     *
+     * Each thread keeps a small cache of free blocks per size class, so allocating and freeing
+     * does not lock in the common case. Caches exchange blocks with a shared depot in batches.
+     * Blocks may be freed on any thread. Larger or over-aligned requests go to the upstream
+     * resource. Memory is returned to the upstream when the pool and every thread that used it
+     * are gone.
+     */
+    class ObjectPool final : public std::pmr::memory_resource
+    {
+        public:
+            static constexpr size_t MinimumBlockSize = 16;
+            static constexpr size_t MaximumBlockSize = 2048;
+            static constexpr size_t SizeClassCount = 8;
+
+            /**
+             * Creates a pool.
+             * @param subsystem The subsystem allocations are charged to.
+             * @param upstream The resource slabs and large blocks are taken from.
+             */
+            explicit ObjectPool(MemorySubsystem subsystem = MemorySubsystem::General,
+                                std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+            ~ObjectPool() override;
+
+            ObjectPool(const ObjectPool&) = delete;
+            ObjectPool& operator=(const ObjectPool&) = delete;
+            ObjectPool(ObjectPool&&) = delete;
+            ObjectPool& operator=(ObjectPool&&) = delete;
+
+            /**
+             * Returns the process-wide pool of a subsystem. It is never destroyed, so it may be
+             * used from static destructors and threads that outlive main.
+             */
+            [[nodiscard]] static ObjectPool& Shared(MemorySubsystem subsystem);
+
+            /**
+             * Returns the number of slab bytes taken from the upstream resource.
+             */
+            [[nodiscard]] size_t GetReservedBytes() const noexcept;
+
+            /**
+             * Returns the size class index for a request, or SizeClassCount if the pool does not serve it.
+             */
+            [[nodiscard]] static size_t GetSizeClass(size_t bytes, size_t alignment) noexcept;
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        private:
+            std::shared_ptr<Detail::PoolDepot> depot_;
+            std::pmr::memory_resource* upstream_;
+            MemorySubsystem subsystem_;
+    };
+}
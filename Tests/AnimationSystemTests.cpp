@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "AnimationSystem.hpp"
+#include "TestFramework.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore::UI;
+
+namespace
+{
+    bool IsNear(float actual, float expected, float tolerance = 1e-4f)
+    {
+        return std::fabs(actual - expected) <= tolerance;
+    }
+}
+
+WINCORE_TEST(AnimationsInterpolateAndComplete)
+{
+    AnimationSystem system;
+    float opacity = 0.0f;
+    float position[2] = {0.0f, 10.0f};
+    int completed = 0;
+
+    const AnimationHandle fade = system.Animate(1, &opacity, 1.0f, 0ms, 100ms, Easing::Linear, [&completed] { ++completed; });
+    const float to[2] = {100.0f, 20.0f};
+    const AnimationHandle move = system.Animate(2, position, to, 0ms, 200ms, Easing::EaseInOutCubic);
+
+    CHECK_EQ(system.Tick(50ms), size_t{3});
+    CHECK(IsNear(opacity, 0.5f));
+    CHECK(IsNear(position[0], 100.0f * 4.0f * 0.25f * 0.25f * 0.25f));
+    CHECK_EQ(system.GetDirtyWidgets().size(), size_t{2});
+
+    system.Tick(100ms);
+    CHECK_EQ(opacity, 1.0f);
+    CHECK_EQ(completed, 1);
+    CHECK(!system.IsActive(fade));
+    CHECK(system.IsActive(move));
+
+    system.Tick(250ms);
+    CHECK_EQ(position[0], 100.0f);
+    CHECK_EQ(position[1], 20.0f);
+    CHECK(!system.IsActive(move));
+    CHECK_EQ(system.GetStatistics().Completed, uint64_t{2});
+    CHECK_EQ(system.GetStatistics().ActiveLanes, size_t{0});
+}
+
+WINCORE_TEST(EveryEasingStartsAndEndsOnItsValues)
+{
+    AnimationSystem system;
+    std::vector<float> values(37, 0.0f);
+    for (size_t index = 0; index < values.size(); ++index)
+        system.Animate(static_cast<WidgetId>(index), &values[index], static_cast<float>(index), 10s, 1s,
+                       static_cast<Easing>(index % static_cast<size_t>(Easing::Count)));
+
+    system.Tick(10s);
+    for (float value : values)
+        CHECK_EQ(value, 0.0f);
+
+    system.Tick(10500ms);
+    for (size_t index = 1; index < values.size(); ++index)
+        CHECK(values[index] > 0.0f && values[index] < static_cast<float>(index));
+
+    system.Tick(11s);
+    for (size_t index = 0; index < values.size(); ++index)
+        CHECK_EQ(values[index], static_cast<float>(index));
+}
+
+WINCORE_TEST(AnimatingATargetAgainReplacesTheRunningAnimation)
+{
+    AnimationSystem system;
+    float x = 0.0f;
+    bool firstCompleted = false;
+    const AnimationHandle first = system.Animate(3, &x, 10.0f, 0ms, 100ms, Easing::Linear, [&] { firstCompleted = true; });
+    system.Tick(50ms);
+    CHECK(IsNear(x, 5.0f));
+
+    const AnimationHandle second = system.Animate(3, &x, 0.0f, 50ms, 100ms, Easing::Linear);
+    CHECK(!system.IsActive(first));
+    system.Tick(100ms);
+    CHECK(IsNear(x, 2.5f));
+    CHECK_EQ(system.GetStatistics().Cancelled, uint64_t{1});
+
+    system.CancelWidget(3);
+    CHECK(!system.IsActive(second));
+    system.Tick(120ms);
+    CHECK(system.GetDirtyWidgets().empty());
+    CHECK(IsNear(x, 2.5f));
+    CHECK(!firstCompleted);
+}
+
+WINCORE_TEST(CancelWidgetOnlyStopsThatWidgetsRunningAnimations)
+{
+    AnimationSystem system;
+    float values[4] = {};
+    const AnimationHandle done = system.Animate(5, &values[0], 1.0f, 0ms, 10ms, Easing::Linear);
+    const AnimationHandle replaced = system.Animate(5, &values[1], 1.0f, 0ms, 1s, Easing::Linear);
+    const AnimationHandle running = system.Animate(5, &values[2], 1.0f, 0ms, 1s, Easing::Linear);
+    const AnimationHandle other = system.Animate(6, &values[3], 1.0f, 0ms, 1s, Easing::Linear);
+    system.Tick(20ms);
+    CHECK(!system.IsActive(done));
+
+    // The replacement belongs to another widget now.
+    const AnimationHandle replacement = system.Animate(6, &values[1], 0.0f, 20ms, 1s, Easing::Linear);
+    CHECK(!system.IsActive(replaced));
+
+    system.CancelWidget(5);
+    system.CancelWidget(42);
+    CHECK(!system.IsActive(running));
+    CHECK(system.IsActive(other));
+    CHECK(system.IsActive(replacement));
+    CHECK_EQ(system.GetStatistics().Cancelled, uint64_t{2});
+
+    system.CancelWidget(6);
+    CHECK_EQ(system.GetStatistics().ActiveLanes, size_t{0});
+    CHECK_EQ(system.GetStatistics().Cancelled, uint64_t{4});
+}
+
+WINCORE_TEST(CompletionCallbacksCanStartAnimations)
+{
+    AnimationSystem system;
+    float value = 0.0f;
+    int legs = 0;
+    std::function<void()> bounce = [&] {
+        if (++legs < 4)
+            system.Animate(1, &value, legs % 2 ? 0.0f : 1.0f, std::chrono::milliseconds(legs * 100), 100ms, Easing::Linear, bounce);
+    };
+    system.Animate(1, &value, 1.0f, 0ms, 100ms, Easing::Linear, bounce);
+
+    for (int frame = 1; frame <= 50; ++frame)
+        system.Tick(std::chrono::milliseconds(frame * 10));
+    // Up, down, up and down again.
+    CHECK_EQ(legs, 4);
+    CHECK_EQ(value, 0.0f);
+    CHECK_EQ(system.GetStatistics().ActiveLanes, size_t{0});
+}
+
+WINCORE_TEST(ThrowingCompletionCallbacksDoNotStrandOtherAnimations)
+{
+    AnimationSystem system;
+    float values[4] = {};
+    int completed = 0;
+    auto fail = [&completed] {
+        ++completed;
+        throw std::runtime_error("The callback failed.");
+    };
+    const AnimationHandle first = system.Animate(1, &values[0], 1.0f, 0ms, 100ms, Easing::Linear, fail);
+    const AnimationHandle second = system.Animate(1, &values[1], 1.0f, 0ms, 100ms, Easing::EaseOutCubic, [&completed] { ++completed; });
+    const AnimationHandle third = system.Animate(2, &values[2], 1.0f, 0ms, 100ms, Easing::SmoothStep, fail);
+    system.Animate(3, &values[3], 1.0f, 0ms, 200ms, Easing::Linear);
+
+    // Every callback runs and every finished animation is gone, the first failure is rethrown.
+    CHECK_THROWS_AS(system.Tick(100ms), std::runtime_error);
+    CHECK_EQ(completed, 3);
+    CHECK(!system.IsActive(first) && !system.IsActive(second) && !system.IsActive(third));
+    CHECK_EQ(system.GetStatistics().Completed, uint64_t{3});
+    CHECK_EQ(system.GetStatistics().ActiveLanes, size_t{1});
+    CHECK(values[0] == 1.0f && values[1] == 1.0f && values[2] == 1.0f);
+
+    system.Tick(200ms);
+    CHECK_EQ(completed, 3);
+    CHECK_EQ(values[3], 1.0f);
+    CHECK_EQ(system.GetStatistics().ActiveLanes, size_t{0});
+}
+
+WINCORE_TEST(DirtyWidgetsAreListedOnceForSparseIds)
+{
+    AnimationSystem system;
+    const WidgetId ids[] = {std::numeric_limits<WidgetId>::max(), 7, 4000000000u, 7};
+    float values[4][2] = {};
+    const float to[2] = {1.0f, 2.0f};
+    for (size_t index = 0; index < 4; ++index)
+        system.Animate(ids[index], values[index], to, 0ms, 1s, static_cast<Easing>(index % 2));
+
+    system.Tick(500ms);
+    const std::span<const WidgetId> dirty = system.GetDirtyWidgets();
+    std::vector<WidgetId> sorted(dirty.begin(), dirty.end());
+    std::sort(sorted.begin(), sorted.end());
+    const std::vector<WidgetId> expected{7, 4000000000u, std::numeric_limits<WidgetId>::max()};
+    CHECK(sorted == expected);
+}
+
+WINCORE_TEST(DirtyWidgetsAreListedOnceForManyWidgets)
+{
+    AnimationSystem system;
+    std::vector<float> values(20000, 0.0f);
+    for (size_t index = 0; index < values.size(); ++index)
+        system.Animate(static_cast<WidgetId>((index % 5000) * 7919), &values[index], 1.0f, 0ms, 1s,
+                       static_cast<Easing>(index % static_cast<size_t>(Easing::Count)));
+
+    for (int frame = 1; frame <= 3; ++frame)
+    {
+        system.Tick(std::chrono::milliseconds(frame * 16));
+        std::vector<WidgetId> sorted(system.GetDirtyWidgets().begin(), system.GetDirtyWidgets().end());
+        std::sort(sorted.begin(), sorted.end());
+        CHECK_EQ(sorted.size(), size_t{5000});
+        CHECK(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    }
+}
+
+WINCORE_TEST(TimesStayPreciseAfterLongIdlePeriods)
+{
+    AnimationSystem system;
+    float warmup = 0.0f;
+    system.Animate(1, &warmup, 1.0f, 0ms, 10ms, Easing::Linear);
+    system.Tick(10ms);
+
+    // A week later a 16 ms animation still lands on its frames, float seconds since the first start could not.
+    constexpr std::chrono::nanoseconds week = std::chrono::hours(24 * 7);
+    float value = 0.0f;
+    system.Animate(1, &value, 16.0f, week, 16ms, Easing::Linear);
+    system.Tick(week + 4ms);
+    CHECK(IsNear(value, 4.0f, 1e-3f));
+    system.Tick(week + 8ms);
+    CHECK(IsNear(value, 8.0f, 1e-3f));
+}
+
+WINCORE_TEST(TimesStayPreciseAcrossRebases)
+{
+    AnimationSystem system;
+    float slow = 0.0f;
+    float fast = 0.0f;
+    constexpr std::chrono::nanoseconds day = std::chrono::hours(24);
+
+    // A lane running for days keeps the system rebasing, a short one started late must still be exact.
+    system.Animate(1, &slow, 1.0f, 0ms, 10 * day, Easing::Linear);
+    for (std::chrono::nanoseconds now = 0ns; now < 3 * day; now += std::chrono::minutes(7))
+        system.Tick(now);
+
+    const std::chrono::nanoseconds start = 3 * day + 123ms;
+    system.Animate(2, &fast, 10.0f, start, 10ms, Easing::Linear);
+    system.Tick(start + 5ms);
+    CHECK(IsNear(fast, 5.0f, 1e-2f));
+    CHECK(IsNear(slow, 0.3f, 1e-3f));
+}
+
+WINCORE_TEST(InvalidArgumentsThrow)
+{
+    AnimationSystem system;
+    float value = 0.0f;
+    CHECK_THROWS_AS(system.Animate(1, nullptr, 1.0f, 0ms, 1s), std::invalid_argument);
+    CHECK_THROWS_AS(system.Animate(1, &value, std::span<const float>{}, 0ms, 1s), std::invalid_argument);
+    CHECK_THROWS_AS(system.Animate(1, &value, 1.0f, 0ms, 1s, Easing::Count), std::invalid_argument);
+}
@@ -0,0 +1,291 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Async.hpp"
+#include "TestFramework.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore::Core;
+
+namespace
+{
+    /**
+     * Runs the dispatcher of the calling thread until the flag is set or ten seconds have passed.
+     */
+    bool RunUntil(UiDispatcher& ui, const bool& flag)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + 10s;
+        while (!flag && std::chrono::steady_clock::now() < deadline)
+            ui.WaitAndRunPending(10ms);
+        return flag;
+    }
+
+    Task<void> CountAfterDelay(std::chrono::milliseconds duration, std::atomic<int>& completed)
+    {
+        co_await Delay(duration);
+        ++completed;
+    }
+
+    Task<void> AwaitDelay(std::chrono::milliseconds duration, CancellationToken token, bool& cancelled, bool& finished)
+    {
+        try
+        {
+            co_await Delay(duration, std::move(token));
+        }
+        catch (const OperationCancelled&)
+        {
+            cancelled = true;
+        }
+        finished = true;
+    }
+
+    Task<void> AwaitDelayOffThread(std::chrono::milliseconds duration, CancellationToken token, std::promise<bool>& cancelled)
+    {
+        try
+        {
+            co_await Delay(duration, std::move(token));
+            cancelled.set_value(false);
+        }
+        catch (const OperationCancelled&)
+        {
+            cancelled.set_value(true);
+        }
+    }
+
+    Task<int> ProduceValue(bool fail)
+    {
+        if (fail)
+            throw std::invalid_argument("The task failed.");
+        co_return 42;
+    }
+
+    Task<int> ProduceValueOnPool()
+    {
+        co_await ResumeOnPool();
+        throw std::invalid_argument("The pool task failed.");
+    }
+
+    Task<void> AwaitFailures(UiDispatcher& ui, int& value, std::vector<std::string>& failures, bool& done)
+    {
+        value = co_await ProduceValue(false);
+        try
+        {
+            co_await ProduceValue(true);
+        }
+        catch (const std::invalid_argument& exception)
+        {
+            failures.emplace_back(exception.what());
+        }
+
+        // The awaiting coroutine continues on the pool thread the task failed on.
+        try
+        {
+            co_await ProduceValueOnPool();
+        }
+        catch (const std::invalid_argument& exception)
+        {
+            failures.emplace_back(exception.what());
+        }
+        co_await ResumeOnUiThread(ui);
+        done = true;
+    }
+
+    Task<void> HopBetweenThreads(UiDispatcher& ui, size_t hops, std::vector<std::thread::id>& threads, bool& done)
+    {
+        for (size_t hop = 0; hop < hops; ++hop)
+        {
+            co_await ResumeOnPool(TaskPriority::Interactive);
+            threads.push_back(ThreadPool::Shared().IsWorkerThread() ? std::this_thread::get_id() : std::thread::id{});
+            co_await ResumeOnUiThread(ui);
+            threads.push_back(std::this_thread::get_id());
+        }
+        done = true;
+    }
+
+    Task<void> ResumeOnEndedThread(UiDispatcherReference dispatcher, std::promise<bool>& failed)
+    {
+        co_await ResumeOnPool();
+        try
+        {
+            co_await ResumeOnUiThread(dispatcher);
+            failed.set_value(false);
+        }
+        catch (const std::runtime_error&)
+        {
+            failed.set_value(true);
+        }
+    }
+}
+
+WINCORE_TEST(RunPendingDoesNotRerunWorkAfterAnException)
+{
+    UiDispatcher ui;
+    std::vector<int> order;
+    ui.Post([&order] { order.push_back(1); });
+    ui.Post([&order] {
+        order.push_back(2);
+        throw std::runtime_error("The work failed.");
+    });
+    ui.Post([&order] { order.push_back(3); });
+
+    CHECK_THROWS_AS(ui.RunPending(), std::runtime_error);
+    CHECK((order == std::vector<int>{1, 2}));
+
+    // Only the items after the failed one are left.
+    CHECK_EQ(ui.RunPending(), size_t{1});
+    CHECK((order == std::vector<int>{1, 2, 3}));
+    CHECK_EQ(ui.RunPending(), size_t{0});
+}
+
+WINCORE_TEST(NestedRunPendingRunsEveryItemOnce)
+{
+    UiDispatcher ui;
+    int outer = 0;
+    int posted = 0;
+    int queued = 0;
+    ui.Post([&] {
+        ++outer;
+        ui.Post([&posted] { ++posted; });
+        ui.RunPending();
+    });
+    ui.Post([&queued] { ++queued; });
+
+    // The nested call runs what the first item posted, the outer batch keeps the second item.
+    CHECK_EQ(ui.RunPending(), size_t{2});
+    CHECK_EQ(outer, 1);
+    CHECK_EQ(posted, 1);
+    CHECK_EQ(queued, 1);
+    CHECK_EQ(ui.RunPending(), size_t{0});
+}
+
+WINCORE_TEST(TimersPostedWhileTheTimerThreadWaitsAllRun)
+{
+    // Without a UiDispatcher the delays go through the timer thread, which is waiting on the
+    // earliest deadline while later ones grow its queue.
+    CHECK(UiDispatcher::Current() == nullptr);
+    constexpr int TaskCount = 300;
+    std::atomic<int> completed{0};
+    for (int index = 0; index < TaskCount; ++index)
+        StartDetached(CountAfterDelay(std::chrono::milliseconds(1 + (index * 7) % 30), completed));
+
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (completed.load() < TaskCount && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+    CHECK_EQ(completed.load(), TaskCount);
+}
+
+WINCORE_TEST(DispatcherReferencesOutliveTheDispatcher)
+{
+    UiDispatcherReference reference;
+    CHECK(!reference.Post([] {}));
+    {
+        UiDispatcher ui;
+        reference = ui.GetReference();
+        CHECK(reference.Post([] {}));
+        const uint64_t timer = reference.PostAt(UiDispatcher::Clock::now() + 1h, [] {});
+        CHECK(timer != 0);
+        CHECK(reference.CancelTimer(timer));
+        CHECK(!reference.CancelTimer(timer));
+        reference.PostAt(UiDispatcher::Clock::now() + 1h, [] {});
+    }
+
+    // Queued work and timers die with the dispatcher, later posts are dropped.
+    CHECK(!reference.Post([] {}));
+    CHECK_EQ(reference.PostAt(UiDispatcher::Clock::now(), [] {}), uint64_t{0});
+    CHECK(!reference.CancelTimer(1));
+
+    UiDispatcher next;
+    CHECK(!reference.Post([] {}));
+    CHECK_EQ(next.RunPending(), size_t{0});
+
+    std::promise<bool> failed;
+    StartDetached(ResumeOnEndedThread(reference, failed));
+    std::future<bool> result = failed.get_future();
+    CHECK(result.wait_for(10s) == std::future_status::ready);
+    CHECK(result.get());
+}
+
+WINCORE_TEST(CancelledDelaysResumeEarlyAndDropTheirTimer)
+{
+    UiDispatcher ui;
+    CancellationSource source;
+    bool cancelled = false;
+    bool finished = false;
+    StartDetached(AwaitDelay(1h, source.GetToken(), cancelled, finished));
+    CHECK(ui.GetNextDeadline().has_value());
+    CHECK(!finished);
+
+    source.Cancel();
+    CHECK(RunUntil(ui, finished));
+    CHECK(cancelled);
+    CHECK(!ui.GetNextDeadline().has_value());
+
+    // Delays that are not cancelled run to their deadline on the same thread.
+    cancelled = false;
+    finished = false;
+    CancellationSource unused;
+    StartDetached(AwaitDelay(1ms, unused.GetToken(), cancelled, finished));
+    CHECK(RunUntil(ui, finished));
+    CHECK(!cancelled);
+
+    // A token that is already cancelled does not wait at all.
+    cancelled = false;
+    finished = false;
+    StartDetached(AwaitDelay(1h, source.GetToken(), cancelled, finished));
+    CHECK(RunUntil(ui, finished));
+    CHECK(cancelled);
+    CHECK(!ui.GetNextDeadline().has_value());
+}
+
+WINCORE_TEST(CancelledDelaysResumeOnThePoolOffTheUiThread)
+{
+    CancellationSource source;
+    std::promise<bool> cancelled;
+    std::future<bool> result = cancelled.get_future();
+    std::thread([&source, &cancelled] { StartDetached(AwaitDelayOffThread(1h, source.GetToken(), cancelled)); }).join();
+    CHECK(result.wait_for(0s) == std::future_status::timeout);
+
+    source.Cancel();
+    CHECK(result.wait_for(10s) == std::future_status::ready);
+    CHECK(result.get());
+}
+
+WINCORE_TEST(TaskExceptionsPropagateToTheAwaiter)
+{
+    UiDispatcher ui;
+    int value = 0;
+    std::vector<std::string> failures;
+    bool done = false;
+    StartDetached(AwaitFailures(ui, value, failures, done));
+    CHECK(RunUntil(ui, done));
+    CHECK_EQ(value, 42);
+    CHECK((failures == std::vector<std::string>{"The task failed.", "The pool task failed."}));
+
+    // Exceptions escaping a detached task are logged, not thrown at the caller.
+    StartDetached([]() -> Task<void> {
+        co_await ProduceValue(true);
+    }());
+}
+
+WINCORE_TEST(CoroutinesHopBetweenThePoolAndTheUiThread)
+{
+    UiDispatcher ui;
+    constexpr size_t Hops = 50;
+    std::vector<std::thread::id> threads;
+    bool done = false;
+    StartDetached(HopBetweenThreads(ui, Hops, threads, done));
+    CHECK(RunUntil(ui, done));
+
+    CHECK_EQ(threads.size(), Hops * 2);
+    for (size_t index = 0; index < threads.size(); index += 2)
+    {
+        CHECK(threads[index] != std::thread::id{});
+        CHECK(threads[index] != std::this_thread::get_id());
+        CHECK(threads[index + 1] == std::this_thread::get_id());
+    }
+}
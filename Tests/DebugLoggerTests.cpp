@@ -0,0 +1,206 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DebugLogger.hpp"
+#include "TestFramework.hpp"
+
+using namespace WinCore::Utils;
+
+namespace
+{
+    /**
+     * A file in the temporary directory, deleted when the test ends.
+     */
+    class TemporaryFile
+    {
+        public:
+            explicit TemporaryFile(const std::string& name)
+                : path_((std::filesystem::temp_directory_path() / ("WinCore" + name)).string())
+            {
+                std::filesystem::remove(path_);
+            }
+
+            ~TemporaryFile() { std::filesystem::remove(path_); }
+
+            TemporaryFile(const TemporaryFile&) = delete;
+            TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+            [[nodiscard]] const std::string& GetPath() const noexcept { return path_; }
+
+            std::string Read() const
+            {
+                std::ifstream file(path_, std::ios::binary);
+                return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+
+        private:
+            std::string path_;
+    };
+
+    /**
+     * Settings that only write to files, so the tests neither print nor hook the process.
+     */
+    DebugLoggerSettings FileSettings(LogOutput outputs)
+    {
+        DebugLoggerSettings settings{};
+        settings.Outputs = outputs;
+        settings.InstallCrashHandlers = false;
+        return settings;
+    }
+
+    size_t CountLines(const std::string& text)
+    {
+        size_t lines = 0;
+        for (const char character : text)
+            lines += character == '\n' ? 1 : 0;
+        return lines;
+    }
+
+    /**
+     * Returns the message of every line, without the timestamp, level, thread and site prefix.
+     */
+    std::vector<std::string> GetMessages(const std::string& text)
+    {
+        std::vector<std::string> messages;
+        size_t start = 0;
+        for (size_t end = text.find('\n'); end != std::string::npos; start = end + 1, end = text.find('\n', start))
+        {
+            const std::string line = text.substr(start, end - start);
+            const size_t message = line.find("): ");
+            messages.push_back(message == std::string::npos ? line : line.substr(message + 3));
+        }
+        return messages;
+    }
+
+    enum class Mode : uint8_t
+    {
+        First = 1,
+        Third = 3
+    };
+}
+
+WINCORE_TEST(RingBufferRecordsWrapAroundTheEnd)
+{
+    Detail::LogRingBuffer buffer(1000, 5);
+    CHECK_EQ(buffer.GetCapacity(), size_t{1024});
+    CHECK_EQ(buffer.GetThreadIndex(), uint32_t{5});
+
+    std::vector<uint8_t> first(700);
+    for (size_t index = 0; index < first.size(); ++index)
+        first[index] = static_cast<uint8_t>(index);
+    CHECK(buffer.TryReserve(first.size()));
+    buffer.Write(0, first.data(), first.size());
+    buffer.Commit(first.size());
+
+    // Only 324 bytes are left until the first record is consumed.
+    CHECK(!buffer.TryReserve(400));
+    std::vector<uint8_t> read(first.size());
+    buffer.Read(buffer.GetTail(), read.data(), read.size());
+    CHECK(read == first);
+    buffer.Consume(buffer.GetHead());
+
+    // The second record starts at 700 and continues at the start of the storage.
+    std::vector<uint8_t> second(600);
+    for (size_t index = 0; index < second.size(); ++index)
+        second[index] = static_cast<uint8_t>(255 - index % 256);
+    CHECK(buffer.TryReserve(second.size()));
+    buffer.Write(0, second.data(), 100);
+    buffer.Write(100, second.data() + 100, second.size() - 100);
+    buffer.Commit(second.size());
+    CHECK_EQ(buffer.GetHead(), uint64_t{1300});
+
+    read.assign(second.size(), 0);
+    buffer.Read(buffer.GetTail(), read.data(), read.size());
+    CHECK(read == second);
+    buffer.Consume(buffer.GetHead());
+    CHECK(buffer.TryReserve(buffer.GetCapacity()));
+    CHECK(!buffer.TryReserve(buffer.GetCapacity() + 1));
+}
+
+WINCORE_TEST(DropPolicyCountsEveryRecordItDiscards)
+{
+    TemporaryFile text("DebugLoggerDrop.log");
+    DebugLoggerSettings settings = FileSettings(LogOutput::TextFile);
+    settings.TextFilePath = text.GetPath();
+    settings.ThreadBufferSize = 1024;
+    settings.OverflowPolicy = LogOverflowPolicy::Drop;
+    DebugLogger::Start(settings);
+
+    // Far more than the background thread drains while this thread keeps logging.
+    constexpr size_t RecordCount = 20000;
+    const std::string padding(64, 'x');
+    for (size_t index = 0; index < RecordCount; ++index)
+        WINCORE_LOG_INFO("Record {} {}", index, padding);
+    const uint64_t dropped = DebugLogger::GetDroppedCount();
+    DebugLogger::Stop();
+
+    CHECK(dropped > 0);
+    CHECK_EQ(CountLines(text.Read()) + dropped, uint64_t{RecordCount});
+}
+
+WINCORE_TEST(BlockPolicyKeepsEveryRecord)
+{
+    TemporaryFile text("DebugLoggerBlock.log");
+    DebugLoggerSettings settings = FileSettings(LogOutput::TextFile);
+    settings.TextFilePath = text.GetPath();
+    settings.ThreadBufferSize = 1024;
+    settings.OverflowPolicy = LogOverflowPolicy::Block;
+    DebugLogger::Start(settings);
+
+    constexpr size_t RecordCount = 20000;
+    const std::string padding(64, 'x');
+    for (size_t index = 0; index < RecordCount; ++index)
+        WINCORE_LOG_INFO("Record {} {}", index, padding);
+
+    // A record larger than the whole buffer can never fit and is dropped instead of blocking forever.
+    WINCORE_LOG_INFO("Oversized {}", std::string(2048, 'y'));
+    const uint64_t dropped = DebugLogger::GetDroppedCount();
+    DebugLogger::Stop();
+
+    CHECK_EQ(dropped, uint64_t{1});
+    const std::vector<std::string> messages = GetMessages(text.Read());
+    CHECK_EQ(messages.size(), RecordCount);
+    CHECK_EQ(messages.front(), "Record 0 " + padding);
+    CHECK_EQ(messages.back(), "Record " + std::to_string(RecordCount - 1) + " " + padding);
+}
+
+WINCORE_TEST(BinaryLogDecodesEveryArgumentKind)
+{
+    TemporaryFile text("DebugLoggerRoundTrip.log");
+    TemporaryFile binary("DebugLoggerRoundTrip.bin");
+    TemporaryFile decoded("DebugLoggerRoundTrip.txt");
+    DebugLoggerSettings settings = FileSettings(LogOutput::TextFile | LogOutput::BinaryFile);
+    settings.TextFilePath = text.GetPath();
+    settings.BinaryFilePath = binary.GetPath();
+    DebugLogger::Start(settings);
+
+    char buffer[16] = "buffer";
+    const char* nullText = nullptr;
+    const wchar_t* nullWide = nullptr;
+    const std::string owned = "string";
+    const std::string_view view = std::string_view("view and more").substr(0, 4);
+    const std::wstring wide = L"wide é\U0001F600";
+    const void* pointer = reinterpret_cast<const void*>(uintptr_t{0x1234});
+    WINCORE_LOG_INFO("{} {} {} {} {}", true, false, 'c', int16_t{-42}, uint64_t{18446744073709551615ull});
+    WINCORE_LOG_WARNING("{} {} {} {} {} {}", 2.5, "literal", buffer, nullText, owned, view);
+    WINCORE_LOG_ERROR("{} {} {} {} {} {{}}", wide, L"literal", nullWide, pointer, Mode::Third);
+    WINCORE_LOG_DEBUG("missing {} {}", 1);
+    DebugLogger::Stop();
+
+    DebugLogger::DecodeBinaryLog(binary.GetPath(), decoded.GetPath());
+    const std::string written = text.Read();
+    CHECK_EQ(decoded.Read(), written);
+
+    const std::vector<std::string> messages = GetMessages(written);
+    CHECK_EQ(messages.size(), size_t{4});
+    CHECK_EQ(messages[0], std::string("true false c -42 18446744073709551615"));
+    CHECK_EQ(messages[1], std::string("2.5 literal buffer (null) string view"));
+    CHECK_EQ(messages[2], std::string("wide \xC3\xA9\xF0\x9F\x98\x80 literal (null) 0x0000000000001234 3 {}"));
+    CHECK_EQ(messages[3], std::string("missing 1 {}"));
+    CHECK(written.find("[WARN ]") != std::string::npos);
+}
@@ -0,0 +1,274 @@
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "FrameScheduler.hpp"
+#include "TestFramework.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore::Core;
+
+namespace
+{
+    // At 100 Hz the refreshes fall on whole multiples of 10 ms from the registration time.
+    constexpr uint32_t RefreshRate = 100;
+
+    const void* const WindowA = reinterpret_cast<const void*>(uintptr_t{0x1000});
+    const void* const WindowB = reinterpret_cast<const void*>(uintptr_t{0x2000});
+    const void* const WindowC = reinterpret_cast<const void*>(uintptr_t{0x3000});
+
+    /**
+     * A scheduler on a manual clock that records wake requests and frames.
+     */
+    struct Harness
+    {
+        ManualFrameClock Clock{};
+        FrameScheduler Scheduler{Clock, 64};
+        std::vector<std::chrono::nanoseconds> Wakes{};
+        std::vector<FrameContext> Frames{};
+
+        Harness()
+        {
+            Scheduler.SetWakeCallback([this](std::chrono::nanoseconds deadline) { Wakes.push_back(deadline); });
+        }
+
+        FrameCallbacks Recording(std::chrono::nanoseconds paintTime = 0ns)
+        {
+            FrameCallbacks callbacks{};
+            callbacks.Paint = [this, paintTime](const FrameContext& context) {
+                Frames.push_back(context);
+                Clock.Advance(paintTime);
+            };
+            return callbacks;
+        }
+    };
+}
+
+WINCORE_TEST(InvalidationsBeforeTheRefreshAreCoalesced)
+{
+    Harness harness;
+    int layouts = 0;
+    FrameCallbacks callbacks = harness.Recording();
+    callbacks.Layout = [&layouts](const FrameContext&) { ++layouts; };
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, callbacks);
+
+    harness.Clock.Set(3ms);
+    harness.Scheduler.Invalidate(WindowA);
+    harness.Clock.Set(5ms);
+    harness.Scheduler.Invalidate(WindowA, FrameDirty::Layout);
+    harness.Scheduler.Invalidate(WindowA);
+
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(10ms));
+    CHECK_EQ(harness.Wakes.size(), size_t{1});
+    CHECK(harness.Wakes[0] == 10ms);
+
+    harness.Clock.Set(9ms);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{0});
+    harness.Clock.Set(10ms);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+
+    CHECK_EQ(harness.Frames.size(), size_t{1});
+    CHECK_EQ(layouts, 1);
+    CHECK(HasFrameDirty(harness.Frames[0].Dirty, FrameDirty::Layout));
+    CHECK(HasFrameDirty(harness.Frames[0].Dirty, FrameDirty::Paint));
+    CHECK(harness.Frames[0].VsyncTime == 10ms);
+    CHECK(harness.Frames[0].Deadline == 20ms);
+    CHECK_EQ(harness.Scheduler.GetStatistics().Invalidations, uint64_t{3});
+    CHECK_EQ(harness.Scheduler.GetStatistics().CoalescedInvalidations, uint64_t{2});
+    CHECK(!harness.Scheduler.GetNextDeadline());
+}
+
+WINCORE_TEST(CleanWindowsProduceNoFrames)
+{
+    Harness harness;
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, harness.Recording());
+
+    for (int refresh = 0; refresh < 10; ++refresh)
+    {
+        harness.Clock.Advance(10ms);
+        CHECK_EQ(harness.Scheduler.Tick(), size_t{0});
+    }
+    CHECK(harness.Frames.empty());
+    CHECK(harness.Wakes.empty());
+
+    // A frame at 10 ms, then nothing until an invalidation at 55 ms: the refreshes at 20..50 ms were skipped.
+    harness.Clock.Set(1ms);
+    harness.Scheduler.Invalidate(WindowA);
+    harness.Clock.Set(10ms);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+    harness.Clock.Set(55ms);
+    harness.Scheduler.Invalidate(WindowA);
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(60ms));
+    CHECK_EQ(harness.Scheduler.GetStatistics().IdleRefreshes, uint64_t{4});
+}
+
+WINCORE_TEST(InvalidationsDuringAFrameGoToTheNextRefresh)
+{
+    Harness harness;
+    FrameCallbacks callbacks = harness.Recording();
+    bool again = true;
+    callbacks.Paint = [&](const FrameContext& context) {
+        harness.Frames.push_back(context);
+        if (std::exchange(again, false))
+            harness.Scheduler.Invalidate(WindowA);
+    };
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, callbacks);
+
+    harness.Scheduler.Invalidate(WindowA);
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(0ms));
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+
+    // At most one frame per refresh, even when ticked again on the same one.
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(10ms));
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{0});
+    CHECK(harness.Wakes.back() == 10ms);
+
+    harness.Clock.Set(10ms);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+    CHECK_EQ(harness.Frames[1].FrameIndex, uint64_t{1});
+}
+
+WINCORE_TEST(RefreshRateChangesMoveThePendingFrame)
+{
+    Harness harness;
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, harness.Recording());
+
+    harness.Clock.Set(2ms);
+    harness.Scheduler.Invalidate(WindowA);
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(10ms));
+
+    // 50 Hz with the phase restarting at 4 ms.
+    harness.Clock.Set(4ms);
+    harness.Scheduler.SetRefreshRate(WindowA, 50);
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(4ms));
+
+    harness.Scheduler.SetVsyncTime(WindowA, 7ms);
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(7ms));
+
+    harness.Clock.Set(7ms);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+    CHECK(harness.Frames[0].RefreshInterval == 20ms);
+    CHECK(harness.Frames[0].Deadline == 27ms);
+
+    harness.Scheduler.Invalidate(WindowA);
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(27ms));
+
+    // Rates Windows reports as "hardware default" fall back to 60 Hz.
+    harness.Scheduler.SetRefreshRate(WindowA, 1);
+    harness.Clock.Set(40ms);
+    harness.Scheduler.Tick();
+    CHECK(harness.Frames.back().RefreshInterval == std::chrono::nanoseconds{16666667});
+}
+
+WINCORE_TEST(SlowFramesCountAsMissedDeadlines)
+{
+    Harness harness;
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, harness.Recording(4ms));
+    harness.Scheduler.RegisterWindow(WindowB, RefreshRate, harness.Recording(15ms));
+
+    harness.Scheduler.Invalidate(WindowA);
+    harness.Scheduler.Invalidate(WindowB);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{2});
+
+    // B misses its deadline however the two are ordered, A only if it runs after B.
+    const FrameSchedulerStatistics& statistics = harness.Scheduler.GetStatistics();
+    CHECK_EQ(statistics.Frames, uint64_t{2});
+    CHECK(statistics.MissedDeadlines >= 1 && statistics.MissedDeadlines <= 2);
+}
+
+WINCORE_TEST(PercentilesCoverTheRecentFrames)
+{
+    Harness harness;
+    std::chrono::nanoseconds paintTime = 1ms;
+    FrameCallbacks callbacks{};
+    callbacks.Paint = [&](const FrameContext&) { harness.Clock.Advance(paintTime); };
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, callbacks);
+
+    CHECK_EQ(harness.Scheduler.GetFrameTimePercentile(50.0), 0.0);
+    CHECK_EQ(harness.Scheduler.GetInputLatencyPercentile(50.0), 0.0);
+
+    // 100 frames taking 1..100 ms, with input arriving 2 ms before each frame starts.
+    for (int frame = 1; frame <= 100; ++frame)
+    {
+        harness.Clock.Set(std::chrono::milliseconds(frame * 1000));
+        paintTime = std::chrono::milliseconds(frame);
+        harness.Scheduler.RecordInput(WindowA, harness.Clock.Now() - 2ms);
+        harness.Scheduler.RecordInput(WindowA, harness.Clock.Now() - 1ms);
+        harness.Scheduler.Invalidate(WindowA);
+        CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+    }
+
+    // The ring keeps the last 64 frames, 37..100 ms.
+    CHECK_EQ(harness.Scheduler.GetFrameTimePercentile(0.0), 37.0);
+    CHECK_EQ(harness.Scheduler.GetFrameTimePercentile(100.0), 100.0);
+    CHECK_EQ(harness.Scheduler.GetFrameTimePercentile(50.0), 69.0);
+    CHECK_EQ(harness.Scheduler.GetInputLatencyPercentile(100.0), 102.0);
+    CHECK_EQ(harness.Scheduler.GetInputLatencyPercentile(-5.0), 39.0);
+}
+
+WINCORE_TEST(UnregisteringDuringAFrameIsDeferred)
+{
+    Harness harness;
+    FrameCallbacks callbacks = harness.Recording();
+    callbacks.Present = [&](const FrameContext&) {
+        harness.Scheduler.UnregisterWindow(WindowA);
+        harness.Scheduler.UnregisterWindow(WindowB);
+    };
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, callbacks);
+    harness.Scheduler.RegisterWindow(WindowB, RefreshRate, callbacks);
+
+    harness.Scheduler.Invalidate(WindowA);
+    harness.Scheduler.Invalidate(WindowB);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+    CHECK_THROWS_AS(harness.Scheduler.Invalidate(WindowA), std::runtime_error);
+    CHECK_THROWS_AS(harness.Scheduler.Invalidate(WindowB), std::runtime_error);
+
+    // Erased once the tick ended, so the windows can be registered again.
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, harness.Recording());
+    CHECK_THROWS_AS(harness.Scheduler.RegisterWindow(WindowA, RefreshRate, harness.Recording()), std::runtime_error);
+}
+
+WINCORE_TEST(ThrowingCallbacksLeaveTheSchedulerUsable)
+{
+    Harness harness;
+    bool throwNext = true;
+    const void* failedWindow = nullptr;
+    FrameCallbacks callbacks = harness.Recording();
+    callbacks.Paint = [&](const FrameContext& context) {
+        harness.Scheduler.UnregisterWindow(WindowC);
+        if (std::exchange(throwNext, false))
+        {
+            failedWindow = context.Window;
+            throw std::runtime_error("paint failed");
+        }
+        harness.Frames.push_back(context);
+    };
+    harness.Scheduler.RegisterWindow(WindowA, RefreshRate, callbacks);
+    harness.Scheduler.RegisterWindow(WindowB, RefreshRate, callbacks);
+    harness.Scheduler.RegisterWindow(WindowC, RefreshRate, harness.Recording());
+
+    harness.Scheduler.Invalidate(WindowA);
+    harness.Scheduler.Invalidate(WindowB);
+    harness.Wakes.clear();
+    CHECK_THROWS_AS(harness.Scheduler.Tick(), std::runtime_error);
+
+    // The window removed by the failing frame is gone.
+    CHECK_THROWS_AS(harness.Scheduler.Invalidate(WindowC), std::runtime_error);
+
+    // The window that was not rendered is still due and woke the loop again.
+    const void* otherWindow = failedWindow == WindowA ? WindowB : WindowA;
+    CHECK(harness.Scheduler.GetNextDeadline() == std::optional<std::chrono::nanoseconds>(0ms));
+    CHECK_EQ(harness.Wakes.size(), size_t{1});
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+    CHECK(harness.Frames.back().Window == otherWindow);
+
+    // Invalidations wake the loop again.
+    harness.Wakes.clear();
+    harness.Scheduler.Invalidate(failedWindow);
+    CHECK_EQ(harness.Wakes.size(), size_t{1});
+    CHECK(harness.Wakes[0] == 10ms);
+    harness.Clock.Set(10ms);
+    CHECK_EQ(harness.Scheduler.Tick(), size_t{1});
+    CHECK(harness.Frames.back().Window == failedWindow);
+}
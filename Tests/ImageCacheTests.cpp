@@ -0,0 +1,217 @@
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Async.hpp"
+#include "ImageCache.hpp"
+#include "ImageResampler.hpp"
+#include "TestBitmaps.hpp"
+#include "TestFramework.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore;
+using namespace WinCore::UI;
+using WinCore::Tests::MakeRandomPremultiplied;
+
+namespace
+{
+    /**
+     * Occupies the only worker of a pool until released, so jobs queued meanwhile wait.
+     */
+    class PoolGate
+    {
+        public:
+            explicit PoolGate(Core::ThreadPool& pool)
+            {
+                std::future<void> running = started_.get_future();
+                pool.Submit([this, release = release_.get_future().share()] {
+                    started_.set_value();
+                    release.wait();
+                }, Core::TaskPriority::Interactive);
+                running.wait();
+            }
+
+            ~PoolGate() { Open(); }
+
+            PoolGate(const PoolGate&) = delete;
+            PoolGate& operator=(const PoolGate&) = delete;
+
+            void Open()
+            {
+                if (!opened_)
+                    release_.set_value();
+                opened_ = true;
+            }
+
+        private:
+            std::promise<void> started_{};
+            std::promise<void> release_{};
+            bool opened_{false};
+    };
+
+    /**
+     * The outcome of one RequestVariant callback.
+     */
+    struct Delivery
+    {
+        std::shared_ptr<const Bitmap> Variant{};
+        std::exception_ptr Failure{};
+    };
+
+    /**
+     * Runs the dispatcher of the calling thread until the expected number of callbacks has arrived.
+     */
+    bool RunUntil(Core::UiDispatcher& ui, const std::vector<Delivery>& deliveries, size_t expected)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + 10s;
+        while (deliveries.size() < expected && std::chrono::steady_clock::now() < deadline)
+            ui.WaitAndRunPending(10ms);
+        return deliveries.size() == expected;
+    }
+
+    ImageCache::VariantCallback Collect(std::vector<Delivery>& deliveries)
+    {
+        return [&deliveries](std::shared_ptr<const Bitmap> variant, std::exception_ptr failure) {
+            deliveries.push_back(Delivery{std::move(variant), failure});
+        };
+    }
+}
+
+WINCORE_TEST(ScaleForDpiRoundsToTheNearestPixel)
+{
+    CHECK_EQ(ImageCache::ScaleForDpi(100, 96), uint32_t{100});
+    CHECK_EQ(ImageCache::ScaleForDpi(100, 144), uint32_t{150});
+    CHECK_EQ(ImageCache::ScaleForDpi(3, 120), uint32_t{4});
+    CHECK_EQ(ImageCache::ScaleForDpi(10, 72), uint32_t{8});
+    CHECK_EQ(ImageCache::ScaleForDpi(1, 120), uint32_t{1});
+    CHECK_EQ(ImageCache::ScaleForDpi(0, 96), uint32_t{1});
+    CHECK_EQ(ImageCache::ScaleForDpi(2000000000, 96), uint32_t{2000000000});
+}
+
+WINCORE_TEST(VariantsAreEvictedLeastRecentlyUsedFirst)
+{
+    Core::ThreadPool pool(1);
+    ImageCache cache(2 * 16 * 16 * 4, &pool);
+    const ImageId id = cache.AddImage(MakeRandomPremultiplied(64, 64, 1));
+    CHECK_THROWS_AS(cache.AddImage(Bitmap{}), std::invalid_argument);
+    CHECK_THROWS_AS(cache.GetVariant(id, 0, 16), std::invalid_argument);
+    CHECK_THROWS_AS(cache.GetVariant(id + 1, 16, 16), std::invalid_argument);
+
+    const std::shared_ptr<const Bitmap> first = cache.GetVariant(id, 16, 16);
+    const std::shared_ptr<const Bitmap> second = cache.GetVariant(id, 16, 15);
+    CHECK(cache.GetVariant(id, 16, 16) == first);
+    CHECK_EQ(cache.GetStatistics().VariantCount, size_t{2});
+
+    // The third variant goes over the budget, the least recently used one makes room.
+    const std::shared_ptr<const Bitmap> third = cache.GetVariant(id, 16, 14);
+    CHECK(cache.TryGetVariant(id, 16, 15) == nullptr);
+    CHECK(cache.TryGetVariant(id, 16, 16) == first);
+    CHECK(cache.TryGetVariant(id, 16, 14) == third);
+
+    ImageCacheStatistics statistics = cache.GetStatistics();
+    CHECK_EQ(statistics.Evictions, uint64_t{1});
+    CHECK_EQ(statistics.VariantCount, size_t{2});
+    CHECK_EQ(statistics.VariantBytes, first->GetByteSize() + third->GetByteSize());
+    CHECK_EQ(statistics.Resamples, uint64_t{3});
+
+    // Handed out variants stay valid after eviction, and a smaller budget evicts right away.
+    CHECK_EQ(second->Height, uint32_t{15});
+    cache.SetMemoryBudget(0);
+    statistics = cache.GetStatistics();
+    CHECK_EQ(statistics.VariantCount, size_t{1});
+    CHECK(cache.TryGetVariant(id, 16, 14) == third);
+}
+
+WINCORE_TEST(ResamplesStartFromTheSmallestVariantTwiceAsLarge)
+{
+    Core::ThreadPool pool(1);
+    ImageCache cache(64 * 1024 * 1024, &pool);
+    const ImageId id = cache.AddImage(MakeRandomPremultiplied(256, 256, 2));
+    const std::shared_ptr<const Bitmap> large = cache.GetVariant(id, 128, 128);
+    const std::shared_ptr<const Bitmap> medium = cache.GetVariant(id, 64, 64);
+    cache.GetVariant(id, 40, 40);
+
+    // 40x40 is smaller than twice 32x32, so 64x64 is the smallest usable variant.
+    const std::shared_ptr<const Bitmap> small = cache.GetVariant(id, 32, 32);
+    CHECK(small->Pixels == ImageResampler::Resample(*medium, 32, 32).Pixels);
+
+    // 33x33 needs 66x66, which only the 128x128 variant provides.
+    const std::shared_ptr<const Bitmap> odd = cache.GetVariant(id, 33, 33);
+    CHECK(odd->Pixels == ImageResampler::Resample(*large, 33, 33).Pixels);
+
+    // Without any large enough variant the source is used.
+    const std::shared_ptr<const Bitmap> wide = cache.GetVariant(id, 100, 10);
+    CHECK(wide->Pixels == ImageResampler::Resample(*cache.GetSource(id), 100, 10).Pixels);
+}
+
+WINCORE_TEST(ConcurrentRequestsShareOneResample)
+{
+    Core::ThreadPool pool(1);
+    Core::UiDispatcher ui;
+    ImageCache cache(64 * 1024 * 1024, &pool);
+    const ImageId id = cache.AddImage(MakeRandomPremultiplied(64, 64, 3));
+
+    std::vector<Delivery> deliveries;
+    {
+        PoolGate gate(pool);
+        cache.RequestVariant(id, 20, 20, ui, Collect(deliveries));
+        cache.RequestVariant(id, 20, 20, ui, Collect(deliveries));
+        cache.RequestVariant(id, 21, 20, ui, Collect(deliveries));
+        CHECK(deliveries.empty());
+    }
+    CHECK(RunUntil(ui, deliveries, 3));
+
+    for (const Delivery& delivery : deliveries)
+        CHECK(delivery.Variant && !delivery.Failure);
+    CHECK(deliveries[0].Variant == deliveries[1].Variant);
+    CHECK(deliveries[0].Variant != deliveries[2].Variant);
+    ImageCacheStatistics statistics = cache.GetStatistics();
+    CHECK_EQ(statistics.Resamples, uint64_t{2});
+    CHECK_EQ(statistics.Misses, uint64_t{3});
+
+    // Cached variants are delivered right away on the calling thread.
+    cache.RequestVariant(id, 20, 20, ui, Collect(deliveries));
+    CHECK_EQ(deliveries.size(), size_t{4});
+    CHECK(deliveries[3].Variant == deliveries[0].Variant);
+    CHECK_EQ(cache.GetStatistics().Hits, uint64_t{1});
+
+    // A request for an unknown image fails through its callback.
+    cache.RequestVariant(id + 1, 20, 20, ui, Collect(deliveries));
+    CHECK(RunUntil(ui, deliveries, 5));
+    CHECK(!deliveries[4].Variant);
+    CHECK_THROWS_AS(std::rethrow_exception(deliveries[4].Failure), std::invalid_argument);
+}
+
+WINCORE_TEST(RemovingAnImageDuringAResampleDoesNotCacheIt)
+{
+    Core::ThreadPool pool(1);
+    Core::UiDispatcher ui;
+    ImageCache cache(64 * 1024 * 1024, &pool);
+    const ImageId id = cache.AddImage(MakeRandomPremultiplied(64, 64, 4));
+    const ImageId other = cache.AddImage(MakeRandomPremultiplied(32, 32, 5));
+    cache.GetVariant(id, 8, 8);
+    cache.GetVariant(other, 8, 8);
+
+    std::vector<Delivery> deliveries;
+    {
+        PoolGate gate(pool);
+        cache.RequestVariant(id, 24, 24, ui, Collect(deliveries));
+        cache.RemoveImage(id);
+        CHECK(cache.GetSource(id) == nullptr);
+        CHECK(cache.TryGetVariant(id, 8, 8) == nullptr);
+    }
+    CHECK(RunUntil(ui, deliveries, 1));
+
+    // The request still gets its pixels, but nothing of the removed image is cached.
+    CHECK(deliveries[0].Variant && !deliveries[0].Failure);
+    CHECK_EQ(deliveries[0].Variant->Width, uint32_t{24});
+    CHECK(cache.TryGetVariant(id, 24, 24) == nullptr);
+    CHECK(cache.TryGetVariant(other, 8, 8) != nullptr);
+    const ImageCacheStatistics statistics = cache.GetStatistics();
+    CHECK_EQ(statistics.VariantCount, size_t{1});
+    CHECK_EQ(statistics.VariantBytes, size_t{8 * 8 * 4});
+}
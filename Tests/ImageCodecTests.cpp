@@ -0,0 +1,165 @@
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ImageCodec.hpp"
+#include "TestFramework.hpp"
+#include "TestBitmaps.hpp"
+
+using namespace WinCore::UI;
+using WinCore::Tests::MakeRandomPremultiplied;
+
+namespace
+{
+    void AppendU16(std::vector<uint8_t>& data, uint16_t value)
+    {
+        data.push_back(static_cast<uint8_t>(value));
+        data.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void AppendU32(std::vector<uint8_t>& data, uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+            data.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    /**
+     * Writes the file and info headers of a BMP with the given layout, masks are only written for BI_BITFIELDS.
+     */
+    std::vector<uint8_t> MakeBmpHeader(int32_t width, int32_t height, uint16_t bitsPerPixel, const std::vector<uint32_t>& masks = {})
+    {
+        const uint32_t headerSize = masks.empty() ? 40 : 108;
+        std::vector<uint8_t> data{'B', 'M'};
+        AppendU32(data, 0);
+        AppendU32(data, 0);
+        AppendU32(data, 14 + headerSize);
+        AppendU32(data, headerSize);
+        AppendU32(data, static_cast<uint32_t>(width));
+        AppendU32(data, static_cast<uint32_t>(height));
+        AppendU16(data, 1);
+        AppendU16(data, bitsPerPixel);
+        AppendU32(data, masks.empty() ? 0 : 3);
+        for (int field = 0; field < 5; ++field)
+            AppendU32(data, 0);
+        for (uint32_t mask : masks)
+            AppendU32(data, mask);
+        data.resize(14 + headerSize, 0);
+        return data;
+    }
+
+    std::vector<uint8_t> ToBytes(const std::string& text)
+    {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+}
+
+WINCORE_TEST(BmpRoundTripKeepsOpaquePixels)
+{
+    Bitmap source = MakeRandomPremultiplied(37, 11, 1);
+    for (size_t index = 3; index < source.Pixels.size(); index += 4)
+        source.Pixels[index] = 255;
+
+    const Bitmap decoded = ImageCodec::Decode(ImageCodec::EncodeBmp(source));
+    CHECK_EQ(decoded.Width, source.Width);
+    CHECK_EQ(decoded.Height, source.Height);
+    CHECK(decoded.Pixels == source.Pixels);
+}
+
+WINCORE_TEST(BmpRoundTripKeepsPremultipliedAlpha)
+{
+    const Bitmap source = MakeRandomPremultiplied(64, 9, 2);
+    const Bitmap decoded = ImageCodec::Decode(ImageCodec::EncodeBmp(source));
+    CHECK_EQ(decoded.Width, source.Width);
+    CHECK_EQ(decoded.Height, source.Height);
+
+    // Straight alpha loses precision for faint pixels, colours may move by one step.
+    for (size_t index = 0; index < source.Pixels.size(); ++index)
+        CHECK(std::abs(static_cast<int>(decoded.Pixels[index]) - static_cast<int>(source.Pixels[index])) <= 1);
+    for (size_t index = 3; index < source.Pixels.size(); index += 4)
+        CHECK_EQ(static_cast<int>(decoded.Pixels[index]), static_cast<int>(source.Pixels[index]));
+}
+
+WINCORE_TEST(Bmp24BitBottomUpRowsArePadded)
+{
+    // 3 pixels of 3 bytes need three bytes of padding per row.
+    std::vector<uint8_t> data = MakeBmpHeader(3, 2, 24);
+    const uint8_t bottom[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0, 0};
+    const uint8_t top[] = {10, 20, 30, 40, 50, 60, 70, 80, 90, 0, 0, 0};
+    data.insert(data.end(), std::begin(bottom), std::end(bottom));
+    data.insert(data.end(), std::begin(top), std::end(top));
+
+    const Bitmap bitmap = ImageCodec::DecodeBmp(data);
+    CHECK_EQ(bitmap.Width, 3u);
+    CHECK_EQ(bitmap.Height, 2u);
+    const std::vector<uint8_t> expected{10, 20, 30, 255, 40, 50, 60, 255, 70, 80, 90, 255,
+                                        1, 2, 3, 255, 4, 5, 6, 255, 7, 8, 9, 255};
+    CHECK(bitmap.Pixels == expected);
+}
+
+WINCORE_TEST(BmpBitfieldsScaleNarrowAndFullWidthMasks)
+{
+    // 10-bit colour with 2-bit alpha.
+    {
+        std::vector<uint8_t> data = MakeBmpHeader(2, -1, 32, {0x3FF00000, 0x000FFC00, 0x000003FF, 0xC0000000});
+        AppendU32(data, 0xFFFFFFFF);
+        AppendU32(data, (3u << 30) | (512u << 20) | (0u << 10) | 1023u);
+        const Bitmap bitmap = ImageCodec::DecodeBmp(data);
+        const std::vector<uint8_t> expected{255, 255, 255, 255, 255, 0, 128, 255};
+        CHECK(bitmap.Pixels == expected);
+    }
+
+    // A mask covering all 32 bits used to overflow the scaling.
+    {
+        std::vector<uint8_t> data = MakeBmpHeader(3, -1, 32, {0xFFFFFFFF, 0x0000FF00, 0x000000FF, 0});
+        AppendU32(data, 0xFFFFFFFF);
+        AppendU32(data, 0x80000000);
+        AppendU32(data, 0x00000000);
+        const Bitmap bitmap = ImageCodec::DecodeBmp(data);
+        CHECK_EQ(static_cast<int>(bitmap.Pixels[2]), 255);
+        CHECK_EQ(static_cast<int>(bitmap.Pixels[6]), 128);
+        CHECK_EQ(static_cast<int>(bitmap.Pixels[10]), 0);
+    }
+}
+
+WINCORE_TEST(BmpRejectsMalformedData)
+{
+    CHECK_THROWS_AS(ImageCodec::DecodeBmp(ToBytes("BM")), std::runtime_error);
+
+    std::vector<uint8_t> truncated = MakeBmpHeader(4, 4, 24);
+    truncated.resize(truncated.size() + 10);
+    CHECK_THROWS_AS(ImageCodec::DecodeBmp(truncated), std::runtime_error);
+
+    CHECK_THROWS_AS(ImageCodec::DecodeBmp(MakeBmpHeader(0, 4, 24)), std::runtime_error);
+    CHECK_THROWS_AS(ImageCodec::DecodeBmp(MakeBmpHeader(4, 4, 8)), std::runtime_error);
+}
+
+WINCORE_TEST(PpmBinaryRoundTripsThroughBmp)
+{
+    std::vector<uint8_t> data = ToBytes("P6\n# a comment\n2 2\n255\n");
+    const uint8_t samples[] = {255, 0, 0, 0, 255, 0, 0, 0, 255, 10, 20, 30};
+    data.insert(data.end(), std::begin(samples), std::end(samples));
+
+    const Bitmap bitmap = ImageCodec::Decode(data);
+    const std::vector<uint8_t> expected{0, 0, 255, 255, 0, 255, 0, 255, 255, 0, 0, 255, 30, 20, 10, 255};
+    CHECK(bitmap.Pixels == expected);
+    CHECK(ImageCodec::Decode(ImageCodec::EncodeBmp(bitmap)).Pixels == expected);
+}
+
+WINCORE_TEST(PpmAsciiScalesToEightBits)
+{
+    const Bitmap bitmap = ImageCodec::Decode(ToBytes("P3 2 1 15\n15 0 7  # trailing comment\n 1 2 3\n"));
+    const std::vector<uint8_t> expected{119, 0, 255, 255, 51, 34, 17, 255};
+    CHECK(bitmap.Pixels == expected);
+}
+
+WINCORE_TEST(PpmRejectsMalformedData)
+{
+    CHECK_THROWS_AS(ImageCodec::DecodePpm(ToBytes("P6 2 2 255\n\x01\x02")), std::runtime_error);
+    CHECK_THROWS_AS(ImageCodec::DecodePpm(ToBytes("P3 1 1 255\n1 2 256\n")), std::runtime_error);
+    CHECK_THROWS_AS(ImageCodec::DecodePpm(ToBytes("P3 1 1 65535\n1 2 3\n")), std::runtime_error);
+    CHECK_THROWS_AS(ImageCodec::DecodePpm(ToBytes("P3 x 1 255\n")), std::runtime_error);
+    // Far fewer samples than the header promises, rejected before the bitmap is allocated.
+    CHECK_THROWS_AS(ImageCodec::DecodePpm(ToBytes("P3 16000 16000 255\n1 2 3\n")), std::runtime_error);
+    CHECK_THROWS_AS(ImageCodec::Decode(ToBytes("GIF89a")), std::runtime_error);
+}
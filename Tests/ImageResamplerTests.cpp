@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "ImageResampler.hpp"
+#include "TestFramework.hpp"
+#include "TestBitmaps.hpp"
+#include "ThreadPool.hpp"
+
+using namespace WinCore;
+using namespace WinCore::UI;
+using WinCore::Tests::MakeRandomPremultiplied;
+
+namespace
+{
+    constexpr ResampleFilter Filters[] = {ResampleFilter::Box, ResampleFilter::Bilinear, ResampleFilter::Lanczos3};
+
+    void CheckPremultiplied(const Bitmap& bitmap)
+    {
+        for (size_t index = 0; index < bitmap.Pixels.size(); index += 4)
+        {
+            for (size_t channel = 0; channel < 3; ++channel)
+                CHECK(bitmap.Pixels[index + channel] <= bitmap.Pixels[index + 3]);
+        }
+    }
+
+    /**
+     * Reports the first differing pixel, a plain Pixels comparison would only say that they differ.
+     */
+    void CheckSamePixels(const Bitmap& actual, const Bitmap& expected, const std::string& context)
+    {
+        CHECK_EQ(actual.Width, expected.Width);
+        CHECK_EQ(actual.Height, expected.Height);
+        for (size_t index = 0; index < expected.Pixels.size(); ++index)
+        {
+            if (actual.Pixels[index] != expected.Pixels[index])
+            {
+                WinCore::Tests::Fail(__FILE__, __LINE__, context + ": byte " + std::to_string(index) + " is " +
+                                     std::to_string(actual.Pixels[index]) + ", scalar gives " + std::to_string(expected.Pixels[index]));
+            }
+        }
+    }
+}
+
+WINCORE_TEST(SimdMatchesScalarForEveryFilter)
+{
+    // Odd widths leave tails for the scalar loops after the 8 and 4 wide ones.
+    const Bitmap source = MakeRandomPremultiplied(67, 41, 3);
+    const uint32_t sizes[][2] = {{33, 20}, {67, 13}, {5, 41}, {150, 97}, {1, 1}, {131, 7}};
+    for (ResampleFilter filter : Filters)
+    {
+        for (const auto& size : sizes)
+        {
+            const std::string context = "filter " + std::to_string(static_cast<int>(filter)) + " to " +
+                                        std::to_string(size[0]) + "x" + std::to_string(size[1]);
+            const Bitmap simd = ImageResampler::Resample(source, size[0], size[1], filter);
+            const Bitmap scalar = ImageResampler::ResampleScalar(source, size[0], size[1], filter);
+            CheckSamePixels(simd, scalar, context);
+            CheckPremultiplied(simd);
+        }
+    }
+}
+
+WINCORE_TEST(PoolSplitMatchesSingleThreadedResult)
+{
+    Core::ThreadPool pool(3);
+    const Bitmap source = MakeRandomPremultiplied(300, 200, 4);
+    for (ResampleFilter filter : Filters)
+    {
+        const Bitmap single = ImageResampler::Resample(source, 123, 77, filter);
+        CheckSamePixels(ImageResampler::Resample(source, 123, 77, filter, &pool), single, "pooled");
+        CheckSamePixels(ImageResampler::ResampleScalar(source, 123, 77, filter, &pool), single, "pooled scalar");
+    }
+}
+
+WINCORE_TEST(ConstantImagesStayConstant)
+{
+    Bitmap source(40, 30);
+    for (size_t index = 0; index < source.Pixels.size(); index += 4)
+    {
+        source.Pixels[index + 0] = 10;
+        source.Pixels[index + 1] = 100;
+        source.Pixels[index + 2] = 150;
+        source.Pixels[index + 3] = 200;
+    }
+
+    for (ResampleFilter filter : Filters)
+    {
+        for (const Bitmap& result : {ImageResampler::Resample(source, 17, 9, filter), ImageResampler::Resample(source, 95, 61, filter)})
+        {
+            for (size_t index = 0; index < result.Pixels.size(); ++index)
+                CHECK(std::abs(static_cast<int>(result.Pixels[index]) - static_cast<int>(source.Pixels[index % 4])) <= 1);
+        }
+    }
+}
+
+WINCORE_TEST(SameSizeReturnsACopy)
+{
+    const Bitmap source = MakeRandomPremultiplied(16, 16, 5);
+    CHECK(ImageResampler::Resample(source, 16, 16).Pixels == source.Pixels);
+}
+
+WINCORE_TEST(InvalidSizesThrow)
+{
+    const Bitmap source = MakeRandomPremultiplied(16, 16, 6);
+    CHECK_THROWS_AS(ImageResampler::Resample(Bitmap{}, 8, 8), std::invalid_argument);
+    CHECK_THROWS_AS(ImageResampler::Resample(source, 0, 8), std::invalid_argument);
+    CHECK_THROWS_AS(ImageResampler::ResampleScalar(source, 8, 0), std::invalid_argument);
+}
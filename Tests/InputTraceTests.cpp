@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Async.hpp"
+#include "FrameScheduler.hpp"
+#include "InputTrace.hpp"
+#include "TestFramework.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore::Core;
+
+namespace
+{
+    constexpr uint32_t MsgSize = 0x0005;
+    constexpr uint32_t MsgKeyDown = 0x0100;
+    constexpr uint32_t MsgUser = 0x0400;
+    constexpr uint32_t MsgMouseMove = 0x0200;
+
+    const void* const WindowA = reinterpret_cast<const void*>(uintptr_t{0x1000});
+    const void* const WindowB = reinterpret_cast<const void*>(uintptr_t{0x2000});
+
+    /**
+     * A file in the temporary directory, deleted when the test ends.
+     */
+    class TemporaryFile
+    {
+        public:
+            explicit TemporaryFile(const std::string& name)
+                : path_((std::filesystem::temp_directory_path() / ("WinCore" + name + ".trace")).string())
+            {
+                std::filesystem::remove(path_);
+            }
+
+            ~TemporaryFile() { std::filesystem::remove(path_); }
+
+            TemporaryFile(const TemporaryFile&) = delete;
+            TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+            [[nodiscard]] const std::string& GetPath() const noexcept { return path_; }
+
+            std::vector<uint8_t> Read() const
+            {
+                std::ifstream file(path_, std::ios::binary);
+                return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+
+            void Write(const std::vector<uint8_t>& bytes) const
+            {
+                std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            }
+
+        private:
+            std::string path_;
+    };
+
+    struct RecordedMessage
+    {
+        const void* Window;
+        uint32_t Message;
+        uint64_t WParam;
+        int64_t LParam;
+    };
+
+    /**
+     * Exercises every encoding path: new and repeated windows, zero and maximal WPARAMs, and LPARAM
+     * deltas that are repeated, negative and wrap around the 64-bit range.
+     */
+    const std::vector<RecordedMessage> Messages = {
+        {WindowA, MsgMouseMove, 0, 0x00100020},
+        {WindowA, MsgMouseMove, 0, 0x00100020},
+        {WindowA, MsgMouseMove, 0, 0x0010001F},
+        {WindowB, MsgKeyDown, 0x41, 1},
+        {WindowB, MsgKeyDown, std::numeric_limits<uint64_t>::max(), -1},
+        {WindowA, MsgSize, 0, std::numeric_limits<int64_t>::max()},
+        {WindowA, MsgSize, 1, std::numeric_limits<int64_t>::min()},
+        {WindowB, MsgMouseMove, 0, 0},
+    };
+
+    /**
+     * The header of a trace without entries, as the recorder writes it.
+     */
+    std::vector<uint8_t> MakeHeader()
+    {
+        return {'W', 'C', 'T', 'R', 'A', 'C', 'E', '1', 1, 0, 0, 0, 0, 0, 0, 0};
+    }
+
+    std::vector<TraceEntry> ReadAll(InputTraceReader& reader)
+    {
+        std::vector<TraceEntry> entries;
+        TraceEntry entry{};
+        while (reader.Next(entry))
+            entries.push_back(entry);
+        return entries;
+    }
+}
+
+WINCORE_TEST(EntriesSurviveTheDeltaEncodingRoundTrip)
+{
+    TemporaryFile file("InputTraceRoundTrip");
+    {
+        InputTraceRecorder recorder(file.GetPath());
+        for (size_t index = 0; index < Messages.size(); ++index)
+        {
+            recorder.Record(Messages[index].Window, Messages[index].Message, Messages[index].WParam, Messages[index].LParam);
+            if (index == 2)
+                recorder.RecordFrameBoundary();
+        }
+        recorder.Record(WindowA, MsgUser, 7, 7);
+        CHECK_EQ(recorder.GetEntryCount(), uint64_t{Messages.size() + 1});
+    }
+
+    InputTraceReader reader(file.GetPath());
+    const std::vector<TraceEntry> entries = ReadAll(reader);
+    CHECK_EQ(entries.size(), Messages.size() + 1);
+
+    size_t message = 0;
+    uint64_t timestamp = 0;
+    for (size_t index = 0; index < entries.size(); ++index)
+    {
+        const TraceEntry& entry = entries[index];
+        CHECK(entry.Timestamp >= timestamp);
+        timestamp = entry.Timestamp;
+        if (index == 3)
+        {
+            CHECK(entry.Kind == TraceEntryKind::FrameBoundary);
+            CHECK_EQ(entry.WindowId, 0u);
+            continue;
+        }
+
+        const RecordedMessage& expected = Messages[message++];
+        CHECK(entry.Kind == TraceEntryKind::Message);
+        CHECK_EQ(entry.WindowId, expected.Window == WindowA ? 1u : 2u);
+        CHECK_EQ(entry.Message, expected.Message);
+        CHECK_EQ(entry.WParam, expected.WParam);
+        CHECK_EQ(entry.LParam, expected.LParam);
+    }
+
+    // Rewinding decodes the same entries again.
+    reader.Rewind();
+    const std::vector<TraceEntry> again = ReadAll(reader);
+    CHECK_EQ(again.size(), entries.size());
+    CHECK_EQ(again.back().LParam, entries.back().LParam);
+}
+
+WINCORE_TEST(EmptyTracesReplayNoEvents)
+{
+    TemporaryFile empty("InputTraceEmpty");
+    empty.Write({});
+    TemporaryFile headerOnly("InputTraceHeaderOnly");
+    {
+        InputTraceRecorder recorder(headerOnly.GetPath());
+    }
+    CHECK_EQ(headerOnly.Read().size(), MakeHeader().size());
+
+    for (const TemporaryFile* file : {&empty, &headerOnly})
+    {
+        InputTraceReader reader(file->GetPath());
+        TraceEntry entry{};
+        CHECK(!reader.Next(entry));
+
+        size_t dispatched = 0;
+        ReplayTarget target{};
+        target.Dispatch = [&dispatched](const TraceEntry&) { ++dispatched; };
+        const ReplayReport report = InputTraceReplayer::Replay(reader, target);
+        CHECK_EQ(dispatched, size_t{0});
+        CHECK(report.Frames.empty());
+        CHECK_EQ(report.MessageCount, uint64_t{0});
+        CHECK_EQ(report.GetFrameTimePercentile(99.0), 0.0);
+    }
+}
+
+WINCORE_TEST(TruncatedAndCorruptTracesAreRejected)
+{
+    TemporaryFile file("InputTraceCorrupt");
+    CHECK_THROWS_AS(InputTraceReader(file.GetPath()), std::runtime_error);
+
+    {
+        InputTraceRecorder recorder(file.GetPath());
+        recorder.Record(WindowA, MsgKeyDown, 0x41, 1);
+        recorder.Record(WindowB, MsgMouseMove, 0, -5);
+    }
+    const std::vector<uint8_t> valid = file.Read();
+
+    // A header cut short or carrying the wrong magic or version is not a trace.
+    file.Write(std::vector<uint8_t>(valid.begin(), valid.begin() + 10));
+    CHECK_THROWS_AS(InputTraceReader(file.GetPath()), std::runtime_error);
+    std::vector<uint8_t> header = MakeHeader();
+    header[0] = 'X';
+    file.Write(header);
+    CHECK_THROWS_AS(InputTraceReader(file.GetPath()), std::runtime_error);
+    header = MakeHeader();
+    header[8] = 2;
+    file.Write(header);
+    CHECK_THROWS_AS(InputTraceReader(file.GetPath()), std::runtime_error);
+
+    // Dropping the last byte leaves the final varint unfinished.
+    file.Write(std::vector<uint8_t>(valid.begin(), valid.end() - 1));
+    {
+        InputTraceReader reader(file.GetPath());
+        TraceEntry entry{};
+        CHECK(reader.Next(entry));
+        CHECK_THROWS_AS(reader.Next(entry), std::runtime_error);
+    }
+
+    // An unknown entry kind.
+    std::vector<uint8_t> bytes = MakeHeader();
+    bytes.push_back(0x03);
+    bytes.push_back(0x00);
+    file.Write(bytes);
+    {
+        InputTraceReader reader(file.GetPath());
+        TraceEntry entry{};
+        CHECK_THROWS_AS(reader.Next(entry), std::runtime_error);
+    }
+
+    // A varint that never ends within 64 bits.
+    bytes = MakeHeader();
+    bytes.push_back(static_cast<uint8_t>(TraceEntryKind::FrameBoundary));
+    bytes.insert(bytes.end(), 12, 0xFF);
+    file.Write(bytes);
+    {
+        InputTraceReader reader(file.GetPath());
+        TraceEntry entry{};
+        CHECK_THROWS_AS(reader.Next(entry), std::runtime_error);
+    }
+}
+
+WINCORE_TEST(ReplayGroupsMessagesIntoFrames)
+{
+    TemporaryFile file("InputTraceReplay");
+    {
+        InputTraceRecorder recorder(file.GetPath());
+        recorder.Record(WindowA, MsgMouseMove, 0, 1);
+        recorder.Record(WindowA, MsgMouseMove, 0, 2);
+        recorder.RecordFrameBoundary();
+        recorder.RecordFrameBoundary();
+        recorder.Record(WindowB, MsgKeyDown, 0x41, 1);
+    }
+
+    InputTraceReader reader(file.GetPath());
+    std::vector<uint32_t> windows;
+    int layouts = 0;
+    int paints = 0;
+    ReplayTarget target{};
+    target.Dispatch = [&windows](const TraceEntry& entry) { windows.push_back(entry.WindowId); };
+    target.Layout = [&layouts] { ++layouts; };
+    target.Paint = [&paints] { ++paints; };
+
+    // The messages after the last boundary still form a frame.
+    const ReplayReport report = InputTraceReplayer::Replay(reader, target);
+    CHECK_EQ(report.Frames.size(), size_t{3});
+    CHECK_EQ(report.MessageCount, uint64_t{3});
+    CHECK_EQ(report.Frames[0].MessageCount, 2u);
+    CHECK_EQ(report.Frames[1].MessageCount, 0u);
+    CHECK_EQ(report.Frames[2].MessageCount, 1u);
+    CHECK_EQ(report.Frames[2].FrameIndex, uint64_t{2});
+    CHECK_EQ(layouts, 3);
+    CHECK_EQ(paints, 3);
+    CHECK((windows == std::vector<uint32_t>{1, 1, 2}));
+
+    TemporaryFile csv("InputTraceReport");
+    InputTraceReplayer::WriteReport(report, csv.GetPath());
+    const std::vector<uint8_t> text = csv.Read();
+    CHECK_EQ(std::count(text.begin(), text.end(), '\n'), std::ptrdiff_t{4});
+}
+
+WINCORE_TEST(ThePumpAndTheSchedulerFeedTheRecorder)
+{
+    TemporaryFile file("InputTracePump");
+    {
+        InputTraceRecorder recorder(file.GetPath());
+        UiDispatcher dispatcher;
+        ManualFrameClock clock;
+        FrameScheduler scheduler(clock);
+        scheduler.RegisterWindow(WindowA, 100, FrameCallbacks{});
+
+        dispatcher.RecordMessage(WindowA, MsgMouseMove, 0, 1);
+        dispatcher.SetInputTraceRecorder(&recorder);
+        scheduler.SetInputTraceRecorder(&recorder);
+        dispatcher.RecordMessage(WindowA, MsgMouseMove, 0, 2);
+        dispatcher.RecordMessage(WindowA, MsgUser, 0, 3);
+
+        // Only ticks that rendered frames end a frame of the trace.
+        CHECK_EQ(scheduler.Tick(), size_t{0});
+        scheduler.Invalidate(WindowA);
+        clock.Advance(10ms);
+        CHECK_EQ(scheduler.Tick(), size_t{1});
+
+        dispatcher.SetInputTraceRecorder(nullptr);
+        scheduler.SetInputTraceRecorder(nullptr);
+        dispatcher.RecordMessage(WindowA, MsgMouseMove, 0, 4);
+        scheduler.Invalidate(WindowA);
+        clock.Advance(10ms);
+        CHECK_EQ(scheduler.Tick(), size_t{1});
+        CHECK_EQ(recorder.GetEntryCount(), uint64_t{2});
+    }
+
+    InputTraceReader reader(file.GetPath());
+    const std::vector<TraceEntry> entries = ReadAll(reader);
+    CHECK_EQ(entries.size(), size_t{2});
+    CHECK(entries[0].Kind == TraceEntryKind::Message);
+    CHECK_EQ(entries[0].LParam, int64_t{2});
+    CHECK(entries[1].Kind == TraceEntryKind::FrameBoundary);
+}
@@ -0,0 +1,290 @@
+#include <cstdint>
+#include <stdexcept>
+
+#include "LayerCache.hpp"
+#include "TestFramework.hpp"
+
+using namespace WinCore::UI;
+
+namespace
+{
+    const Color Green = Color::FromRgba(0, 255, 0);
+    const Color Red = Color::FromRgba(255, 0, 0);
+
+    /**
+     * Returns the B, G, R, A bytes of a pixel packed as 0xAARRGGBB.
+     */
+    uint32_t GetPixel(const Bitmap& bitmap, uint32_t x, uint32_t y)
+    {
+        const uint8_t* pixel = bitmap.GetRow(y) + static_cast<size_t>(x) * 4;
+        return static_cast<uint32_t>(pixel[0]) | static_cast<uint32_t>(pixel[1]) << 8 | static_cast<uint32_t>(pixel[2]) << 16 |
+               static_cast<uint32_t>(pixel[3]) << 24;
+    }
+}
+
+WINCORE_TEST(RarelyRepaintedSubtreesArePromotedAndComposited)
+{
+    LayerCache cache(1 << 20);
+    Bitmap frame(200, 200);
+    int paints = 0;
+    const auto paint = [&paints](Painter& painter) {
+        ++paints;
+        painter.FillRect(PixelRect{0, 0, 100, 100}, Green);
+    };
+
+    for (int draw = 0; draw < 20; ++draw)
+    {
+        Painter painter(frame);
+        painter.Clear(Color{});
+        const bool hit = cache.Draw(painter, 1, PixelRect{10, 10, 100, 100}, 1.0f, paint);
+        CHECK_EQ(hit, draw >= 8);
+        CHECK_EQ(GetPixel(frame, 10, 10), 0xFF00FF00u);
+        CHECK_EQ(GetPixel(frame, 109, 109), 0xFF00FF00u);
+        CHECK_EQ(GetPixel(frame, 9, 10), 0u);
+        CHECK_EQ(GetPixel(frame, 110, 10), 0u);
+    }
+
+    // Seven direct paints, then the eighth paints the new layer and every later draw composites it.
+    const LayerCacheStatistics& statistics = cache.GetStatistics();
+    CHECK(cache.IsCached(1));
+    CHECK_EQ(paints, 8);
+    CHECK_EQ(statistics.DirectPaints, uint64_t{7});
+    CHECK_EQ(statistics.Misses, uint64_t{1});
+    CHECK_EQ(statistics.Hits, uint64_t{12});
+    CHECK_EQ(statistics.LayerBytes, size_t{100 * 100 * 4});
+}
+
+WINCORE_TEST(FrequentlyRepaintedSubtreesAreDemoted)
+{
+    LayerCache cache(1 << 20);
+    Bitmap frame(100, 100);
+    Painter painter(frame);
+    const auto paint = [](Painter& target) { target.Clear(Green); };
+
+    for (int draw = 0; draw < 8; ++draw)
+        cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, paint);
+    CHECK(cache.IsCached(1));
+
+    for (int draw = 0; draw < 3; ++draw)
+    {
+        cache.Invalidate(1);
+        cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, paint);
+    }
+    CHECK(!cache.IsCached(1));
+    CHECK_EQ(cache.GetStatistics().Demotions, uint64_t{1});
+    CHECK_EQ(cache.GetStatistics().LayerBytes, size_t{0});
+}
+
+WINCORE_TEST(InvalidatingAChildRepaintsItsCachedAncestors)
+{
+    LayerCache cache(1 << 20);
+    Bitmap frame(100, 100);
+    Painter painter(frame);
+    int parentPaints = 0;
+    int childPaints = 0;
+    Color childColor = Green;
+    const auto parent = [&](Painter& target) {
+        ++parentPaints;
+        cache.Draw(target, 2, PixelRect{5, 5, 80, 80}, 1.0f, [&](Painter& child) {
+            ++childPaints;
+            child.Clear(childColor);
+        });
+    };
+    cache.SetPromotion(1, LayerPromotion::Always);
+    cache.SetPromotion(2, LayerPromotion::Always);
+
+    cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, parent);
+    CHECK(cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, parent));
+    CHECK_EQ(parentPaints, 1);
+    CHECK_EQ(childPaints, 1);
+
+    childColor = Red;
+    cache.Invalidate(2);
+    CHECK(!cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, parent));
+    CHECK_EQ(parentPaints, 2);
+    CHECK_EQ(childPaints, 2);
+    CHECK_EQ(GetPixel(frame, 5, 5), 0xFFFF0000u);
+
+    // Removing the child changes what the parent shows, its layer must not be reused either.
+    cache.Remove(2);
+    CHECK(!cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, parent));
+    CHECK_EQ(parentPaints, 3);
+}
+
+WINCORE_TEST(DirectlyPaintedParentsStayDirectWhileAChildAnimates)
+{
+    LayerCache cache(1 << 20);
+    Bitmap frame(120, 120);
+    int spinnerFrame = 0;
+    const auto parent = [&](Painter& target) {
+        target.FillRect(PixelRect{0, 0, 100, 100}, Green);
+        cache.Draw(target, 2, PixelRect{40, 40, 16, 16}, 1.0f, [&](Painter& spinner) {
+            spinner.FillRect(PixelRect{spinnerFrame % 16, 0, 1, 16}, Red);
+        });
+    };
+
+    // The spinner changes every frame. Its parent must never be cached, a layer would freeze the spinner
+    // or be thrown away again a few frames later.
+    for (spinnerFrame = 0; spinnerFrame < 100; ++spinnerFrame)
+    {
+        cache.Invalidate(2);
+        Painter painter(frame);
+        painter.Clear(Color{});
+        cache.Draw(painter, 1, PixelRect{10, 10, 100, 100}, 1.0f, parent);
+        CHECK_EQ(GetPixel(frame, 50 + static_cast<uint32_t>(spinnerFrame % 16), 50), 0xFFFF0000u);
+    }
+    CHECK(!cache.IsCached(1));
+    CHECK_EQ(cache.GetStatistics().Promotions, uint64_t{0});
+    CHECK_EQ(cache.GetStatistics().Demotions, uint64_t{0});
+    CHECK_EQ(cache.GetStatistics().DirectPaints, uint64_t{200});
+}
+
+WINCORE_TEST(TranslucentDirectPaintsBlendTheSubtreeOnce)
+{
+    LayerCache cache(1 << 20);
+    cache.SetPromotion(1, LayerPromotion::Never);
+    Bitmap frame(20, 20);
+    Painter painter(frame);
+    cache.Draw(painter, 1, PixelRect{2, 2, 10, 10}, 0.5f, [](Painter& target) {
+        target.FillRect(PixelRect{0, 0, 10, 10}, Green);
+        target.FillRect(PixelRect{0, 0, 5, 5}, Green);
+    });
+
+    // Overlapping opaque rectangles look the same as one, at half opacity.
+    CHECK_EQ(GetPixel(frame, 2, 2), GetPixel(frame, 11, 11));
+    CHECK_EQ(GetPixel(frame, 2, 2) >> 24, 127u);
+    CHECK_EQ(GetPixel(frame, 1, 2), 0u);
+    CHECK_EQ(cache.GetStatistics().DirectPaints, uint64_t{1});
+}
+
+WINCORE_TEST(LeastRecentlyUsedLayersAreEvicted)
+{
+    LayerCache cache(100 * 100 * 4 * 2 + 1);
+    Bitmap frame(100, 100);
+    Painter painter(frame);
+    const auto paint = [](Painter& target) { target.Clear(Green); };
+    for (LayerKey key = 10; key < 13; ++key)
+    {
+        cache.SetPromotion(key, LayerPromotion::Always);
+        cache.Draw(painter, key, PixelRect{0, 0, 100, 100}, 1.0f, paint);
+    }
+    CHECK(!cache.IsCached(10));
+
+    // Drawing 11 again makes 12 the oldest.
+    cache.Draw(painter, 11, PixelRect{0, 0, 100, 100}, 1.0f, paint);
+    cache.SetPromotion(13, LayerPromotion::Always);
+    cache.Draw(painter, 13, PixelRect{0, 0, 100, 100}, 1.0f, paint);
+    CHECK(cache.IsCached(11));
+    CHECK(!cache.IsCached(12));
+    CHECK(cache.IsCached(13));
+    CHECK_EQ(cache.GetStatistics().Evictions, uint64_t{2});
+    CHECK_EQ(cache.GetStatistics().LayerCount, size_t{2});
+
+    cache.SetMemoryBudget(0);
+    CHECK_EQ(cache.GetStatistics().LayerCount, size_t{0});
+    CHECK_EQ(cache.GetStatistics().LayerBytes, size_t{0});
+}
+
+WINCORE_TEST(ThrowingPaintCallbacksLeaveTheCacheUsable)
+{
+    LayerCache cache(1 << 20);
+    Bitmap frame(100, 100);
+    Painter painter(frame);
+    cache.SetPromotion(1, LayerPromotion::Always);
+    cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, [](Painter& target) { target.Clear(Green); });
+
+    cache.Invalidate(1);
+    CHECK_THROWS_AS(cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, [](Painter&) { throw std::runtime_error("paint"); }),
+                    std::runtime_error);
+    CHECK_THROWS_AS(cache.Draw(painter, 2, PixelRect{0, 0, 10, 10}, 1.0f, [](Painter&) { throw std::runtime_error("paint"); }),
+                    std::runtime_error);
+
+    // Neither subtree is still considered to be painting, so Clear releases the layer and 3 has no parent.
+    cache.Clear();
+    CHECK(!cache.IsCached(1));
+    cache.SetPromotion(3, LayerPromotion::Always);
+    cache.Draw(painter, 3, PixelRect{0, 0, 100, 100}, 1.0f, [](Painter& target) { target.Clear(Red); });
+    CHECK(cache.Draw(painter, 3, PixelRect{0, 0, 100, 100}, 1.0f, [](Painter& target) { target.Clear(Red); }));
+    CHECK_EQ(GetPixel(frame, 20, 20), 0xFFFF0000u);
+}
+
+WINCORE_TEST(LayersThatDoNotFitThePaintingAncestorsArePaintedDirectlyOnce)
+{
+    // The parent's layer leaves no room for the child's, and the parent cannot be evicted while it paints.
+    LayerCache cache(100 * 100 * 4 + 50 * 50 * 4);
+    Bitmap frame(100, 100);
+    Painter painter(frame);
+    int childPaints = 0;
+    const auto parent = [&](Painter& target) {
+        target.Clear(Green);
+        cache.Draw(target, 2, PixelRect{10, 10, 80, 80}, 1.0f, [&childPaints](Painter& child) {
+            ++childPaints;
+            child.Clear(Red);
+        });
+    };
+    cache.SetPromotion(1, LayerPromotion::Always);
+    cache.SetPromotion(2, LayerPromotion::Always);
+
+    CHECK(!cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, parent));
+    CHECK_EQ(childPaints, 1);
+    CHECK(cache.IsCached(1));
+    CHECK(!cache.IsCached(2));
+    CHECK_EQ(GetPixel(frame, 10, 10), 0xFFFF0000u);
+    CHECK_EQ(GetPixel(frame, 5, 5), 0xFF00FF00u);
+    CHECK_EQ(cache.GetStatistics().Evictions, uint64_t{0});
+    CHECK_EQ(cache.GetStatistics().DirectPaints, uint64_t{1});
+
+    CHECK(cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, parent));
+    CHECK_EQ(childPaints, 1);
+}
+
+WINCORE_TEST(NewLayersEvictOthersBeforeTheyArePainted)
+{
+    LayerCache cache(100 * 100 * 4);
+    Bitmap frame(100, 100);
+    Painter painter(frame);
+    int paints = 0;
+    const auto paint = [&paints](Painter& target) {
+        ++paints;
+        target.Clear(Green);
+    };
+    cache.SetPromotion(1, LayerPromotion::Always);
+    cache.SetPromotion(2, LayerPromotion::Always);
+
+    cache.Draw(painter, 1, PixelRect{0, 0, 100, 100}, 1.0f, paint);
+    cache.Draw(painter, 2, PixelRect{0, 0, 100, 100}, 1.0f, paint);
+    CHECK_EQ(paints, 2);
+    CHECK(!cache.IsCached(1));
+    CHECK(cache.IsCached(2));
+    CHECK_EQ(cache.GetStatistics().Evictions, uint64_t{1});
+    CHECK_EQ(cache.GetStatistics().LayerBytes, size_t{100 * 100 * 4});
+}
+
+WINCORE_TEST(TheFirstDrawLeavesTheRepaintHistoryAfterThirtyTwoDraws)
+{
+    LayerPolicy policy{};
+    policy.MinDraws = 32;
+    policy.MaxRepaints = 0;
+    policy.MinArea = 1;
+    LayerCache cache(1 << 20, policy);
+    Bitmap frame(100, 100);
+    Painter painter(frame);
+    const auto paint = [](Painter& target) { target.Clear(Green); };
+
+    // The first draw is never held against the subtree, not even while it is the oldest in the history.
+    for (int draw = 1; draw < 32; ++draw)
+        cache.Draw(painter, 1, PixelRect{0, 0, 10, 10}, 1.0f, paint);
+    CHECK(!cache.IsCached(1));
+    cache.Draw(painter, 1, PixelRect{0, 0, 10, 10}, 1.0f, paint);
+    CHECK(cache.IsCached(1));
+
+    // A real change demotes the layer and keeps counting until 32 draws later.
+    cache.Invalidate(1);
+    cache.Draw(painter, 1, PixelRect{0, 0, 10, 10}, 1.0f, paint);
+    CHECK(!cache.IsCached(1));
+    for (int draw = 1; draw < 32; ++draw)
+        cache.Draw(painter, 1, PixelRect{0, 0, 10, 10}, 1.0f, paint);
+    CHECK(!cache.IsCached(1));
+    cache.Draw(painter, 1, PixelRect{0, 0, 10, 10}, 1.0f, paint);
+    CHECK(cache.IsCached(1));
+}
@@ -0,0 +1,201 @@
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include "Memory.hpp"
+#include "TestFramework.hpp"
+
+using namespace WinCore::Utils;
+
+namespace
+{
+    /**
+     * Counts what reaches the upstream resource and forwards it to the heap.
+     */
+    class CountingResource final : public std::pmr::memory_resource
+    {
+        public:
+            size_t Allocations{0};
+            size_t Deallocations{0};
+            size_t LiveBytes{0};
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override
+            {
+                ++Allocations;
+                LiveBytes += bytes;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+            {
+                ++Deallocations;
+                LiveBytes -= bytes;
+                std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+}
+
+WINCORE_TEST(FrameArenaResetMergesItsChunks)
+{
+    CountingResource upstream;
+    {
+        FrameArena arena(1024, MemorySubsystem::General, &upstream);
+        CHECK_EQ(upstream.Allocations, size_t{1});
+        CHECK_EQ(arena.GetCapacity(), size_t{1024});
+
+        // A frame that spills over into further chunks.
+        for (int index = 0; index < 8; ++index)
+            std::memset(arena.allocate(700, 8), index, 700);
+        const size_t spilled = arena.GetCapacity();
+        const size_t used = arena.GetBytesUsed();
+        CHECK(upstream.Allocations > 1);
+        CHECK(used >= size_t{8 * 700});
+
+        // One chunk that fits the whole frame replaces them, so the same frame again needs no upstream memory.
+        arena.Reset();
+        CHECK_EQ(arena.GetCapacity(), spilled);
+        CHECK_EQ(upstream.LiveBytes, spilled);
+        CHECK_EQ(arena.GetBytesUsed(), size_t{0});
+        CHECK_EQ(arena.GetHighWaterMark(), used);
+
+        const size_t allocations = upstream.Allocations;
+        for (int index = 0; index < 8; ++index)
+            std::memset(arena.allocate(700, 8), index, 700);
+        arena.Reset();
+        CHECK_EQ(upstream.Allocations, allocations);
+        CHECK_EQ(arena.GetCapacity(), spilled);
+    }
+    CHECK_EQ(upstream.LiveBytes, size_t{0});
+    CHECK_EQ(upstream.Allocations, upstream.Deallocations);
+}
+
+WINCORE_TEST(FrameArenaAlignsAndChargesTheChosenSubsystem)
+{
+    FrameArena arena(4096);
+    MemoryStatistics::Reset();
+
+    void* byte = arena.For(MemorySubsystem::Layout).allocate(1, 1);
+    void* aligned = arena.For(MemorySubsystem::Layout).allocate(24, 64);
+    void* text = arena.For(MemorySubsystem::Text).allocate(10, 1);
+    void* general = arena.allocate(8, 8);
+    CHECK_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, uintptr_t{0});
+    CHECK(byte != aligned && text != general);
+
+    CHECK_EQ(MemoryStatistics::GetCounters(MemorySubsystem::Layout).Allocations, uint64_t{2});
+    CHECK_EQ(MemoryStatistics::GetCounters(MemorySubsystem::Layout).BytesAllocated, uint64_t{25});
+    CHECK_EQ(MemoryStatistics::GetCounters(MemorySubsystem::Text).Allocations, uint64_t{1});
+    CHECK_EQ(MemoryStatistics::GetCounters(MemorySubsystem::General).Allocations, uint64_t{1});
+    CHECK_EQ(MemoryStatistics::GetTotal().Allocations, uint64_t{4});
+    CHECK(arena.For(MemorySubsystem::Layout) == arena.For(MemorySubsystem::Layout));
+    CHECK(arena.For(MemorySubsystem::Layout) != arena.For(MemorySubsystem::Text));
+    arena.Reset();
+}
+
+WINCORE_TEST(ObjectPoolRoutesRequestsBySizeClass)
+{
+    CHECK_EQ(ObjectPool::GetSizeClass(1, 1), size_t{0});
+    CHECK_EQ(ObjectPool::GetSizeClass(16, 8), size_t{0});
+    CHECK_EQ(ObjectPool::GetSizeClass(17, 8), size_t{1});
+    CHECK_EQ(ObjectPool::GetSizeClass(8, 32), size_t{1});
+    CHECK_EQ(ObjectPool::GetSizeClass(1000, 8), size_t{6});
+    CHECK_EQ(ObjectPool::GetSizeClass(ObjectPool::MaximumBlockSize, 8), ObjectPool::SizeClassCount - 1);
+    CHECK_EQ(ObjectPool::GetSizeClass(ObjectPool::MaximumBlockSize + 1, 8), ObjectPool::SizeClassCount);
+    CHECK_EQ(ObjectPool::GetSizeClass(16, 128), ObjectPool::SizeClassCount);
+
+    CountingResource upstream;
+    {
+        ObjectPool pool(MemorySubsystem::Widgets, &upstream);
+        MemoryStatistics::Reset();
+
+        // Small blocks of one class share a slab, blocks of another class get their own.
+        void* first = pool.allocate(24, 8);
+        void* second = pool.allocate(32, 8);
+        CHECK_EQ(upstream.Allocations, size_t{1});
+        void* other = pool.allocate(100, 8);
+        CHECK_EQ(upstream.Allocations, size_t{2});
+        CHECK_EQ(pool.GetReservedBytes(), upstream.LiveBytes);
+        CHECK(first != second);
+        CHECK_EQ(reinterpret_cast<uintptr_t>(second) % 32, uintptr_t{0});
+        CHECK_EQ(reinterpret_cast<uintptr_t>(other) % 128, uintptr_t{0});
+
+        // Oversized and over-aligned requests go straight to the upstream resource and back.
+        void* large = pool.allocate(ObjectPool::MaximumBlockSize + 1, 8);
+        void* overAligned = pool.allocate(16, 128);
+        CHECK_EQ(upstream.Allocations, size_t{4});
+        CHECK_EQ(reinterpret_cast<uintptr_t>(overAligned) % 128, uintptr_t{0});
+        pool.deallocate(large, ObjectPool::MaximumBlockSize + 1, 8);
+        pool.deallocate(overAligned, 16, 128);
+        CHECK_EQ(upstream.Deallocations, size_t{2});
+
+        // Freed blocks are reused.
+        pool.deallocate(first, 24, 8);
+        CHECK(pool.allocate(20, 8) == first);
+        pool.deallocate(first, 20, 8);
+        pool.deallocate(second, 32, 8);
+        pool.deallocate(other, 100, 8);
+
+        const MemoryCounters counters = MemoryStatistics::GetCounters(MemorySubsystem::Widgets);
+        CHECK_EQ(counters.Allocations, uint64_t{6});
+        CHECK_EQ(counters.Deallocations, uint64_t{6});
+        CHECK_EQ(counters.UpstreamAllocations, uint64_t{4});
+    }
+
+    // The calling thread still caches blocks of the destroyed pool, using another pool drops them.
+    ObjectPool next(MemorySubsystem::Widgets);
+    next.deallocate(next.allocate(16, 8), 16, 8);
+    CHECK_EQ(upstream.LiveBytes, size_t{0});
+    CHECK_EQ(upstream.Allocations, upstream.Deallocations);
+}
+
+WINCORE_TEST(ObjectPoolBlocksCanBeFreedOnAnotherThread)
+{
+    ObjectPool pool(MemorySubsystem::Events);
+    MemoryStatistics::Reset();
+
+    constexpr size_t BlockCount = 200;
+    std::vector<void*> blocks;
+    for (size_t index = 0; index < BlockCount; ++index)
+    {
+        blocks.push_back(pool.allocate(64, 8));
+        std::memset(blocks.back(), static_cast<int>(index), 64);
+    }
+    const size_t reserved = pool.GetReservedBytes();
+
+    std::thread([&pool, &blocks] {
+        for (void* block : blocks)
+            pool.deallocate(block, 64, 8);
+    }).join();
+
+    // The exiting thread handed its blocks back and its counters are kept.
+    MemoryCounters counters = MemoryStatistics::GetCounters(MemorySubsystem::Events);
+    CHECK_EQ(counters.Allocations, uint64_t{BlockCount});
+    CHECK_EQ(counters.Deallocations, uint64_t{BlockCount});
+    CHECK_EQ(counters.BytesAllocated, uint64_t{BlockCount * 64});
+
+    for (void*& block : blocks)
+    {
+        block = pool.allocate(64, 8);
+        std::memset(block, 0xCD, 64);
+    }
+    CHECK_EQ(pool.GetReservedBytes(), reserved);
+
+    // And the other way round, blocks allocated by a thread that has ended.
+    std::vector<void*> foreign(BlockCount);
+    std::thread([&pool, &foreign] {
+        for (void*& block : foreign)
+            block = pool.allocate(64, 8);
+    }).join();
+    for (void* block : foreign)
+        pool.deallocate(block, 64, 8);
+    for (void* block : blocks)
+        pool.deallocate(block, 64, 8);
+
+    counters = MemoryStatistics::GetCounters(MemorySubsystem::Events);
+    CHECK_EQ(counters.Allocations, uint64_t{BlockCount * 3});
+    CHECK_EQ(counters.Deallocations, uint64_t{BlockCount * 3});
+}
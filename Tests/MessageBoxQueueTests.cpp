@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MessageBoxQueue.hpp"
+#include "TestFramework.hpp"
+#include "UiThread.hpp"
+
+using namespace std::chrono_literals;
+using namespace WinCore::Core;
+
+namespace
+{
+    const void* const WindowA = reinterpret_cast<const void*>(uintptr_t{0x1000});
+    const void* const WindowB = reinterpret_cast<const void*>(uintptr_t{0x2000});
+
+    /**
+     * Keeps each message box open until the test releases it, and returns the length of its text.
+     * Requests with the text "throw" fail once released.
+     */
+    class GatedPresenter final : public MessageBoxPresenter
+    {
+        public:
+            int32_t Present(const MessageBoxRequest& request) override
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                shown_.push_back(request);
+                maxVisible_ = std::max(maxVisible_, ++visible_);
+                changed_.notify_all();
+                changed_.wait(lock, [this] { return released_ >= shown_.size(); });
+                --visible_;
+
+                if (request.Text == "throw")
+                    throw std::runtime_error("The presenter failed.");
+                return static_cast<int32_t>(request.Text.size());
+            }
+
+            /**
+             * Waits until a number of message boxes has been shown, returns false after a generous timeout.
+             */
+            bool WaitUntilShown(size_t count)
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                return changed_.wait_for(lock, 10s, [this, count] { return shown_.size() >= count; });
+            }
+
+            /**
+             * Lets the first count message boxes close, including ones not shown yet.
+             */
+            void Release(size_t count)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                released_ = count;
+                changed_.notify_all();
+            }
+
+            std::vector<MessageBoxRequest> GetShown()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return shown_;
+            }
+
+            int GetMaxVisible()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return maxVisible_;
+            }
+
+        private:
+            std::mutex mutex_{};
+            std::condition_variable changed_{};
+            std::vector<MessageBoxRequest> shown_{};
+            size_t released_{0};
+            int visible_{0};
+            int maxVisible_{0};
+    };
+
+    MessageBoxRequest MakeRequest(std::string text, const void* owner = nullptr)
+    {
+        return MessageBoxRequest{owner, std::move(text), "Title", 0x10};
+    }
+
+    /**
+     * Waits for a result without hanging the test run if the queue is wedged.
+     */
+    template<typename Future>
+    bool IsReady(const Future& future)
+    {
+        return future.wait_for(10s) == std::future_status::ready;
+    }
+}
+
+WINCORE_TEST(MessageBoxesAreShownOneAtATimeInOrder)
+{
+    UiThread ui("MessageBoxQueueTests");
+    auto presenter = std::make_shared<GatedPresenter>();
+    MessageBoxQueue queue(ui.GetDispatcher().GetReference(), presenter);
+
+    std::shared_future<int32_t> first = queue.Enqueue(MakeRequest("a"));
+    std::shared_future<int32_t> second = queue.Enqueue(MakeRequest("bb"));
+    std::shared_future<int32_t> third = queue.Enqueue(MakeRequest("ccc"));
+    CHECK(presenter->WaitUntilShown(1));
+
+    // Work posted while a message box is open runs before the next one is shown.
+    std::future<size_t> shownBeforeWork = ui.Invoke([&presenter] { return presenter->GetShown().size(); });
+    presenter->Release(1);
+    CHECK(IsReady(shownBeforeWork));
+    CHECK_EQ(shownBeforeWork.get(), size_t{1});
+
+    presenter->Release(3);
+    CHECK(IsReady(third));
+    CHECK_EQ(first.get(), 1);
+    CHECK_EQ(second.get(), 2);
+    CHECK_EQ(third.get(), 3);
+
+    const std::vector<MessageBoxRequest> shown = presenter->GetShown();
+    CHECK_EQ(shown.size(), size_t{3});
+    CHECK_EQ(shown[0].Text, std::string("a"));
+    CHECK_EQ(shown[1].Text, std::string("bb"));
+    CHECK_EQ(shown[2].Text, std::string("ccc"));
+    CHECK_EQ(presenter->GetMaxVisible(), 1);
+}
+
+WINCORE_TEST(IdenticalMessageBoxesAreCoalescedAndShareTheirResult)
+{
+    UiThread ui("MessageBoxQueueTests");
+    auto presenter = std::make_shared<GatedPresenter>();
+    MessageBoxQueue queue(ui.GetDispatcher().GetReference(), presenter);
+
+    std::shared_future<int32_t> visible = queue.Enqueue(MakeRequest("disk full"));
+    CHECK(presenter->WaitUntilShown(1));
+
+    // One duplicate of the visible message box, two of a queued one and one with another owner.
+    std::shared_future<int32_t> visibleAgain = queue.Enqueue(MakeRequest("disk full"));
+    std::shared_future<int32_t> queued = queue.Enqueue(MakeRequest("net down"));
+    std::atomic<int32_t> callbackResult{-1};
+    queue.Enqueue(MakeRequest("net down"), [&callbackResult](int32_t result, std::exception_ptr) { callbackResult = result; });
+    std::shared_future<int32_t> queuedAgain = queue.Enqueue(MakeRequest("net down"));
+    std::shared_future<int32_t> owned = queue.Enqueue(MakeRequest("net down", WindowA));
+    std::shared_future<int32_t> otherOwner = queue.Enqueue(MakeRequest("net down", WindowB));
+
+    MessageBoxQueueStatistics statistics = queue.GetStatistics();
+    CHECK_EQ(statistics.Requested, uint64_t{7});
+    CHECK_EQ(statistics.Coalesced, uint64_t{3});
+    CHECK_EQ(statistics.Pending, size_t{3});
+
+    presenter->Release(4);
+    CHECK(IsReady(otherOwner));
+    CHECK_EQ(visible.get(), 9);
+    CHECK_EQ(visibleAgain.get(), 9);
+    CHECK_EQ(queued.get(), 8);
+    CHECK_EQ(queuedAgain.get(), 8);
+    CHECK_EQ(callbackResult.load(), 8);
+    CHECK_EQ(owned.get(), 8);
+    CHECK_EQ(otherOwner.get(), 8);
+
+    const std::vector<MessageBoxRequest> shown = presenter->GetShown();
+    CHECK_EQ(shown.size(), size_t{4});
+    CHECK_EQ(shown[0].Count, 1u);
+    CHECK_EQ(shown[1].Count, 3u);
+    CHECK(shown[1].Owner == nullptr);
+    CHECK(shown[2].Owner == WindowA);
+    CHECK(shown[3].Owner == WindowB);
+
+    statistics = queue.GetStatistics();
+    CHECK_EQ(statistics.Presented, uint64_t{4});
+    CHECK_EQ(statistics.Presented + statistics.Coalesced, statistics.Requested);
+    CHECK_EQ(statistics.Pending, size_t{0});
+}
+
+WINCORE_TEST(PresenterExceptionsReachEveryCaller)
+{
+    UiThread ui("MessageBoxQueueTests");
+    auto presenter = std::make_shared<GatedPresenter>();
+    presenter->Release(100);
+    MessageBoxQueue queue(ui.GetDispatcher().GetReference(), presenter);
+
+    std::promise<std::exception_ptr> callbackError;
+    queue.Enqueue(MakeRequest("throw"), [&callbackError](int32_t, std::exception_ptr error) { callbackError.set_value(error); });
+    std::shared_future<int32_t> failed = queue.Enqueue(MakeRequest("throw"));
+    std::shared_future<int32_t> after = queue.Enqueue(MakeRequest("after"));
+
+    CHECK(IsReady(after));
+    CHECK_THROWS_AS(failed.get(), std::runtime_error);
+    const std::exception_ptr error = callbackError.get_future().get();
+    CHECK(error != nullptr);
+    CHECK_THROWS_AS(std::rethrow_exception(error), std::runtime_error);
+    CHECK_EQ(after.get(), 5);
+}
+
+WINCORE_TEST(ThrowingCallbacksDoNotStallTheQueue)
+{
+    UiThread ui("MessageBoxQueueTests");
+    auto presenter = std::make_shared<GatedPresenter>();
+    MessageBoxQueue queue(ui.GetDispatcher().GetReference(), presenter);
+
+    std::atomic<int> laterCallbacks{0};
+    queue.Enqueue(MakeRequest("first"), [](int32_t, std::exception_ptr) { throw std::runtime_error("The callback failed."); });
+    queue.Enqueue(MakeRequest("first"), [&laterCallbacks](int32_t, std::exception_ptr) { ++laterCallbacks; });
+    std::shared_future<int32_t> second = queue.Enqueue(MakeRequest("second"));
+    CHECK(presenter->WaitUntilShown(1));
+
+    presenter->Release(2);
+    CHECK(IsReady(second));
+    CHECK_EQ(second.get(), 6);
+    CHECK_EQ(laterCallbacks.load(), 1);
+
+    // The UI thread survived the exception and the queue still schedules new message boxes.
+    std::shared_future<int32_t> third = queue.Enqueue(MakeRequest("third"));
+    presenter->Release(3);
+    CHECK(IsReady(third));
+    CHECK_EQ(third.get(), 5);
+    CHECK(ui.IsRunning());
+}
+
+WINCORE_TEST(MessageBoxesFailOnceTheDispatcherIsGone)
+{
+    auto presenter = std::make_shared<GatedPresenter>();
+    std::unique_ptr<MessageBoxQueue> queue;
+    {
+        UiThread ui("MessageBoxQueueTests");
+        queue = std::make_unique<MessageBoxQueue>(ui.GetDispatcher().GetReference(), presenter);
+    }
+
+    bool callbackFailed = false;
+    queue->Enqueue(MakeRequest("late"), [&callbackFailed](int32_t, std::exception_ptr error) { callbackFailed = error != nullptr; });
+    std::shared_future<int32_t> late = queue->Enqueue(MakeRequest("later"));
+    CHECK(callbackFailed);
+    CHECK(IsReady(late));
+    CHECK_THROWS_AS(late.get(), std::runtime_error);
+    CHECK(presenter->GetShown().empty());
+}
+
+WINCORE_TEST(InvalidArgumentsThrow)
+{
+    UiThread ui("MessageBoxQueueTests");
+    CHECK_THROWS_AS(MessageBoxQueue(UiDispatcherReference{}, std::make_shared<GatedPresenter>()), std::invalid_argument);
+    CHECK_THROWS_AS(MessageBoxQueue(ui.GetDispatcher().GetReference(), nullptr), std::invalid_argument);
+}
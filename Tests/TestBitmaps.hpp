@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "Bitmap.hpp"
+
+namespace WinCore::Tests
+{
+    /**
+     * Fills a bitmap with random premultiplied pixels, every color channel at most its alpha.
+     * @param seed The seed, the same seed gives the same pixels.
+     */
+    inline UI::Bitmap MakeRandomPremultiplied(uint32_t width, uint32_t height, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        UI::Bitmap bitmap(width, height);
+        for (size_t index = 0; index < bitmap.Pixels.size(); index += 4)
+        {
+            const uint8_t alpha = static_cast<uint8_t>(random() % 256);
+            for (size_t channel = 0; channel < 3; ++channel)
+                bitmap.Pixels[index + channel] = static_cast<uint8_t>(random() % (alpha + 1u));
+            bitmap.Pixels[index + 3] = alpha;
+        }
+        return bitmap;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace WinCore::Tests
+{
+    /**
+     * @struct TestCase
+     * @brief A test registered with WINCORE_TEST.
+     */
+    struct TestCase
+    {
+        const char* Name{nullptr};
+        void (*Function)(){nullptr};
+    };
+
+    /**
+     * @class CheckFailure
+     * @brief Thrown by the CHECK macros, ends the running test.
+     */
+    class CheckFailure : public std::runtime_error
+    {
+        public:
+            using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * Returns the tests of the executable, in registration order.
+     */
+    inline std::vector<TestCase>& GetTests()
+    {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    /**
+     * Registers a test from a static initializer.
+     */
+    struct TestRegistrar
+    {
+        TestRegistrar(const char* name, void (*function)()) { GetTests().push_back(TestCase{name, function}); }
+    };
+
+    /**
+     * Throws a CheckFailure describing the failed expression.
+     */
+    [[noreturn]] inline void Fail(const char* file, int line, const std::string& message)
+    {
+        std::ostringstream stream;
+        stream << file << ":" << line << ": " << message;
+        throw CheckFailure(stream.str());
+    }
+
+    /**
+     * Formats a value for a failure message, if it can be streamed.
+     */
+    template<typename T>
+    std::string Describe(const T& value)
+    {
+        if constexpr (requires(std::ostream& stream) { stream << value; })
+        {
+            std::ostringstream stream;
+            stream << value;
+            return stream.str();
+        }
+        else
+        {
+            return "<value>";
+        }
+    }
+}
+
+/**
+ * Defines and registers a test.
+ * Usage: WINCORE_TEST(ParallelForCoversRange) { CHECK(...); }
+ */
+#define WINCORE_TEST(name)                                                                          \
+    static void name();                                                                             \
+    static const ::WinCore::Tests::TestRegistrar name##Registrar{#name, &name};                     \
+    static void name()
+
+#define CHECK(expression)                                                                           \
+    do                                                                                              \
+    {                                                                                               \
+        if (!(expression))                                                                          \
+            ::WinCore::Tests::Fail(__FILE__, __LINE__, "CHECK(" #expression ") failed");            \
+    } while (false)
+
+#define CHECK_EQ(actual, expected)                                                                  \
+    do                                                                                              \
+    {                                                                                               \
+        const auto& wincoreActual = (actual);                                                       \
+        const auto& wincoreExpected = (expected);                                                   \
+        if (!(wincoreActual == wincoreExpected))                                                    \
+        {                                                                                           \
+            ::WinCore::Tests::Fail(__FILE__, __LINE__, "CHECK_EQ(" #actual ", " #expected ") failed: " \
+                + ::WinCore::Tests::Describe(wincoreActual) + " != " + ::WinCore::Tests::Describe(wincoreExpected)); \
+        }                                                                                           \
+    } while (false)
+
+#define CHECK_THROWS_AS(expression, type)                                                           \
+    do                                                                                              \
+    {                                                                                               \
+        bool wincoreThrown = false;                                                                 \
+        try                                                                                         \
+        {                                                                                           \
+            (void)(expression);                                                                     \
+        }                                                                                           \
+        catch (const type&)                                                                         \
+        {                                                                                           \
+            wincoreThrown = true;                                                                   \
+        }                                                                                           \
+        if (!wincoreThrown)                                                                         \
+            ::WinCore::Tests::Fail(__FILE__, __LINE__, "CHECK_THROWS_AS(" #expression ", " #type ") did not throw"); \
+    } while (false)
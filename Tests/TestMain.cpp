@@ -0,0 +1,41 @@
+#include <cstring>
+
+#include "TestFramework.hpp"
+
+/**
+ * Runs every registered test, or those whose name contains the first argument.
+ * @return 0 if every test passed.
+ */
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    size_t passed = 0;
+    size_t failed = 0;
+
+    for (const WinCore::Tests::TestCase& test : WinCore::Tests::GetTests())
+    {
+        if (filter && !std::strstr(test.Name, filter))
+            continue;
+
+        try
+        {
+            test.Function();
+            ++passed;
+            std::printf("[ PASS ] %s\n", test.Name);
+        }
+        catch (const std::exception& exception)
+        {
+            ++failed;
+            std::printf("[ FAIL ] %s\n         %s\n", test.Name, exception.what());
+        }
+        catch (...)
+        {
+            ++failed;
+            std::printf("[ FAIL ] %s\n         unknown exception\n", test.Name);
+        }
+        std::fflush(stdout);
+    }
+
+    std::printf("%zu passed, %zu failed\n", passed, failed);
+    return failed == 0 ? 0 : 1;
+}
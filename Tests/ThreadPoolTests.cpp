@@ -0,0 +1,314 @@
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TestFramework.hpp"
+#include "ThreadPool.hpp"
+
+using namespace WinCore::Core;
+
+namespace
+{
+    /**
+     * The deque never dereferences its jobs, so tests queue tagged integers.
+     */
+    Detail::PoolJob* MakeToken(uintptr_t value)
+    {
+        return reinterpret_cast<Detail::PoolJob*>(value << 4);
+    }
+
+    uintptr_t ReadToken(Detail::PoolJob* job)
+    {
+        return reinterpret_cast<uintptr_t>(job) >> 4;
+    }
+
+    /**
+     * Occupies every worker of a pool until Release is called.
+     */
+    class WorkerGate
+    {
+        public:
+            explicit WorkerGate(ThreadPool& pool) : opened_(promise_.get_future().share())
+            {
+                std::atomic<size_t> blocked{0};
+                for (size_t index = 0; index < pool.GetWorkerCount(); ++index)
+                {
+                    pool.Submit([opened = opened_, &blocked] {
+                        ++blocked;
+                        opened.wait();
+                    }, TaskPriority::Interactive);
+                }
+                while (blocked.load() < pool.GetWorkerCount())
+                    std::this_thread::yield();
+            }
+
+            ~WorkerGate() { Release(); }
+
+            void Release()
+            {
+                if (!released_)
+                {
+                    released_ = true;
+                    promise_.set_value();
+                }
+            }
+
+        private:
+            std::promise<void> promise_{};
+            std::shared_future<void> opened_;
+            bool released_{false};
+    };
+}
+
+WINCORE_TEST(DequeOwnerPopsInLifoOrder)
+{
+    Detail::WorkStealingDeque deque;
+    for (uintptr_t value = 1; value <= 1000; ++value)
+        deque.Push(MakeToken(value));
+
+    for (uintptr_t value = 1000; value >= 1; --value)
+        CHECK_EQ(ReadToken(deque.Pop()), value);
+    CHECK(deque.Pop() == nullptr);
+}
+
+WINCORE_TEST(DequeThievesStealInFifoOrder)
+{
+    Detail::WorkStealingDeque deque;
+    for (uintptr_t value = 1; value <= 1000; ++value)
+        deque.Push(MakeToken(value));
+
+    for (uintptr_t value = 1; value <= 1000; ++value)
+        CHECK_EQ(ReadToken(deque.Steal()), value);
+    CHECK(deque.Steal() == nullptr);
+}
+
+WINCORE_TEST(DequeStealRacesTakeEveryJobExactlyOnce)
+{
+    constexpr uintptr_t JobCount = 200000;
+    constexpr size_t ThiefCount = 3;
+
+    Detail::WorkStealingDeque deque;
+    std::vector<std::atomic<uint8_t>> taken(JobCount + 1);
+    std::atomic<bool> producing{true};
+
+    std::vector<std::thread> thieves;
+    for (size_t thief = 0; thief < ThiefCount; ++thief)
+    {
+        thieves.emplace_back([&] {
+            while (producing.load(std::memory_order_acquire) || deque.GetSizeEstimate() > 0)
+            {
+                if (Detail::PoolJob* job = deque.Steal())
+                    taken[ReadToken(job)].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    // The owner pushes in bursts that grow the ring and pops some back, racing the thieves for the last element.
+    for (uintptr_t value = 1; value <= JobCount; ++value)
+    {
+        deque.Push(MakeToken(value));
+        if (value % 3 == 0)
+        {
+            if (Detail::PoolJob* job = deque.Pop())
+                taken[ReadToken(job)].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    while (Detail::PoolJob* job = deque.Pop())
+        taken[ReadToken(job)].fetch_add(1, std::memory_order_relaxed);
+
+    producing.store(false, std::memory_order_release);
+    for (std::thread& thief : thieves)
+        thief.join();
+
+    for (uintptr_t value = 1; value <= JobCount; ++value)
+        CHECK_EQ(static_cast<int>(taken[value].load()), 1);
+}
+
+WINCORE_TEST(HigherPriorityJobsRunFirst)
+{
+    ThreadPool pool(1);
+    std::mutex orderMutex;
+    std::vector<TaskPriority> order;
+
+    {
+        WorkerGate gate(pool);
+        for (TaskPriority priority : {TaskPriority::Prefetch, TaskPriority::Normal, TaskPriority::Interactive,
+                                      TaskPriority::Prefetch, TaskPriority::Interactive, TaskPriority::Normal})
+        {
+            pool.Submit([&, priority] {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(priority);
+            }, priority);
+        }
+        gate.Release();
+    }
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            if (order.size() == 6)
+                break;
+        }
+        std::this_thread::yield();
+    }
+
+    const std::vector<TaskPriority> expected{TaskPriority::Interactive, TaskPriority::Interactive, TaskPriority::Normal,
+                                             TaskPriority::Normal, TaskPriority::Prefetch, TaskPriority::Prefetch};
+    CHECK(order == expected);
+}
+
+WINCORE_TEST(TaskGroupRethrowsTheFirstExceptionAfterAllJobsRan)
+{
+    ThreadPool pool(2);
+    std::atomic<int> ran{0};
+    TaskGroup group(pool);
+    for (int index = 0; index < 64; ++index)
+    {
+        group.Run([&ran, index] {
+            ++ran;
+            if (index % 16 == 0)
+                throw std::runtime_error("job failed");
+        });
+    }
+
+    CHECK_THROWS_AS(group.Wait(), std::runtime_error);
+    CHECK_EQ(ran.load(), 64);
+
+    // The failure is consumed, the group can be reused.
+    group.Run([&ran] { ++ran; });
+    group.Wait();
+    CHECK_EQ(ran.load(), 65);
+}
+
+WINCORE_TEST(TaskGroupDestructorWaitsAndSwallowsExceptions)
+{
+    ThreadPool pool(2);
+    std::atomic<int> ran{0};
+    {
+        TaskGroup group(pool);
+        for (int index = 0; index < 16; ++index)
+        {
+            group.Run([&ran] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                ++ran;
+                throw std::runtime_error("ignored");
+            });
+        }
+    }
+    CHECK_EQ(ran.load(), 16);
+}
+
+WINCORE_TEST(NestedGroupsOnWorkersDoNotDeadlock)
+{
+    ThreadPool pool(2);
+    std::atomic<int> leaves{0};
+    TaskGroup outer(pool);
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        outer.Run([&pool, &leaves] {
+            TaskGroup inner(pool);
+            for (int leaf = 0; leaf < 16; ++leaf)
+                inner.Run([&leaves] { ++leaves; });
+            inner.Wait();
+        });
+    }
+    outer.Wait();
+    CHECK_EQ(leaves.load(), 256);
+}
+
+WINCORE_TEST(NonWorkerWaitDoesNotRunForeignJobs)
+{
+    ThreadPool pool(1);
+    const std::thread::id caller = std::this_thread::get_id();
+    std::promise<void> unblock;
+    std::shared_future<void> unblocked = unblock.get_future().share();
+    std::atomic<bool> foreignRanOnCaller{false};
+
+    // Jobs that wait on the calling thread, as a job blocking on a UI thread would.
+    for (int index = 0; index < 4; ++index)
+    {
+        pool.Submit([&, unblocked] {
+            if (std::this_thread::get_id() == caller)
+                foreignRanOnCaller = true;
+            else
+                unblocked.wait();
+        }, TaskPriority::Prefetch);
+    }
+
+    std::atomic<size_t> covered{0};
+    pool.ParallelFor(0, 10000, 100, [&covered](size_t first, size_t last) { covered += last - first; });
+    unblock.set_value();
+
+    CHECK_EQ(covered.load(), size_t{10000});
+    CHECK(!foreignRanOnCaller.load());
+}
+
+WINCORE_TEST(ParallelForCoversEveryIndexOnce)
+{
+    ThreadPool pool(3);
+    for (size_t count : {size_t{0}, size_t{1}, size_t{7}, size_t{1000}, size_t{100003}})
+    {
+        for (size_t grain : {size_t{0}, size_t{1}, size_t{64}, size_t{100000}})
+        {
+            std::vector<std::atomic<uint8_t>> hits(count);
+            pool.ParallelFor(0, count, grain, [&hits](size_t first, size_t last) {
+                for (size_t index = first; index < last; ++index)
+                    hits[index].fetch_add(1, std::memory_order_relaxed);
+            });
+
+            for (size_t index = 0; index < count; ++index)
+                CHECK_EQ(static_cast<int>(hits[index].load()), 1);
+        }
+    }
+}
+
+WINCORE_TEST(ParallelForHonoursBeginOffset)
+{
+    ThreadPool pool(2);
+    std::atomic<size_t> sum{0};
+    pool.ParallelFor(100, 200, 8, [&sum](size_t first, size_t last) {
+        CHECK(first >= 100 && last <= 200 && first < last);
+        for (size_t index = first; index < last; ++index)
+            sum += index;
+    });
+    CHECK_EQ(sum.load(), size_t{14950});
+}
+
+WINCORE_TEST(ParallelForPropagatesExceptions)
+{
+    ThreadPool pool(2);
+    CHECK_THROWS_AS(pool.ParallelFor(0, 1000, 10, [](size_t first, size_t) {
+        if (first >= 500)
+            throw std::invalid_argument("chunk failed");
+    }), std::invalid_argument);
+
+    // Failing on the calling thread's own chunk is reported too.
+    CHECK_THROWS_AS(pool.ParallelFor(0, 1000, 10, [](size_t first, size_t) {
+        if (first == 0)
+            throw std::invalid_argument("first chunk failed");
+    }), std::invalid_argument);
+}
+
+WINCORE_TEST(SubmitFromManyThreadsRunsEveryJob)
+{
+    ThreadPool pool(2);
+    std::atomic<int> ran{0};
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < 4; ++producer)
+    {
+        producers.emplace_back([&pool, &ran] {
+            for (int index = 0; index < 10000; ++index)
+                pool.Submit([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+        });
+    }
+    for (std::thread& producer : producers)
+        producer.join();
+
+    while (ran.load() < 40000)
+        std::this_thread::yield();
+    CHECK_EQ(ran.load(), 40000);
+}
@@ -0,0 +1,184 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "TestFramework.hpp"
+#include "UiThread.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "WinClass.hpp"
+#endif
+
+using namespace std::chrono_literals;
+using namespace WinCore::Core;
+
+namespace
+{
+    /**
+     * Waits for a result without hanging the test run if the thread is stuck.
+     */
+    template<typename Future>
+    bool IsReady(const Future& future)
+    {
+        return future.wait_for(10s) == std::future_status::ready;
+    }
+}
+
+WINCORE_TEST(InvokeRunsOnTheUiThread)
+{
+    UiThread ui("UiThreadTests");
+    std::future<std::thread::id> id = ui.Invoke([] { return std::this_thread::get_id(); });
+    CHECK(IsReady(id));
+    CHECK(id.get() == ui.GetId());
+    CHECK(!ui.IsCurrentThread());
+    CHECK_EQ(ui.GetName(), std::string("UiThreadTests"));
+}
+
+WINCORE_TEST(InvokeRunsInlineOnTheOwningThread)
+{
+    UiThread ui("UiThreadTests");
+
+    // Waiting on a nested Invoke from the UI thread only works if it runs inline.
+    std::future<int> outer = ui.Invoke([&ui] {
+        std::future<int> inner = ui.Invoke([] { return 7; });
+        if (inner.wait_for(0s) != std::future_status::ready)
+            return -1;
+        std::future<int> viaDispatcher = WindowThread::Invoke(ui.GetDispatcher(), [] { return 8; });
+        return viaDispatcher.wait_for(0s) == std::future_status::ready ? inner.get() + viaDispatcher.get() : -2;
+    });
+    CHECK(IsReady(outer));
+    CHECK_EQ(outer.get(), 15);
+}
+
+WINCORE_TEST(WindowOperationsAreMarshalledToTheOwningThread)
+{
+    UiThread ui("UiThreadTests");
+    int window = 0;
+    ui.Invoke([&ui, &window] { ui.GetDispatcher().AttachWindow(&window); }).get();
+
+    CHECK(!WindowThread::CheckAccess(&window));
+    CHECK_THROWS_AS(WindowThread::VerifyAccess(&window), std::runtime_error);
+
+    std::future<bool> access = WindowThread::Invoke(&window, [&window] {
+        WindowThread::VerifyAccess(&window);
+        return WindowThread::CheckAccess(&window) && WindowThread::Invoke(&window, [] { return true; }).get();
+    });
+    CHECK(IsReady(access));
+    CHECK(access.get());
+
+    std::promise<std::thread::id> posted;
+    WindowThread::Post(&window, [&posted] { posted.set_value(std::this_thread::get_id()); });
+    CHECK(posted.get_future().get() == ui.GetId());
+
+    int unattached = 0;
+    CHECK(!WindowThread::CheckAccess(&unattached));
+    CHECK_THROWS_AS(WindowThread::Post(&unattached, [] {}), std::runtime_error);
+    ui.Invoke([&ui, &window] { ui.GetDispatcher().DetachWindow(&window); }).get();
+}
+
+WINCORE_TEST(ExceptionsPropagateThroughTheFuture)
+{
+    UiThread ui("UiThreadTests");
+    std::future<int> failed = ui.Invoke([]() -> int { throw std::invalid_argument("The work failed."); });
+    CHECK(IsReady(failed));
+    CHECK_THROWS_AS(failed.get(), std::invalid_argument);
+    CHECK(ui.IsRunning());
+}
+
+WINCORE_TEST(PostAfterStopIsRejected)
+{
+    UiThread ui("UiThreadTests");
+    int window = 0;
+    ui.Invoke([&ui, &window] { ui.GetDispatcher().AttachWindow(&window); }).get();
+
+    std::atomic<bool> ranBeforeStop{false};
+    CHECK(ui.Post([&ranBeforeStop] { ranBeforeStop = true; }));
+    ui.Stop();
+    CHECK(!ui.Post([] {}));
+    CHECK_THROWS_AS(ui.Invoke([] {}), std::runtime_error);
+
+    ui.Join();
+    CHECK(ranBeforeStop.load());
+    CHECK(!ui.IsRunning());
+    CHECK_THROWS_AS(WindowThread::Post(&window, [] {}), std::runtime_error);
+}
+
+WINCORE_TEST(ThrowingWorkDoesNotEndTheThread)
+{
+    UiThread ui("UiThreadTests");
+    CHECK(ui.Post([] { throw std::runtime_error("The work failed."); }));
+    CHECK(ui.Post([] { throw 42; }));
+
+    std::future<int> after = ui.Invoke([] { return 1; });
+    CHECK(IsReady(after));
+    CHECK_EQ(after.get(), 1);
+    CHECK(ui.IsRunning());
+}
+
+WINCORE_TEST(ThrowingFrameCallbacksDoNotEndTheThread)
+{
+    UiThread ui("UiThreadTests");
+    int window = 0;
+    std::atomic<int> frames{0};
+    std::promise<void> firstFrame;
+    std::promise<void> secondFrame;
+    ui.Invoke([&] {
+        FrameCallbacks callbacks{};
+        callbacks.Paint = [&frames, &firstFrame, &secondFrame](const FrameContext&) {
+            if (++frames == 1)
+            {
+                firstFrame.set_value();
+                throw std::runtime_error("The paint failed.");
+            }
+            secondFrame.set_value();
+        };
+        ui.GetFrameScheduler().RegisterWindow(&window, 60, std::move(callbacks));
+        ui.GetFrameScheduler().Invalidate(&window);
+    }).get();
+
+    CHECK(IsReady(firstFrame.get_future()));
+    ui.Invoke([&ui, &window] { ui.GetFrameScheduler().Invalidate(&window); }).get();
+    CHECK(IsReady(secondFrame.get_future()));
+    CHECK_EQ(frames.load(), 2);
+    ui.Invoke([&ui, &window] { ui.GetFrameScheduler().UnregisterWindow(&window); }).get();
+}
+
+WINCORE_TEST(ThreadCanBeDestroyedFromItsOwnWork)
+{
+    auto* ui = new UiThread("UiThreadTests");
+    const UiDispatcherReference dispatcher = ui->GetDispatcher().GetReference();
+    std::promise<void> deleted;
+    CHECK(ui->Post([ui, &deleted] {
+        delete ui;
+        deleted.set_value();
+    }));
+    CHECK(IsReady(deleted.get_future()));
+
+    // The detached thread still ends, its dispatcher goes away once the loop has seen the stop.
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (dispatcher.Post([] {}) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+    CHECK(!dispatcher.Post([] {}));
+}
+
+#ifdef _WIN32
+WINCORE_TEST(WindowClassesAreSharedAcrossThreads)
+{
+    const WindowClass windowClass("WinCore UiThreadTests", GetModuleHandleW(nullptr), WindowStyles::None, WindowExtenedStyle::None);
+    UiThread first("UiThreadTests");
+    UiThread second("UiThreadTests");
+    first.Invoke([&windowClass] { WindowRegistry::Register(windowClass); }).get();
+    second.Invoke([&windowClass] { WindowRegistry::Register(windowClass); }).get();
+    CHECK(WindowRegistry::IsRegistered("WinCore UiThreadTests"));
+
+    first.Invoke([&windowClass] { WindowRegistry::Unregister(windowClass); }).get();
+    CHECK(WindowRegistry::IsRegistered("WinCore UiThreadTests"));
+    second.Invoke([&windowClass] { WindowRegistry::Unregister(windowClass); }).get();
+    CHECK(!WindowRegistry::IsRegistered("WinCore UiThreadTests"));
+}
+#endif